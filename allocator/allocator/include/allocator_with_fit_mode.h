@@ -13,7 +13,11 @@ public:
     {
         first_fit,
         the_best_fit,
-        the_worst_fit
+        the_worst_fit,
+        
+        // first fit resumed after the previous hit, allocators without a
+        // cursor treat it as first fit
+        next_fit
     };
 
 public:
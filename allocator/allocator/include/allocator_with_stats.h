@@ -0,0 +1,90 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_WITH_STATS_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_WITH_STATS_H
+
+#include <atomic>
+#include <cstddef>
+
+class allocator_with_stats
+{
+
+public:
+    
+    struct stats final
+    {
+        
+        size_t free_bytes;
+        
+        size_t largest_free_block;
+        
+        size_t free_blocks_count;
+        
+        /** 1 - largest free block / free bytes, 0 when nothing is free */
+        double fragmentation;
+        
+        size_t allocations_count;
+        
+        size_t deallocations_count;
+        
+        size_t occupied_bytes;
+        
+        /** Peak of `occupied_bytes` over the allocator lifetime */
+        size_t high_water_mark;
+        
+    };
+
+public:
+    
+    virtual ~allocator_with_stats() noexcept = default;
+
+public:
+    
+    // lock-free and O(1), fields are read one by one, so a snapshot taken
+    // while other threads allocate may mix values from neighbouring operations
+    virtual stats get_stats() const noexcept = 0;
+
+public:
+    
+    /**
+     * Kept in the allocator metadata and updated under the allocator lock,
+     * block sizes are counted the way `get_blocks_info()` reports them
+     */
+    struct stats_counters final
+    {
+        
+        std::atomic<size_t> free_bytes{ 0 };
+        
+        std::atomic<size_t> largest_free_block{ 0 };
+        
+        std::atomic<size_t> free_blocks_count{ 0 };
+        
+        std::atomic<size_t> allocations_count{ 0 };
+        
+        std::atomic<size_t> deallocations_count{ 0 };
+        
+        std::atomic<size_t> occupied_bytes{ 0 };
+        
+        std::atomic<size_t> high_water_mark{ 0 };
+        
+        void hole_added(
+            size_t size) noexcept;
+        
+        void hole_removed(
+            size_t size) noexcept;
+        
+        void block_allocated(
+            size_t size) noexcept;
+        
+        void block_deallocated(
+            size_t size) noexcept;
+        
+        void block_resized(
+            size_t old_size,
+            size_t new_size) noexcept;
+        
+        stats load() const noexcept;
+        
+    };
+    
+};
+
+#endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_WITH_STATS_H
\ No newline at end of file
@@ -17,7 +17,23 @@ private:
 
     virtual void* do_allocate_sm(size_t) =0;
 
+    /** Resources able to place blocks on a requested boundary override this one.
+     *  Default forwards to do_allocate_sm(size_t) and refuses results that are not aligned
+     */
+    virtual void* do_allocate_sm(size_t bytes, size_t alignment);
+
     void * do_allocate(size_t _Bytes, size_t _Align) final;
+
+    /** Resources that know what lies after a block override this one, default never resizes
+     */
+    virtual bool do_try_resize_sm(void* p, size_t new_bytes);
+
+public:
+
+    /** Grows or shrinks the block at p to new_bytes without moving it.
+     *  Returns false and leaves the block untouched when that is not possible
+     */
+    bool try_resize(void* p, size_t new_bytes);
 };
 
 
@@ -31,6 +47,28 @@ private:
     bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
 };
 
+/** Forwards to upstream and counts what goes through, a parent for tests of allocators built on top of one
+ */
+struct counting_mem_resource : public std::pmr::memory_resource
+{
+    size_t allocations = 0;
+    size_t deallocations = 0;
+
+    /** Bytes currently held from upstream and the most ever held at once */
+    size_t allocated_bytes = 0;
+    size_t peak_allocated_bytes = 0;
+
+    explicit counting_mem_resource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept;
+
+private:
+
+    std::pmr::memory_resource* _upstream;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
 // propagating_polymorphic_allocator
 template <typename T>
 struct pp_allocator
@@ -57,6 +95,10 @@ public:
     [[nodiscard]] T* allocate(size_t n);
     void deallocate(T* p, size_t n = 1);
 
+    /** Resizes p to n objects in place if the resource is a smart_mem_resource able to do so
+     */
+    bool try_resize(T* p, size_t n);
+
     template<class U, class... Args>
     void construct(U* p, Args&&... args);
 
@@ -186,6 +228,13 @@ void pp_allocator<T>::deallocate(T *p, size_t n)
     _mem->deallocate(p, n * sizeof(T), alignof(T));
 }
 
+template<typename T>
+bool pp_allocator<T>::try_resize(T *p, size_t n)
+{
+    auto* smart = dynamic_cast<smart_mem_resource*>(_mem);
+    return smart != nullptr && smart->try_resize(p, n * sizeof(T));
+}
+
 template<typename T>
 T *pp_allocator<T>::allocate(size_t n)
 {
@@ -0,0 +1,370 @@
+#ifndef MP_OS_PP_VECTOR_H
+#define MP_OS_PP_VECTOR_H
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include "pp_allocator.h"
+
+/** Growable array of trivially copyable values. Growth first asks the resource
+ *  to resize the block in place and only falls back to allocate-copy-free when it can't
+ */
+template<typename T>
+class pp_vector
+{
+    static_assert(std::is_trivially_copyable_v<T>, "pp_vector relocates elements with memcpy");
+
+private:
+    pp_allocator<T> _allocator;
+    T* _data = nullptr;
+    size_t _size = 0;
+    size_t _capacity = 0;
+
+public:
+
+    using value_type = T;
+    using allocator_type = pp_allocator<T>;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    explicit pp_vector(pp_allocator<T> allocator = pp_allocator<T>()) noexcept;
+
+    pp_vector(size_t size, const T& value, pp_allocator<T> allocator = pp_allocator<T>());
+
+    pp_vector(std::initializer_list<T> values, pp_allocator<T> allocator = pp_allocator<T>());
+
+    pp_vector(const pp_vector& other);
+
+    pp_vector(pp_vector&& other) noexcept;
+
+    pp_vector& operator=(const pp_vector& other);
+
+    pp_vector& operator=(pp_vector&& other) noexcept;
+
+    ~pp_vector() noexcept;
+
+    size_t size() const noexcept;
+    size_t capacity() const noexcept;
+    bool empty() const noexcept;
+
+    T* data() noexcept;
+    const T* data() const noexcept;
+
+    T& operator[](size_t i) noexcept;
+    const T& operator[](size_t i) const noexcept;
+
+    T& back() noexcept;
+    const T& back() const noexcept;
+
+    iterator begin() noexcept;
+    iterator end() noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    void push_back(const T& value);
+    void pop_back() noexcept;
+
+    void resize(size_t size, const T& value = T());
+
+    void reserve(size_t capacity);
+
+    /** Gives the unused tail back to the resource, in place when possible
+     */
+    void shrink_to_fit();
+
+    void clear() noexcept;
+
+    pp_allocator<T> get_allocator() const noexcept;
+
+private:
+
+    /** Capacity becomes at least `capacity`, twice the old one if that is larger
+     */
+    void grow(size_t capacity);
+
+    void reallocate(size_t capacity);
+};
+
+template<typename T>
+pp_vector<T>::pp_vector(pp_allocator<T> allocator) noexcept : _allocator(allocator) {}
+
+template<typename T>
+pp_vector<T>::pp_vector(size_t size, const T& value, pp_allocator<T> allocator) : _allocator(allocator)
+{
+    resize(size, value);
+}
+
+template<typename T>
+pp_vector<T>::pp_vector(std::initializer_list<T> values, pp_allocator<T> allocator) : _allocator(allocator)
+{
+    reserve(values.size());
+    std::copy(values.begin(), values.end(), _data);
+    _size = values.size();
+}
+
+template<typename T>
+pp_vector<T>::pp_vector(const pp_vector& other) : _allocator(other._allocator.select_on_container_copy_construction())
+{
+    reserve(other._size);
+    if (other._size != 0)
+    {
+        std::memcpy(_data, other._data, other._size * sizeof(T));
+    }
+    _size = other._size;
+}
+
+template<typename T>
+pp_vector<T>::pp_vector(pp_vector&& other) noexcept
+    : _allocator(other._allocator),
+      _data(std::exchange(other._data, nullptr)),
+      _size(std::exchange(other._size, 0)),
+      _capacity(std::exchange(other._capacity, 0))
+{}
+
+template<typename T>
+pp_vector<T>& pp_vector<T>::operator=(const pp_vector& other)
+{
+    if (this != &other)
+    {
+        pp_vector copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+template<typename T>
+pp_vector<T>& pp_vector<T>::operator=(pp_vector&& other) noexcept
+{
+    if (this != &other)
+    {
+        std::swap(_allocator, other._allocator);
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+    }
+    return *this;
+}
+
+template<typename T>
+pp_vector<T>::~pp_vector() noexcept
+{
+    if (_data != nullptr)
+    {
+        _allocator.deallocate(_data, _capacity);
+    }
+}
+
+template<typename T>
+size_t pp_vector<T>::size() const noexcept
+{
+    return _size;
+}
+
+template<typename T>
+size_t pp_vector<T>::capacity() const noexcept
+{
+    return _capacity;
+}
+
+template<typename T>
+bool pp_vector<T>::empty() const noexcept
+{
+    return _size == 0;
+}
+
+template<typename T>
+T* pp_vector<T>::data() noexcept
+{
+    return _data;
+}
+
+template<typename T>
+const T* pp_vector<T>::data() const noexcept
+{
+    return _data;
+}
+
+template<typename T>
+T& pp_vector<T>::operator[](size_t i) noexcept
+{
+    return _data[i];
+}
+
+template<typename T>
+const T& pp_vector<T>::operator[](size_t i) const noexcept
+{
+    return _data[i];
+}
+
+template<typename T>
+T& pp_vector<T>::back() noexcept
+{
+    return _data[_size - 1];
+}
+
+template<typename T>
+const T& pp_vector<T>::back() const noexcept
+{
+    return _data[_size - 1];
+}
+
+template<typename T>
+typename pp_vector<T>::iterator pp_vector<T>::begin() noexcept
+{
+    return _data;
+}
+
+template<typename T>
+typename pp_vector<T>::iterator pp_vector<T>::end() noexcept
+{
+    return _data + _size;
+}
+
+template<typename T>
+typename pp_vector<T>::const_iterator pp_vector<T>::begin() const noexcept
+{
+    return _data;
+}
+
+template<typename T>
+typename pp_vector<T>::const_iterator pp_vector<T>::end() const noexcept
+{
+    return _data + _size;
+}
+
+template<typename T>
+void pp_vector<T>::push_back(const T& value)
+{
+    if (_size == _capacity)
+    {
+        // `value` may live in the block that is about to move
+        T copy = value;
+        grow(_size + 1);
+        _data[_size++] = copy;
+        return;
+    }
+
+    _data[_size++] = value;
+}
+
+template<typename T>
+void pp_vector<T>::pop_back() noexcept
+{
+    --_size;
+}
+
+template<typename T>
+void pp_vector<T>::resize(size_t size, const T& value)
+{
+    if (size > _capacity)
+    {
+        T copy = value;
+        grow(size);
+        std::fill(_data + _size, _data + size, copy);
+    }
+    else if (size > _size)
+    {
+        std::fill(_data + _size, _data + size, value);
+    }
+
+    _size = size;
+}
+
+template<typename T>
+void pp_vector<T>::reserve(size_t capacity)
+{
+    if (capacity <= _capacity)
+    {
+        return;
+    }
+
+    if (_data != nullptr && _allocator.try_resize(_data, capacity))
+    {
+        _capacity = capacity;
+        return;
+    }
+
+    reallocate(capacity);
+}
+
+template<typename T>
+void pp_vector<T>::shrink_to_fit()
+{
+    if (_size == _capacity)
+    {
+        return;
+    }
+
+    if (_size == 0)
+    {
+        _allocator.deallocate(_data, _capacity);
+        _data = nullptr;
+        _capacity = 0;
+        return;
+    }
+
+    if (_allocator.try_resize(_data, _size))
+    {
+        _capacity = _size;
+        return;
+    }
+
+    reallocate(_size);
+}
+
+template<typename T>
+void pp_vector<T>::clear() noexcept
+{
+    _size = 0;
+}
+
+template<typename T>
+pp_allocator<T> pp_vector<T>::get_allocator() const noexcept
+{
+    return _allocator;
+}
+
+template<typename T>
+void pp_vector<T>::grow(size_t capacity)
+{
+    const size_t doubled = std::max(capacity, _capacity * 2);
+
+    if (_data != nullptr)
+    {
+        // a neighbour too small for the doubled capacity may still fit the exact one
+        if (_allocator.try_resize(_data, doubled))
+        {
+            _capacity = doubled;
+            return;
+        }
+        if (doubled != capacity && _allocator.try_resize(_data, capacity))
+        {
+            _capacity = capacity;
+            return;
+        }
+    }
+
+    reallocate(doubled);
+}
+
+template<typename T>
+void pp_vector<T>::reallocate(size_t capacity)
+{
+    T* data = _allocator.allocate(capacity);
+
+    if (_data != nullptr)
+    {
+        if (_size != 0)
+        {
+            std::memcpy(data, _data, _size * sizeof(T));
+        }
+        _allocator.deallocate(_data, _capacity);
+    }
+
+    _data = data;
+    _capacity = capacity;
+}
+
+#endif //MP_OS_PP_VECTOR_H
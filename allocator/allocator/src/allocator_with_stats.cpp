@@ -0,0 +1,76 @@
+#include "../include/allocator_with_stats.h"
+
+// writers are serialized by the allocator lock, so plain load-store pairs
+// are enough and readers only ever see whole values
+
+void allocator_with_stats::stats_counters::hole_added(
+    size_t size) noexcept
+{
+    free_bytes.store(free_bytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    free_blocks_count.store(free_blocks_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void allocator_with_stats::stats_counters::hole_removed(
+    size_t size) noexcept
+{
+    free_bytes.store(free_bytes.load(std::memory_order_relaxed) - size, std::memory_order_relaxed);
+    free_blocks_count.store(free_blocks_count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+}
+
+void allocator_with_stats::stats_counters::block_allocated(
+    size_t size) noexcept
+{
+    const size_t occupied = occupied_bytes.load(std::memory_order_relaxed) + size;
+    
+    allocations_count.store(allocations_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    occupied_bytes.store(occupied, std::memory_order_relaxed);
+    
+    if (occupied > high_water_mark.load(std::memory_order_relaxed))
+    {
+        high_water_mark.store(occupied, std::memory_order_relaxed);
+    }
+}
+
+void allocator_with_stats::stats_counters::block_deallocated(
+    size_t size) noexcept
+{
+    deallocations_count.store(deallocations_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    occupied_bytes.store(occupied_bytes.load(std::memory_order_relaxed) - size, std::memory_order_relaxed);
+}
+
+void allocator_with_stats::stats_counters::block_resized(
+    size_t old_size,
+    size_t new_size) noexcept
+{
+    const size_t occupied = occupied_bytes.load(std::memory_order_relaxed) - old_size + new_size;
+    
+    occupied_bytes.store(occupied, std::memory_order_relaxed);
+    
+    if (occupied > high_water_mark.load(std::memory_order_relaxed))
+    {
+        high_water_mark.store(occupied, std::memory_order_relaxed);
+    }
+}
+
+allocator_with_stats::stats allocator_with_stats::stats_counters::load() const noexcept
+{
+    stats result
+        {
+            .free_bytes = free_bytes.load(std::memory_order_relaxed),
+            .largest_free_block = largest_free_block.load(std::memory_order_relaxed),
+            .free_blocks_count = free_blocks_count.load(std::memory_order_relaxed),
+            .fragmentation = 0,
+            .allocations_count = allocations_count.load(std::memory_order_relaxed),
+            .deallocations_count = deallocations_count.load(std::memory_order_relaxed),
+            .occupied_bytes = occupied_bytes.load(std::memory_order_relaxed),
+            .high_water_mark = high_water_mark.load(std::memory_order_relaxed)
+        };
+    
+    // a torn read may see the largest block before the free bytes grew
+    if (result.free_bytes != 0 && result.largest_free_block <= result.free_bytes)
+    {
+        result.fragmentation = 1.0 - static_cast<double>(result.largest_free_block) / result.free_bytes;
+    }
+    
+    return result;
+}
@@ -3,6 +3,8 @@
 //
 
 #include "pp_allocator.h"
+#include <algorithm>
+#include <cstdint>
 
 
 void smart_mem_resource::do_deallocate(void* p, size_t, size_t)
@@ -12,7 +14,30 @@ void smart_mem_resource::do_deallocate(void* p, size_t, size_t)
 
 void * smart_mem_resource::do_allocate(size_t _Bytes, size_t _Align)
 {
-    return do_allocate_sm(_Bytes);
+    return do_allocate_sm(_Bytes, _Align);
+}
+
+void* smart_mem_resource::do_allocate_sm(size_t bytes, size_t alignment)
+{
+    void* p = do_allocate_sm(bytes);
+
+    if (reinterpret_cast<std::uintptr_t>(p) % alignment != 0)
+    {
+        do_deallocate_sm(p);
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+bool smart_mem_resource::do_try_resize_sm(void*, size_t)
+{
+    return false;
+}
+
+bool smart_mem_resource::try_resize(void* p, size_t new_bytes)
+{
+    return do_try_resize_sm(p, new_bytes);
 }
 
 void* test_mem_resource::do_allocate_sm(size_t n)
@@ -31,3 +56,31 @@ auto p = dynamic_cast<const test_mem_resource*>(&other);
 
 return p != nullptr;
 }
+
+counting_mem_resource::counting_mem_resource(std::pmr::memory_resource* upstream) noexcept : _upstream(upstream)
+{
+}
+
+void* counting_mem_resource::do_allocate(size_t bytes, size_t alignment)
+{
+    void* p = _upstream->allocate(bytes, alignment);
+
+    ++allocations;
+    allocated_bytes += bytes;
+    peak_allocated_bytes = std::max(peak_allocated_bytes, allocated_bytes);
+
+    return p;
+}
+
+void counting_mem_resource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+    ++deallocations;
+    allocated_bytes -= bytes;
+
+    _upstream->deallocate(p, bytes, alignment);
+}
+
+bool counting_mem_resource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
@@ -0,0 +1,110 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_ARENA_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_ARENA_H
+
+#include <logger_guardant.h>
+#include <pp_allocator.h>
+#include <typename_holder.h>
+#include <memory>
+
+/**
+ * Monotonic bump allocator for short-lived computation scopes.
+ *
+ * Blocks are carved one after another out of chunks taken from the parent
+ * allocator, each new chunk twice as large as the one before it in the
+ * chain. Deallocation is a no-op, except that freeing the most recent block
+ * gives its bytes back, so a temporary freed right away costs nothing.
+ * Memory returns to the parent in bulk on `rewind`, `release` or
+ * destruction, except for the largest chunk freed, which is kept to serve
+ * the next chunk that fits in it.
+ *
+ * Not synchronized: an arena belongs to one computation on one thread.
+ */
+class allocator_arena final : public smart_mem_resource,
+                              private logger_guardant,
+                              private typename_holder {
+
+  public:
+    struct arena_state;
+
+    /** Position of the bump pointer, see `mark` */
+    struct checkpoint {
+        void *chunk_;
+        size_t used_;
+    };
+
+    /** Rewinds the arena to where it was on construction when destroyed */
+    class scope {
+        allocator_arena &_arena;
+        checkpoint _checkpoint;
+
+      public:
+        explicit scope(allocator_arena &arena) noexcept;
+
+        scope(scope const &other) = delete;
+
+        scope &operator=(scope const &other) = delete;
+
+        ~scope();
+    };
+
+  private:
+    std::unique_ptr<arena_state> _state;
+
+  public:
+    explicit allocator_arena(
+        size_t initial_chunk_size = 4096,
+        std::pmr::memory_resource *parent_allocator = nullptr,
+        logger *logger = nullptr);
+
+    ~allocator_arena() override;
+
+    allocator_arena(allocator_arena const &other) = delete;
+
+    allocator_arena &operator=(allocator_arena const &other) = delete;
+
+    allocator_arena(allocator_arena &&other) noexcept;
+
+    allocator_arena &operator=(allocator_arena &&other) noexcept;
+
+  public:
+    [[nodiscard]] void *do_allocate_sm(size_t size) override;
+
+    [[nodiscard]] void *do_allocate_sm(size_t size, size_t alignment) override;
+
+    void do_deallocate_sm(void *at) override;
+
+    /** The most recent block can grow up to the end of its chunk */
+    bool do_try_resize_sm(void *at, size_t new_size) override;
+
+    bool
+    do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+  public:
+    checkpoint mark() const noexcept;
+
+    /**
+     * Frees everything allocated since `checkpoint` was taken, chunks
+     * chained after it go back to the parent. A checkpoint whose chunk a
+     * `release` or an earlier rewind has already freed rewinds everything,
+     * the same as `release`.
+     */
+    void rewind(checkpoint checkpoint) noexcept;
+
+    /**
+     * Frees every block. The largest chunk is kept for reuse, so a
+     * computation repeated on the same arena stops calling the parent.
+     */
+    void release() noexcept;
+
+    /** Bytes handed out since the last release, padding included */
+    size_t used_bytes() const noexcept;
+
+  private:
+    void *allocate_from_new_chunk(size_t size, size_t alignment);
+
+    inline logger *get_logger() const override;
+
+    inline std::string get_typename() const noexcept override;
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_ARENA_H
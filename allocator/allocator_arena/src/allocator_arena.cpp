@@ -0,0 +1,252 @@
+#include "../include/allocator_arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <utility>
+
+namespace {
+
+// chains the chunks newest first, padded so that the first block is aligned
+struct chunk_header {
+    chunk_header *prev_;
+    size_t size_;
+
+    /** Bytes used in all older chunks when this one was chained */
+    size_t used_before_;
+};
+
+constexpr size_t chunk_header_size =
+    (sizeof(chunk_header) + alignof(std::max_align_t) - 1) /
+    alignof(std::max_align_t) * alignof(std::max_align_t);
+
+} // namespace
+
+struct allocator_arena::arena_state {
+    std::pmr::memory_resource *parent_;
+    logger *logger_;
+    size_t initial_chunk_size_;
+    size_t next_chunk_size_;
+
+    chunk_header *current_ = nullptr;
+
+    /** Largest chunk freed since, kept out of the chain for reuse */
+    chunk_header *spare_ = nullptr;
+
+    /** Bump offset from the start of `current_`, header included */
+    size_t used_ = 0;
+
+    /** The only block whose deallocation is not a no-op */
+    std::byte *last_block_ = nullptr;
+
+    std::byte *chunk_start() const noexcept {
+        return reinterpret_cast<std::byte *>(current_);
+    }
+
+    void free_chunk(chunk_header *chunk) const noexcept {
+        parent_->deallocate(chunk, chunk->size_, alignof(std::max_align_t));
+    }
+
+    /** Keeps the larger of `chunk` and the spare one, frees the other */
+    void retire_chunk(chunk_header *chunk) noexcept {
+        if (spare_ != nullptr && spare_->size_ >= chunk->size_) {
+            free_chunk(chunk);
+            return;
+        }
+
+        if (spare_ != nullptr) {
+            free_chunk(spare_);
+        }
+        spare_ = chunk;
+    }
+
+    bool is_chained(const chunk_header *chunk) const noexcept {
+        auto current = current_;
+        while (current != chunk && current != nullptr) {
+            current = current->prev_;
+        }
+        return current == chunk;
+    }
+};
+
+allocator_arena::allocator_arena(size_t initial_chunk_size,
+                                 std::pmr::memory_resource *parent_allocator,
+                                 logger *logger)
+    : _state(std::make_unique<arena_state>()) {
+    if (initial_chunk_size == 0) {
+        throw std::logic_error("`initial_chunk_size` must be positive");
+    }
+
+    _state->parent_ = parent_allocator != nullptr
+                          ? parent_allocator
+                          : std::pmr::get_default_resource();
+    _state->logger_ = logger;
+    _state->initial_chunk_size_ = chunk_header_size + initial_chunk_size;
+    _state->next_chunk_size_ = _state->initial_chunk_size_;
+}
+
+allocator_arena::~allocator_arena() {
+    if (!_state) {
+        return;
+    }
+
+    release();
+
+    if (_state->spare_ != nullptr) {
+        _state->free_chunk(_state->spare_);
+    }
+}
+
+allocator_arena::allocator_arena(allocator_arena &&other) noexcept
+    : _state(std::move(other._state)) {
+}
+
+allocator_arena &allocator_arena::operator=(allocator_arena &&other) noexcept {
+    if (this != &other) {
+        std::swap(_state, other._state);
+    }
+    return *this;
+}
+
+[[nodiscard]] void *allocator_arena::do_allocate_sm(size_t size) {
+    return do_allocate_sm(size, alignof(std::max_align_t));
+}
+
+[[nodiscard]] void *allocator_arena::do_allocate_sm(size_t size,
+                                                    size_t alignment) {
+    auto &state = *_state;
+
+    if (state.current_ != nullptr) {
+        const auto start = reinterpret_cast<std::uintptr_t>(state.current_);
+        const size_t offset =
+            ((start + state.used_ + alignment - 1) & ~(alignment - 1)) - start;
+
+        if (offset <= state.current_->size_ &&
+            size <= state.current_->size_ - offset) {
+            state.last_block_ = state.chunk_start() + offset;
+            state.used_ = offset + size;
+            return state.last_block_;
+        }
+    }
+
+    return allocate_from_new_chunk(size, alignment);
+}
+
+void *allocator_arena::allocate_from_new_chunk(size_t size, size_t alignment) {
+    auto &state = *_state;
+
+    // the request fits whatever padding the chunk start needs
+    const size_t min_chunk_size =
+        chunk_header_size + size +
+        std::max(alignment, alignof(std::max_align_t));
+
+    chunk_header *chunk;
+
+    if (state.spare_ != nullptr && state.spare_->size_ >= min_chunk_size) {
+        chunk = std::exchange(state.spare_, nullptr);
+    } else {
+        const size_t chunk_size =
+            std::max(state.next_chunk_size_, min_chunk_size);
+
+        chunk = static_cast<chunk_header *>(
+            state.parent_->allocate(chunk_size, alignof(std::max_align_t)));
+        chunk->size_ = chunk_size;
+
+        information_with_guard([chunk_size] {
+            return std::format("[*] new chunk of {} bytes", chunk_size);
+        });
+    }
+
+    chunk->prev_ = state.current_;
+    chunk->used_before_ = used_bytes();
+
+    state.current_ = chunk;
+    state.used_ = chunk_header_size;
+    state.next_chunk_size_ = chunk->size_ * 2;
+
+    return do_allocate_sm(size, alignment);
+}
+
+void allocator_arena::do_deallocate_sm(void *at) {
+    auto &state = *_state;
+
+    if (at == state.last_block_) {
+        state.used_ = state.last_block_ - state.chunk_start();
+        state.last_block_ = nullptr;
+    }
+}
+
+bool allocator_arena::do_try_resize_sm(void *at, size_t new_size) {
+    auto &state = *_state;
+
+    if (at != state.last_block_) {
+        return false;
+    }
+
+    const size_t offset = state.last_block_ - state.chunk_start();
+    if (new_size > state.current_->size_ - offset) {
+        return false;
+    }
+
+    state.used_ = offset + new_size;
+    return true;
+}
+
+bool allocator_arena::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+allocator_arena::checkpoint allocator_arena::mark() const noexcept {
+    return {_state->current_, _state->used_};
+}
+
+void allocator_arena::rewind(checkpoint checkpoint) noexcept {
+    auto &state = *_state;
+
+    // its chunk is gone already, so is everything allocated after it
+    if (!state.is_chained(static_cast<chunk_header *>(checkpoint.chunk_))) {
+        checkpoint = {nullptr, 0};
+    }
+
+    while (state.current_ != checkpoint.chunk_) {
+        const auto prev = state.current_->prev_;
+        state.retire_chunk(state.current_);
+        state.current_ = prev;
+    }
+
+    state.used_ = checkpoint.used_;
+    state.last_block_ = nullptr;
+
+    // growth follows the chain that is left, not the chunks just freed
+    state.next_chunk_size_ = state.current_ != nullptr
+                                 ? state.current_->size_ * 2
+                                 : state.initial_chunk_size_;
+}
+
+void allocator_arena::release() noexcept {
+    rewind({nullptr, 0});
+}
+
+size_t allocator_arena::used_bytes() const noexcept {
+    const auto &state = *_state;
+
+    return state.current_ != nullptr ? state.current_->used_before_ +
+                                           state.used_ - chunk_header_size
+                                     : 0;
+}
+
+inline logger *allocator_arena::get_logger() const {
+    return _state->logger_;
+}
+
+inline std::string allocator_arena::get_typename() const noexcept {
+    return "allocator_arena";
+}
+
+allocator_arena::scope::scope(allocator_arena &arena) noexcept
+    : _arena(arena), _checkpoint(arena.mark()) {
+}
+
+allocator_arena::scope::~scope() {
+    _arena.rewind(_checkpoint);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <allocator_arena.h>
+#include <pp_vector.h>
+#include <vector>
+
+TEST(allocatorArenaTests, test1)
+{
+    counting_mem_resource parent;
+
+    {
+        allocator_arena allocator(256, &parent);
+        ASSERT_EQ(parent.allocations, 0);
+
+        auto first_block = static_cast<std::byte *>(allocator.allocate(10, 1));
+        auto second_block = static_cast<std::byte *>(allocator.allocate(8, 8));
+        ASSERT_EQ(parent.allocations, 1);
+        ASSERT_EQ(second_block, first_block + 16);
+        ASSERT_EQ(allocator.used_bytes(), 24);
+
+        // only the most recent block gives its bytes back
+        allocator.deallocate(first_block, 10, 1);
+        allocator.deallocate(second_block, 8, 8);
+        ASSERT_EQ(allocator.allocate(8, 8), second_block);
+
+        ASSERT_TRUE(allocator.try_resize(second_block, 100));
+        ASSERT_FALSE(allocator.try_resize(first_block, 20));
+        ASSERT_FALSE(allocator.try_resize(second_block, 1000));
+        ASSERT_EQ(allocator.used_bytes(), 116);
+
+        auto aligned_block = allocator.allocate(64, 64);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned_block) % 64, 0);
+
+        // doesn't fit the rest of the chunk, the next one is twice as large
+        auto large_block = allocator.allocate(400);
+        ASSERT_EQ(parent.allocations, 2);
+        ASSERT_NE(large_block, nullptr);
+
+        allocator.release();
+        ASSERT_EQ(parent.deallocations, 1);
+        ASSERT_EQ(allocator.used_bytes(), 0);
+        ASSERT_EQ(allocator.allocate(400), large_block);
+        ASSERT_EQ(parent.allocations, 2);
+    }
+
+    ASSERT_EQ(parent.deallocations, 2);
+    ASSERT_THROW(allocator_arena(0), std::logic_error);
+}
+
+TEST(allocatorArenaTests, test2)
+{
+    counting_mem_resource parent;
+    allocator_arena allocator(128, &parent);
+
+    auto outer_block = allocator.allocate(64);
+    const size_t used_bytes = allocator.used_bytes();
+
+    {
+        allocator_arena::scope scope(allocator);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            static_cast<void>(allocator.allocate(100));
+        }
+        ASSERT_GT(parent.allocations, 1);
+    }
+
+    // chunks chained inside the scope went back but the largest one, kept for
+    // reuse, and the outer block is intact
+    ASSERT_EQ(parent.deallocations, parent.allocations - 2);
+    ASSERT_EQ(allocator.used_bytes(), used_bytes);
+    ASSERT_EQ(static_cast<std::byte *>(allocator.allocate(64)), static_cast<std::byte *>(outer_block) + 64);
+}
+
+TEST(allocatorArenaTests, test3)
+{
+    counting_mem_resource parent;
+    allocator_arena allocator(1024, &parent);
+    pp_allocator<unsigned int> digits_allocator(&allocator);
+
+    const auto compute = [&]()
+    {
+        unsigned long long sum = 0;
+
+        for (unsigned int n = 1; n <= 50; ++n)
+        {
+            std::vector<unsigned int, pp_allocator<unsigned int>> temporary(n, n, digits_allocator);
+            pp_vector<unsigned int> growing(digits_allocator);
+
+            for (unsigned int i = 0; i < n * 10; ++i)
+            {
+                growing.push_back(i);
+            }
+
+            for (auto digit: temporary)
+            {
+                sum += digit;
+            }
+            sum += growing.back();
+        }
+
+        allocator.release();
+
+        return sum;
+    };
+
+    const auto expected = compute();
+    const size_t allocations = parent.allocations;
+
+    // once warmed up the kept chunk serves the whole computation
+    for (int i = 0; i < 10; ++i)
+    {
+        ASSERT_EQ(compute(), expected);
+    }
+    ASSERT_EQ(parent.allocations, allocations);
+}
+
+TEST(allocatorArenaTests, test4)
+{
+    counting_mem_resource parent;
+    allocator_arena allocator(4096, &parent);
+
+    // one scope per top-level operation, the footprint must not keep growing
+    for (int i = 0; i < 1000; ++i)
+    {
+        allocator_arena::scope scope(allocator);
+
+        static_cast<void>(allocator.allocate(100));
+        if (i % 10 == 0)
+        {
+            static_cast<void>(allocator.allocate(10'000));
+        }
+    }
+    ASSERT_LT(parent.peak_allocated_bytes, 64 * 1024);
+    ASSERT_LE(parent.allocations, 3);
+
+    // a checkpoint into a chunk `release` gave up rewinds everything
+    static_cast<void>(allocator.allocate(100));
+    const auto checkpoint = allocator.mark();
+    allocator.release();
+    allocator.rewind(checkpoint);
+    ASSERT_EQ(allocator.used_bytes(), 0);
+    ASSERT_NE(allocator.allocate(100), nullptr);
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -3,19 +3,85 @@
 
 #include <allocator_test_utils.h>
 #include <allocator_with_fit_mode.h>
+#include <allocator_with_stats.h>
 #include <pp_allocator.h>
 #include <logger_guardant.h>
 #include <typename_holder.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <mutex>
 
+template <allocator_with_fit_mode::fit_mode Mode>
+class allocator_boundary_tags_t;
+
 class allocator_boundary_tags final : public smart_mem_resource,
                                       public allocator_test_utils,
                                       public allocator_with_fit_mode,
+                                      public allocator_with_stats,
                                       private logger_guardant,
                                       private typename_holder {
 
   private:
+#ifdef BOUNDARY_TAGS_COMPACT_HEADERS
+    /**
+     * Pointer kept as a 32-bit offset from its own address, 0 is nullptr.
+     * Both ends have to live in the same arena.
+     */
+    template <typename T> class relative_ptr {
+        std::int32_t _offset = 0;
+
+      public:
+        relative_ptr() noexcept = default;
+
+        relative_ptr(relative_ptr const &other) noexcept {
+            *this = other.get();
+        }
+
+        relative_ptr &operator=(relative_ptr const &other) noexcept {
+            return *this = other.get();
+        }
+
+        relative_ptr &operator=(T *target) noexcept {
+            _offset = target != nullptr
+                          ? static_cast<std::int32_t>(
+                                reinterpret_cast<const std::byte *>(target) -
+                                reinterpret_cast<const std::byte *>(this))
+                          : 0;
+            return *this;
+        }
+
+        T *get() const noexcept {
+            if (_offset == 0) {
+                return nullptr;
+            }
+
+            return reinterpret_cast<T *>(
+                const_cast<std::byte *>(
+                    reinterpret_cast<const std::byte *>(this)) +
+                _offset);
+        }
+
+        operator T *() const noexcept { return get(); }
+
+        T *operator->() const noexcept { return get(); }
+    };
+
+    /** Compact headers limit every arena to this many bytes */
+    static constexpr const size_t max_arena_size = size_t{1} << 30;
+
+    /**
+     * 16 bytes instead of 32: links are relative to the header and the
+     * owning arena is found by address instead of being stored. Padded from
+     * 12, so that the payload right after it stays aligned.
+     */
+    struct alignas(std::max_align_t) block_metadata {
+
+        std::uint32_t block_size_;
+        relative_ptr<block_metadata> next_;
+        relative_ptr<block_metadata> prev_;
+#else
     struct block_metadata {
 
         size_t block_size_;
@@ -23,6 +89,7 @@ class allocator_boundary_tags final : public smart_mem_resource,
         block_metadata *prev_ = nullptr;
 
         void *tm_ptr_;
+#endif
 
         std::byte *block_end() noexcept {
             return reinterpret_cast<std::byte *>(this) +
@@ -35,7 +102,58 @@ class allocator_boundary_tags final : public smart_mem_resource,
         }
     };
 
-    struct allocator_metadata {
+    /**
+     * Header written at the start of every hole when the segregated index is
+     * enabled. Holes are never smaller than `min_block_size`, so it always
+     * fits.
+     */
+    struct free_block_metadata {
+#ifdef BOUNDARY_TAGS_COMPACT_HEADERS
+        std::uint32_t size_;
+        relative_ptr<free_block_metadata> next_;
+        relative_ptr<free_block_metadata> prev_;
+
+        /** Occupied block right before the hole, or trusted memory */
+        relative_ptr<void> owner_;
+#else
+        size_t size_;
+        free_block_metadata *next_;
+        free_block_metadata *prev_;
+
+        /** Occupied block right before the hole, or trusted memory */
+        void *owner_;
+#endif
+    };
+
+    /** Handle table slot, free slots chain through `next_free_` */
+    struct handle_entry {
+        block_metadata *block_;
+        size_t next_free_;
+    };
+
+    static constexpr const size_t free_index_bins = sizeof(size_t) * 8;
+
+    /** Every power-of-two bin is split into this many equal size classes */
+    static constexpr const size_t free_index_sub_bins_log = 2;
+    static constexpr const size_t free_index_sub_bins =
+        size_t{1} << free_index_sub_bins_log;
+
+    static constexpr const size_t free_index_classes =
+        free_index_bins * free_index_sub_bins;
+
+    /**
+     * Two-level size classes: bin `i` holds holes of size [2^i, 2^(i+1)),
+     * split into `free_index_sub_bins` classes of equal width. Classes are
+     * unsorted lists, `bins_mask_` has bit `i` set while bin `i` has a
+     * non-empty class and `sub_bins_masks_[i]` tells which.
+     */
+    struct alignas(std::max_align_t) free_index {
+        size_t bins_mask_;
+        std::uint8_t sub_bins_masks_[free_index_bins];
+        free_block_metadata *heads_[free_index_classes];
+    };
+
+    struct alignas(std::max_align_t) allocator_metadata {
         logger *logger_;
 
         fit_mode fit_mode_;
@@ -48,12 +166,75 @@ class allocator_boundary_tags final : public smart_mem_resource,
 
         memory_resource *allocator_;
 
+        free_index *index_;
+
+        /** Arena owning the chain, the primary arena points to itself */
+        void *primary_;
+
+        /** Next arena of the chain, nullptr for the last one */
+        void *next_arena_;
+
+        /**
+         * Pool bytes of the whole chain and the cap it may grow to, only
+         * kept up to date in the primary arena
+         */
+        size_t total_size_;
+        size_t max_total_size_;
+
+        /** Chain-wide, only kept up to date in the primary arena */
+        stats_counters stats_;
+
+        /**
+         * Holes as large as `stats_.largest_free_block`, the chain is only
+         * searched for the next largest one once the last of them shrinks
+         */
+        size_t largest_free_blocks_count_;
+
+        /**
+         * Handle table allocated from `allocator_` on the first handle, only
+         * kept in the primary arena. Handle `h` is slot `h - 1`.
+         */
+        handle_entry *handles_;
+        size_t handles_capacity_;
+        size_t handles_count_;
+        size_t free_handle_;
+
+        size_t header_size() const noexcept {
+            return sizeof(allocator_metadata) +
+                   (index_ != nullptr ? sizeof(free_index) : 0);
+        }
+
+        std::byte *pool_start() noexcept {
+            return reinterpret_cast<std::byte *>(this) + header_size();
+        }
+
+        const std::byte *pool_start() const noexcept {
+            return reinterpret_cast<const std::byte *>(this) + header_size();
+        }
+
         const std::byte *allocator_end() const noexcept {
-            return reinterpret_cast<const std::byte *>(this) +
-                   sizeof(allocator_metadata) + mem_size_;
+            return pool_start() + mem_size_;
         }
     };
 
+    /** Neither blocks nor holes get smaller, so any hole can be indexed */
+    static constexpr const size_t min_block_size =
+        std::max(sizeof(block_metadata), sizeof(free_block_metadata));
+
+    /**
+     * Every block and hole is a multiple of this, so payloads that follow a
+     * header keep the pool start alignment
+     */
+    static constexpr const size_t block_granularity =
+        alignof(std::max_align_t);
+
+    static_assert(sizeof(block_metadata) % block_granularity == 0 &&
+                  min_block_size % block_granularity == 0);
+
+    /** Room for the slot number in front of a handle block payload */
+    static constexpr const size_t handle_prefix_size =
+        alignof(std::max_align_t);
+
     static constexpr const size_t occupied_block_metadata_size =
         sizeof(size_t) + sizeof(void *) + sizeof(void *) + sizeof(void *);
     void *_trusted_memory;
@@ -72,29 +253,80 @@ class allocator_boundary_tags final : public smart_mem_resource,
     operator=(allocator_boundary_tags &&other) noexcept;
 
   public:
+    /**
+     * @param use_free_index keep holes in segregated size-class lists instead
+     * of scanning the whole block chain on every allocation. First fit then
+     * means "first hole found in the index" rather than "lowest address".
+     * @param max_space_size lets the pool grow up to this many bytes by
+     * chaining arenas from `parent_allocator`, each at least as large as
+     * everything before it. Arenas that become empty are given back. Zero or
+     * anything up to `space_size` keeps the pool fixed.
+     */
     explicit allocator_boundary_tags(
         size_t space_size,
         std::pmr::memory_resource *parent_allocator = nullptr,
         logger *logger = nullptr,
         allocator_with_fit_mode::fit_mode allocate_fit_mode =
-            allocator_with_fit_mode::fit_mode::first_fit);
+            allocator_with_fit_mode::fit_mode::first_fit,
+        bool use_free_index = false, size_t max_space_size = 0);
 
   public:
     [[nodiscard]] void *do_allocate_sm(size_t bytes) override;
 
+    /**
+     * Alignments up to `alignof(std::max_align_t)` keep blocks packed one
+     * after another, as every block size is rounded up to it. Stricter ones
+     * shift the block forward, leaving the padding as a free hole in front
+     * of it.
+     */
+    [[nodiscard]] void *do_allocate_sm(size_t bytes,
+                                       size_t alignment) override;
+
     void do_deallocate_sm(void *at) override;
 
+    /**
+     * Moves the end of the block into the hole right after it, O(1) without
+     * the free index. Leftovers smaller than a header stay with the block.
+     */
+    bool do_try_resize_sm(void *at, size_t new_size) override;
+
     bool
     do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
 
+  public:
+    /** Stable name of a block that `compact` may move, 0 is never a handle */
+    using handle = size_t;
+
+    /**
+     * Allocates a block that is only reached through `resolve`, so that
+     * `compact` is free to slide it towards the start of its arena
+     */
+    handle allocate_handle(size_t size);
+
+    void deallocate_handle(handle block);
+
+    /** Current address of the block, valid until the next `compact` */
+    void *resolve(handle block);
+
+    /**
+     * One slice of compaction: handle blocks are moved down into the holes
+     * in front of them until at least `max_moved_bytes` are copied or none is
+     * left. Blocks allocated without a handle stay where they are and keep
+     * the hole in front of them.
+     * @return bytes moved, 0 once the arenas are as compact as they get
+     */
+    size_t compact(size_t max_moved_bytes);
+
   public:
     inline void set_first_block(void *block);
-    inline void set_fit_mode(allocator_with_fit_mode::fit_mode mode) override;
+    void set_fit_mode(allocator_with_fit_mode::fit_mode mode) override;
 
   public:
     std::vector<allocator_test_utils::block_info>
     get_blocks_info() const override;
 
+    stats get_stats() const noexcept override;
+
   private:
     std::vector<allocator_test_utils::block_info>
     get_blocks_info_inner() const override;
@@ -111,14 +343,55 @@ class allocator_boundary_tags final : public smart_mem_resource,
     static inline const allocator_metadata &
     get_allocator_metadata(const void *trusted) noexcept;
 
-    inline block_metadata *get_block_first_fit(size_t size) const noexcept;
+    /**
+     * Creates an arena with one hole spanning the whole pool, laid out the
+     * same way as the primary one
+     */
+    static void *create_arena(memory_resource *allocator, size_t space_size,
+                              bool use_free_index);
+
+    static void destroy_arena(void *arena) noexcept;
+
+    /** Expects the mutex to be held, throws for unknown handles */
+    block_metadata *get_handle_block(handle block);
+
+    /** Handle slot `block` is registered under, nullptr for pinned blocks */
+    handle_entry *get_handle_entry(block_metadata *block) const noexcept;
+
+    /** Chains an arena able to hold `size` bytes, nullptr past the cap */
+    void *grow(size_t size);
+
+    void release_arena(void *arena) noexcept;
+
+    /** Arena `block` was carved from, throws for blocks of other allocators */
+    void *get_owning_arena(const block_metadata *block);
+
+    /**
+     * Same as `do_allocate_sm` with the fit mode fixed at compile time, the
+     * mode stored in the metadata is ignored
+     */
+    template <allocator_with_fit_mode::fit_mode Mode>
+    void *allocate_sm(size_t size, size_t alignment);
+
+    /** Expects the mutex to be held */
+    template <allocator_with_fit_mode::fit_mode Mode>
+    void *allocate_locked(size_t size, size_t alignment);
+
+    /** Expects the mutex to be held */
+    void deallocate_locked(void *at);
+
+    /** Hole owner of the fitting hole found in any arena, nullptr if none */
+    template <allocator_with_fit_mode::fit_mode Mode>
+    block_metadata *get_block(size_t size, void *&arena) const noexcept;
 
-    inline block_metadata *get_block_best_fit(size_t size) const noexcept;
+    static inline block_metadata *get_block_first_fit(void *trusted,
+                                                      size_t size) noexcept;
 
-    inline block_metadata *get_block_worst_fit(size_t size) const noexcept;
+    static inline block_metadata *get_block_best_fit(void *trusted,
+                                                     size_t size) noexcept;
 
-    inline size_t
-    get_next_free_block_size(const block_metadata *block) const noexcept;
+    static inline block_metadata *get_block_worst_fit(void *trusted,
+                                                      size_t size) noexcept;
 
     static inline size_t
     get_next_free_block_size(void *trusted,
@@ -126,6 +399,37 @@ class allocator_boundary_tags final : public smart_mem_resource,
 
     inline size_t get_available_memory() const noexcept;
 
+    static inline std::byte *get_hole_start(void *trusted,
+                                            const block_metadata *block) noexcept;
+
+    static inline size_t get_padding(const std::byte *hole,
+                                     size_t alignment) noexcept;
+
+    /** Size class `size` belongs to */
+    static inline size_t get_size_class(size_t size) noexcept;
+
+    /** Lowest class whose every hole is at least `size` bytes */
+    static inline size_t get_size_class_above(size_t size) noexcept;
+
+    /** Lowest non-empty class from `size_class` up, free_index_classes if none */
+    static inline size_t get_nonempty_class(const free_index &index,
+                                            size_t size_class) noexcept;
+
+    template <allocator_with_fit_mode::fit_mode Mode>
+    inline block_metadata *get_block_indexed(void *trusted,
+                                             size_t size) const noexcept;
+
+    static inline void index_insert(void *trusted, std::byte *hole,
+                                    size_t size, void *owner) noexcept;
+
+    static inline void index_erase(void *trusted, std::byte *hole) noexcept;
+
+    inline void stats_hole_added(size_t size) noexcept;
+
+    inline void stats_hole_removed(size_t size) noexcept;
+
+    void stats_refresh_largest() noexcept;
+
     class boundary_iterator {
         void *_occupied_ptr;
         bool _occupied;
@@ -146,9 +450,9 @@ class allocator_boundary_tags final : public smart_mem_resource,
 
         boundary_iterator &operator--() & noexcept;
 
-        boundary_iterator operator++(int n);
+        boundary_iterator operator++(int);
 
-        boundary_iterator operator--(int n);
+        boundary_iterator operator--(int);
 
         size_t size() const noexcept;
 
@@ -165,9 +469,74 @@ class allocator_boundary_tags final : public smart_mem_resource,
 
     friend class boundary_iterator;
 
+    template <allocator_with_fit_mode::fit_mode Mode>
+    friend class allocator_boundary_tags_t;
+
     boundary_iterator begin() const noexcept;
 
     boundary_iterator end() const noexcept;
 };
 
+/**
+ * Boundary tags pool with the fit mode fixed at compile time. Allocation skips
+ * the switch over the runtime mode and only the search of `Mode` is compiled
+ * in, everything else is forwarded to the runtime allocator it wraps.
+ */
+template <allocator_with_fit_mode::fit_mode Mode>
+class allocator_boundary_tags_t final : public smart_mem_resource,
+                                        public allocator_test_utils,
+                                        public allocator_with_stats {
+
+    allocator_boundary_tags _allocator;
+
+  public:
+    explicit allocator_boundary_tags_t(
+        size_t space_size,
+        std::pmr::memory_resource *parent_allocator = nullptr,
+        logger *logger = nullptr, bool use_free_index = false,
+        size_t max_space_size = 0)
+        : _allocator(space_size, parent_allocator, logger, Mode,
+                     use_free_index, max_space_size) {
+    }
+
+  public:
+    [[nodiscard]] void *do_allocate_sm(size_t bytes) override {
+        return _allocator.allocate_sm<Mode>(bytes, 1);
+    }
+
+    [[nodiscard]] void *do_allocate_sm(size_t bytes,
+                                       size_t alignment) override {
+        return _allocator.allocate_sm<Mode>(bytes, alignment);
+    }
+
+    void do_deallocate_sm(void *at) override {
+        _allocator.do_deallocate_sm(at);
+    }
+
+    bool do_try_resize_sm(void *at, size_t new_size) override {
+        return _allocator.do_try_resize_sm(at, new_size);
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+  public:
+    std::vector<allocator_test_utils::block_info>
+    get_blocks_info() const override {
+        return _allocator.get_blocks_info();
+    }
+
+    stats get_stats() const noexcept override {
+        return _allocator.get_stats();
+    }
+
+  private:
+    std::vector<allocator_test_utils::block_info>
+    get_blocks_info_inner() const override {
+        return _allocator.get_blocks_info_inner();
+    }
+};
+
 #endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_BOUNDARY_TAGS_H
@@ -1,12 +1,23 @@
 #include <not_implemented.h>
 #include "../include/allocator_boundary_tags.h"
 #include <format>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
 
 allocator_boundary_tags::~allocator_boundary_tags() {
-    auto &metadata = get_allocator_metadata();
-    metadata.mutex_.~mutex();
-    metadata.allocator_->deallocate(
-        _trusted_memory, sizeof(allocator_metadata) + metadata.mem_size_, 1);
+    if (_trusted_memory == nullptr) {
+        return;
+    }
+
+    for (auto arena = get_allocator_metadata().next_arena_; arena != nullptr;) {
+        const auto next_arena = get_allocator_metadata(arena).next_arena_;
+        destroy_arena(arena);
+        arena = next_arena;
+    }
+
+    destroy_arena(_trusted_memory);
 }
 
 allocator_boundary_tags::allocator_boundary_tags(
@@ -24,50 +35,281 @@ allocator_boundary_tags::operator=(allocator_boundary_tags &&other) noexcept {
 
 allocator_boundary_tags::allocator_boundary_tags(
     size_t space_size, std::pmr::memory_resource *parent_allocator,
-    logger *logger, allocator_with_fit_mode::fit_mode allocate_fit_mode) {
-    if (space_size < sizeof(block_metadata)) {
+    logger *logger, allocator_with_fit_mode::fit_mode allocate_fit_mode,
+    bool use_free_index, size_t max_space_size) {
+    if (space_size < min_block_size) {
         throw std::logic_error(
             "`space_size` is not enough to fit a single block");
     }
 
+#ifdef BOUNDARY_TAGS_COMPACT_HEADERS
+    if (space_size > max_arena_size) {
+        throw std::logic_error(
+            "`space_size` is too large for compact block headers");
+    }
+#endif
+
     const auto allocator = parent_allocator != nullptr
                                ? parent_allocator
                                : std::pmr::get_default_resource();
 
-    _trusted_memory =
-        allocator->allocate(sizeof(allocator_metadata) + space_size, 1);
+    _trusted_memory = create_arena(allocator, space_size, use_free_index);
 
-    const auto metadata = static_cast<allocator_metadata *>(_trusted_memory);
+    auto &metadata = get_allocator_metadata();
+
+    metadata.logger_ = logger;
+    metadata.fit_mode_ = allocate_fit_mode;
+    metadata.max_total_size_ = std::max(space_size, max_space_size);
+
+    stats_hole_added(space_size);
+}
+
+void *allocator_boundary_tags::create_arena(memory_resource *allocator,
+                                            size_t space_size,
+                                            bool use_free_index) {
+    const size_t header_size =
+        sizeof(allocator_metadata) + (use_free_index ? sizeof(free_index) : 0);
+
+    void *arena = allocator->allocate(header_size + space_size,
+                                      alignof(allocator_metadata));
 
-    metadata->logger_ = logger;
-    metadata->fit_mode_ = allocate_fit_mode;
+    const auto metadata = static_cast<allocator_metadata *>(arena);
+
+    metadata->logger_ = nullptr;
+    metadata->fit_mode_ = fit_mode::first_fit;
     metadata->mem_size_ = space_size;
     metadata->first_block_ = nullptr;
     metadata->allocator_ = allocator;
+    metadata->index_ = nullptr;
+    metadata->primary_ = arena;
+    metadata->next_arena_ = nullptr;
+    metadata->total_size_ = space_size;
+    metadata->max_total_size_ = space_size;
+    metadata->largest_free_blocks_count_ = 0;
+    metadata->handles_ = nullptr;
+    metadata->handles_capacity_ = 0;
+    metadata->handles_count_ = 0;
+    metadata->free_handle_ = 0;
 
     std::construct_at(&metadata->mutex_);
+    std::construct_at(&metadata->stats_);
+
+    if (use_free_index) {
+        metadata->index_ = std::construct_at(reinterpret_cast<free_index *>(
+            static_cast<std::byte *>(arena) + sizeof(allocator_metadata)));
+        index_insert(arena, metadata->pool_start(), space_size, arena);
+    }
+
+    return arena;
+}
+
+void allocator_boundary_tags::destroy_arena(void *arena) noexcept {
+    auto &metadata = get_allocator_metadata(arena);
+    if (metadata.handles_ != nullptr) {
+        metadata.allocator_->deallocate(
+            metadata.handles_, metadata.handles_capacity_ * sizeof(handle_entry),
+            alignof(handle_entry));
+    }
+    metadata.mutex_.~mutex();
+    metadata.allocator_->deallocate(
+        arena, metadata.header_size() + metadata.mem_size_,
+        alignof(allocator_metadata));
+}
+
+void *allocator_boundary_tags::grow(size_t size) {
+    auto &metadata = get_allocator_metadata();
+
+    // each arena at least doubles the chain, so there are O(log) of them
+    size_t space_size =
+        std::min(std::max(metadata.total_size_, size),
+                 metadata.max_total_size_ - metadata.total_size_);
+
+#ifdef BOUNDARY_TAGS_COMPACT_HEADERS
+    space_size = std::min(space_size, max_arena_size);
+#endif
+
+    if (space_size < size) {
+        return nullptr;
+    }
+
+    void *arena =
+        create_arena(metadata.allocator_, space_size, metadata.index_ != nullptr);
+    get_allocator_metadata(arena).primary_ = _trusted_memory;
+
+    void *last_arena = _trusted_memory;
+    while (get_allocator_metadata(last_arena).next_arena_ != nullptr) {
+        last_arena = get_allocator_metadata(last_arena).next_arena_;
+    }
+    get_allocator_metadata(last_arena).next_arena_ = arena;
+
+    metadata.total_size_ += space_size;
+    stats_hole_added(space_size);
+
+    information_with_guard([&] {
+        return std::format("[*] grown by an arena of {} bytes", space_size);
+    });
+
+    return arena;
+}
+
+void allocator_boundary_tags::release_arena(void *arena) noexcept {
+    auto &metadata = get_allocator_metadata();
+
+    void *prev_arena = _trusted_memory;
+    while (get_allocator_metadata(prev_arena).next_arena_ != arena) {
+        prev_arena = get_allocator_metadata(prev_arena).next_arena_;
+    }
+    get_allocator_metadata(prev_arena).next_arena_ =
+        get_allocator_metadata(arena).next_arena_;
+
+    metadata.total_size_ -= get_allocator_metadata(arena).mem_size_;
+    stats_hole_removed(get_allocator_metadata(arena).mem_size_);
+
+    information_with_guard([&] {
+        return std::format("[*] released an empty arena of {} bytes",
+                           get_allocator_metadata(arena).mem_size_);
+    });
+
+    destroy_arena(arena);
+}
+
+void *
+allocator_boundary_tags::get_owning_arena(const block_metadata *block) {
+#ifdef BOUNDARY_TAGS_COMPACT_HEADERS
+    const auto address = reinterpret_cast<const std::byte *>(block);
+
+    for (void *arena = _trusted_memory; arena != nullptr;
+         arena = get_allocator_metadata(arena).next_arena_) {
+        const auto &arena_metadata = get_allocator_metadata(arena);
+        if (address >= arena_metadata.pool_start() &&
+            address < arena_metadata.allocator_end()) {
+            return arena;
+        }
+    }
+
+    error_with_guard([block] {
+        return std::format("[!] block doesn't belong to this allocator: {:p}",
+                           static_cast<const void *>(block + 1));
+    });
+    throw std::logic_error("unknown block");
+#else
+    void *arena = block->tm_ptr_;
+
+    // a single-arena pool never dereferences a foreign owner
+    if (arena != _trusted_memory &&
+        (get_allocator_metadata().next_arena_ == nullptr ||
+         get_allocator_metadata(arena).primary_ != _trusted_memory)) {
+        error_with_guard([block] {
+            return std::format(
+                "[!] block doesn't belong to this allocator: {:p}",
+                static_cast<const void *>(block + 1));
+        });
+        throw std::logic_error("unknown block");
+    }
+
+    return arena;
+#endif
+}
+
+template <allocator_with_fit_mode::fit_mode Mode>
+allocator_boundary_tags::block_metadata *
+allocator_boundary_tags::get_block(size_t size, void *&arena) const noexcept {
+    constexpr bool first_fit =
+        Mode == fit_mode::first_fit || Mode == fit_mode::next_fit;
+
+    const auto &metadata = get_allocator_metadata();
+
+    block_metadata *result = nullptr;
+    size_t result_size = 0;
+
+    for (void *current = _trusted_memory; current != nullptr;
+         current = get_allocator_metadata(current).next_arena_) {
+        block_metadata *block = nullptr;
+
+        if (metadata.index_ != nullptr) {
+            block = get_block_indexed<Mode>(current, size);
+        } else if constexpr (first_fit) {
+            block = get_block_first_fit(current, size);
+        } else if constexpr (Mode == fit_mode::the_best_fit) {
+            block = get_block_best_fit(current, size);
+        } else {
+            block = get_block_worst_fit(current, size);
+        }
+
+        if (block == nullptr) {
+            continue;
+        }
+
+        const size_t block_size = get_next_free_block_size(current, block);
+
+        if (result == nullptr ||
+            (Mode == fit_mode::the_best_fit && block_size < result_size) ||
+            (Mode == fit_mode::the_worst_fit && block_size > result_size)) {
+            result = block;
+            result_size = block_size;
+            arena = current;
+        }
+
+        if constexpr (first_fit) {
+            break;
+        }
+    }
+
+    return result;
 }
 
 [[nodiscard]] void *allocator_boundary_tags::do_allocate_sm(size_t size) {
-    size_t total_size = size + sizeof(block_metadata);
-    debug_with_guard(std::format("[*] allocating {} bytes", total_size));
+    return do_allocate_sm(size, 1);
+}
 
+[[nodiscard]] void *allocator_boundary_tags::do_allocate_sm(size_t size,
+                                                            size_t alignment) {
     auto &metadata = get_allocator_metadata();
 
     std::lock_guard lock(metadata.mutex_);
 
-    block_metadata *block = nullptr;
-
     switch (metadata.fit_mode_) {
     case fit_mode::first_fit:
-        block = get_block_first_fit(total_size);
-        break;
+        return allocate_locked<fit_mode::first_fit>(size, alignment);
     case fit_mode::the_best_fit:
-        block = get_block_best_fit(total_size);
-        break;
+        return allocate_locked<fit_mode::the_best_fit>(size, alignment);
     case fit_mode::the_worst_fit:
-        block = get_block_worst_fit(total_size);
-        break;
+        return allocate_locked<fit_mode::the_worst_fit>(size, alignment);
+    case fit_mode::next_fit:
+        return allocate_locked<fit_mode::next_fit>(size, alignment);
+    }
+
+    throw std::logic_error("unknown fit mode");
+}
+
+template <allocator_with_fit_mode::fit_mode Mode>
+void *allocator_boundary_tags::allocate_sm(size_t size, size_t alignment) {
+    std::lock_guard lock(get_allocator_metadata().mutex_);
+    return allocate_locked<Mode>(size, alignment);
+}
+
+template <allocator_with_fit_mode::fit_mode Mode>
+void *allocator_boundary_tags::allocate_locked(size_t size, size_t alignment) {
+    size_t total_size =
+        std::max(size + sizeof(block_metadata), min_block_size);
+    total_size = (total_size + block_granularity - 1) & ~(block_granularity - 1);
+    debug_with_guard(
+        [&] { return std::format("[*] allocating {} bytes", total_size); });
+
+    // over-aligned blocks may need a hole of at least one header in front
+    const bool over_aligned = alignment > block_granularity;
+    const size_t search_size =
+        over_aligned ? total_size + alignment + min_block_size
+                     : total_size;
+
+    auto &metadata = get_allocator_metadata();
+
+    void *arena = nullptr;
+    block_metadata *block = get_block<Mode>(search_size, arena);
+
+    if (block == nullptr && (arena = grow(search_size)) != nullptr) {
+        // a fresh arena is a single hole owned by the arena itself
+        block = static_cast<block_metadata *>(arena);
     }
 
     if (block == nullptr) {
@@ -76,45 +318,68 @@ allocator_boundary_tags::allocator_boundary_tags(
         throw std::bad_alloc();
     }
 
-    const size_t free_block_size = get_next_free_block_size(block);
+    auto &arena_metadata = get_allocator_metadata(arena);
+
+    std::byte *hole = get_hole_start(arena, block);
+    const size_t padding = over_aligned ? get_padding(hole, alignment) : 0;
+    const size_t free_block_size =
+        get_next_free_block_size(arena, block) - padding;
 
-    if (free_block_size < total_size + sizeof(block_metadata)) {
-        warning_with_guard(std::format("[*] changing block size to {} bytes",
-                                       free_block_size));
+    if (free_block_size < total_size + min_block_size) {
+        warning_with_guard([&] {
+            return std::format("[*] changing block size to {} bytes",
+                               free_block_size);
+        });
         total_size = free_block_size;
     }
 
-    block_metadata *free_block;
-    bool iter_begin = block == _trusted_memory;
+    bool iter_begin = block == arena;
+    auto free_block = reinterpret_cast<block_metadata *>(hole + padding);
 
-    if (iter_begin) {
-        free_block = reinterpret_cast<block_metadata *>(
-            static_cast<std::byte *>(_trusted_memory) +
-            sizeof(allocator_metadata));
-    } else {
-        free_block = reinterpret_cast<block_metadata *>(block->block_end());
+    if (metadata.index_ != nullptr) {
+        index_erase(arena, hole);
     }
 
     free_block->block_size_ = total_size - sizeof(block_metadata);
     free_block->prev_ = block;
-    free_block->next_ = iter_begin ? metadata.first_block_ : block->next_;
-    free_block->tm_ptr_ = _trusted_memory;
+    free_block->next_ = iter_begin ? arena_metadata.first_block_ : block->next_;
+#ifndef BOUNDARY_TAGS_COMPACT_HEADERS
+    free_block->tm_ptr_ = arena;
+#endif
 
     if (free_block->next_) {
         free_block->next_->prev_ = free_block;
     }
 
     if (iter_begin) {
-        metadata.first_block_ = free_block;
+        arena_metadata.first_block_ = free_block;
     } else {
         free_block->prev_->next_ = free_block;
     }
 
-    debug_with_guard(std::format("[+] allocated {} bytes at {:p}", total_size,
-                                 static_cast<void *>(free_block + 1)));
-    information_with_guard(
-        std::format("[*] available memory: {}", get_available_memory()));
-    debug_with_guard(print_blocks());
+    if (metadata.index_ != nullptr && free_block_size > total_size) {
+        index_insert(arena, free_block->block_end(),
+                     free_block_size - total_size, free_block);
+    }
+
+    if (metadata.index_ != nullptr && padding != 0) {
+        index_insert(arena, hole, padding, block);
+    }
+
+    stats_hole_removed(free_block_size + padding);
+    stats_hole_added(padding);
+    stats_hole_added(free_block_size - total_size);
+    metadata.stats_.block_allocated(total_size);
+    stats_refresh_largest();
+
+    debug_with_guard([&] {
+        return std::format("[+] allocated {} bytes at {:p}", total_size,
+                           static_cast<void *>(free_block + 1));
+    });
+    information_with_guard([this] {
+        return std::format("[*] available memory: {}", get_available_memory());
+    });
+    debug_with_guard([this] { return print_blocks(); });
 
     return free_block + 1;
 }
@@ -128,25 +393,49 @@ inline void allocator_boundary_tags::set_first_block(void *block) {
 }
 
 void allocator_boundary_tags::do_deallocate_sm(void *at) {
-    debug_with_guard(std::format("[*] deallocating block {:p}", at));
+    debug_with_guard(
+        [at] { return std::format("[*] deallocating block {:p}", at); });
 
-    auto &metadata = get_allocator_metadata();
+    std::lock_guard lock(get_allocator_metadata().mutex_);
+    deallocate_locked(at);
+}
 
-    std::lock_guard lock(metadata.mutex_);
+void allocator_boundary_tags::deallocate_locked(void *at) {
+    auto &metadata = get_allocator_metadata();
 
     auto block = reinterpret_cast<block_metadata *>(
         static_cast<std::byte *>(at) - sizeof(block_metadata));
 
-    if (block->tm_ptr_ != _trusted_memory) {
-        error_with_guard(std::format(
-            "[!] block doesn't belong to this allocator: {:p}", at));
-        throw std::logic_error("unknown block");
+    void *arena = get_owning_arena(block);
+
+    debug_with_guard([at, block] {
+        return get_dump(static_cast<char *>(at), block->block_size_);
+    });
+
+    auto &arena_metadata = get_allocator_metadata(arena);
+
+    std::byte *hole = get_hole_start(arena, block->prev_);
+    const size_t hole_before = reinterpret_cast<std::byte *>(block) - hole;
+    const size_t hole_after = get_next_free_block_size(arena, block);
+    const size_t block_size = sizeof(block_metadata) + block->block_size_;
+    const size_t hole_size = hole_before + block_size + hole_after;
+
+    if (metadata.index_ != nullptr) {
+        if (hole_before != 0) {
+            index_erase(arena, hole);
+        }
+        if (hole_after != 0) {
+            index_erase(arena, block->block_end());
+        }
     }
 
-    debug_with_guard(get_dump(static_cast<char *>(at), block->block_size_));
+    stats_hole_removed(hole_before);
+    stats_hole_removed(hole_after);
+    stats_hole_added(hole_size);
+    metadata.stats_.block_deallocated(block_size);
 
-    if (block->prev_ == _trusted_memory) {
-        metadata.first_block_ = block->next_;
+    if (block->prev_ == arena) {
+        arena_metadata.first_block_ = block->next_;
     } else {
         block->prev_->next_ = block->next_;
     }
@@ -155,14 +444,262 @@ void allocator_boundary_tags::do_deallocate_sm(void *at) {
         block->next_->prev_ = block->prev_;
     }
 
+    if (metadata.index_ != nullptr) {
+        // the hole header may overwrite `block` itself, so it goes in last
+        index_insert(arena, hole, hole_size, block->prev_);
+    }
+
+    if (arena != _trusted_memory && arena_metadata.first_block_ == nullptr) {
+        release_arena(arena);
+    }
+
+    stats_refresh_largest();
+
     debug_with_guard("[+] block deallocated successfully");
-    information_with_guard(
-        std::format("[*] available memory: {}", get_available_memory()));
-    debug_with_guard(print_blocks());
+    information_with_guard([this] {
+        return std::format("[*] available memory: {}", get_available_memory());
+    });
+    debug_with_guard([this] { return print_blocks(); });
+}
+
+bool allocator_boundary_tags::do_try_resize_sm(void *at, size_t new_size) {
+    auto &metadata = get_allocator_metadata();
+
+    std::lock_guard lock(metadata.mutex_);
+
+    auto block = reinterpret_cast<block_metadata *>(
+        static_cast<std::byte *>(at) - sizeof(block_metadata));
+
+    void *arena = get_owning_arena(block);
+
+    const size_t old_size = block->block_size_;
+    new_size = std::max(new_size, min_block_size - sizeof(block_metadata));
+    new_size = ((sizeof(block_metadata) + new_size + block_granularity - 1) &
+                ~(block_granularity - 1)) -
+               sizeof(block_metadata);
+    const size_t hole_after = get_next_free_block_size(arena, block);
+    const size_t available = old_size + hole_after;
+
+    if (new_size > available) {
+        debug_with_guard([&] {
+            return std::format("[*] can't resize {:p} to {} bytes in place", at,
+                               new_size);
+        });
+        return false;
+    }
+
+    // the new hole must fit a header, smaller tails stay with the block
+    const size_t block_size =
+        available - new_size < min_block_size ? available : new_size;
+    if (block_size == old_size) {
+        return true;
+    }
+
+    if (metadata.index_ != nullptr && hole_after != 0) {
+        index_erase(arena, block->block_end());
+    }
+
+    block->block_size_ = block_size;
+
+    if (metadata.index_ != nullptr && available != block_size) {
+        index_insert(arena, block->block_end(), available - block_size, block);
+    }
+
+    stats_hole_removed(hole_after);
+    stats_hole_added(available - block_size);
+    metadata.stats_.block_resized(old_size, block_size);
+    stats_refresh_largest();
+
+    debug_with_guard([&] {
+        return std::format("[+] resized {:p} from {} to {} bytes in place", at,
+                           old_size, block_size);
+    });
+
+    return true;
+}
+
+allocator_boundary_tags::handle
+allocator_boundary_tags::allocate_handle(size_t size) {
+    // the slot number sits in front of the payload, so a block being moved
+    // can find its slot
+    void *at = do_allocate_sm(handle_prefix_size + size, 1);
+
+    auto &metadata = get_allocator_metadata();
+    std::lock_guard lock(metadata.mutex_);
+
+    if (metadata.free_handle_ == 0 &&
+        metadata.handles_count_ == metadata.handles_capacity_) {
+        const size_t capacity = std::max<size_t>(16, metadata.handles_capacity_ * 2);
+        handle_entry *handles;
+
+        try {
+            handles = static_cast<handle_entry *>(metadata.allocator_->allocate(
+                capacity * sizeof(handle_entry), alignof(handle_entry)));
+        } catch (std::bad_alloc const &) {
+            deallocate_locked(at);
+            throw;
+        }
+
+        if (metadata.handles_ != nullptr) {
+            std::copy_n(metadata.handles_, metadata.handles_count_, handles);
+            metadata.allocator_->deallocate(
+                metadata.handles_,
+                metadata.handles_capacity_ * sizeof(handle_entry),
+                alignof(handle_entry));
+        }
+
+        metadata.handles_ = handles;
+        metadata.handles_capacity_ = capacity;
+    }
+
+    size_t slot;
+    if (metadata.free_handle_ != 0) {
+        slot = metadata.free_handle_ - 1;
+        metadata.free_handle_ = metadata.handles_[slot].next_free_;
+    } else {
+        slot = metadata.handles_count_++;
+    }
+
+    metadata.handles_[slot] = {reinterpret_cast<block_metadata *>(
+                                   static_cast<std::byte *>(at) -
+                                   sizeof(block_metadata)),
+                               0};
+    std::memcpy(at, &slot, sizeof(size_t));
+
+    return slot + 1;
+}
+
+void allocator_boundary_tags::deallocate_handle(handle block) {
+    auto &metadata = get_allocator_metadata();
+
+    // a compaction in between would move the block away from under us
+    std::lock_guard lock(metadata.mutex_);
+
+    block_metadata *handle_block = get_handle_block(block);
+
+    metadata.handles_[block - 1] = {nullptr, metadata.free_handle_};
+    metadata.free_handle_ = block;
+
+    deallocate_locked(handle_block + 1);
+}
+
+void *allocator_boundary_tags::resolve(handle block) {
+    std::lock_guard lock(get_allocator_metadata().mutex_);
+
+    return reinterpret_cast<std::byte *>(get_handle_block(block) + 1) +
+           handle_prefix_size;
+}
+
+allocator_boundary_tags::block_metadata *
+allocator_boundary_tags::get_handle_block(handle block) {
+    const auto &metadata = get_allocator_metadata();
+
+    if (block == 0 || block > metadata.handles_count_ ||
+        metadata.handles_[block - 1].block_ == nullptr) {
+        error_with_guard(
+            [block] { return std::format("[!] unknown handle: {}", block); });
+        throw std::logic_error("unknown handle");
+    }
+
+    return metadata.handles_[block - 1].block_;
+}
+
+allocator_boundary_tags::handle_entry *
+allocator_boundary_tags::get_handle_entry(
+    block_metadata *block) const noexcept {
+    const auto &metadata = get_allocator_metadata();
+
+    if (metadata.handles_ == nullptr ||
+        block->block_size_ < handle_prefix_size) {
+        return nullptr;
+    }
+
+    // a pinned block may hold anything there, its slot has to point back
+    size_t slot;
+    std::memcpy(&slot, block + 1, sizeof(size_t));
+
+    return slot < metadata.handles_count_ &&
+                   metadata.handles_[slot].block_ == block
+               ? &metadata.handles_[slot]
+               : nullptr;
 }
 
-inline void
-allocator_boundary_tags::set_fit_mode(allocator_with_fit_mode::fit_mode mode) {
+size_t allocator_boundary_tags::compact(size_t max_moved_bytes) {
+    auto &metadata = get_allocator_metadata();
+    std::lock_guard lock(metadata.mutex_);
+
+    size_t moved_bytes = 0;
+
+    for (void *arena = _trusted_memory;
+         arena != nullptr && moved_bytes < max_moved_bytes;
+         arena = get_allocator_metadata(arena).next_arena_) {
+        auto &arena_metadata = get_allocator_metadata(arena);
+        auto owner = static_cast<block_metadata *>(arena);
+
+        for (block_metadata *block = arena_metadata.first_block_;
+             block != nullptr && moved_bytes < max_moved_bytes;
+             owner = block, block = block->next_) {
+            std::byte *hole = get_hole_start(arena, owner);
+            const size_t hole_before = reinterpret_cast<std::byte *>(block) - hole;
+
+            handle_entry *entry;
+            if (hole_before == 0 || (entry = get_handle_entry(block)) == nullptr) {
+                continue;
+            }
+
+            const size_t hole_after = get_next_free_block_size(arena, block);
+            const size_t block_size = sizeof(block_metadata) + block->block_size_;
+            block_metadata *next = block->next_;
+
+            if (metadata.index_ != nullptr) {
+                index_erase(arena, hole);
+                if (hole_after != 0) {
+                    index_erase(arena, block->block_end());
+                }
+            }
+
+            // header and payload move as raw bytes, the links are fixed below
+            std::memmove(hole, block, block_size);
+            const auto moved = reinterpret_cast<block_metadata *>(hole);
+
+            // compact links are relative to where they are stored
+            moved->prev_ = owner;
+            moved->next_ = next;
+            if (owner == arena) {
+                arena_metadata.first_block_ = moved;
+            } else {
+                owner->next_ = moved;
+            }
+            if (next != nullptr) {
+                next->prev_ = moved;
+            }
+            entry->block_ = moved;
+
+            if (metadata.index_ != nullptr) {
+                index_insert(arena, moved->block_end(), hole_before + hole_after,
+                             moved);
+            }
+
+            stats_hole_removed(hole_before);
+            stats_hole_removed(hole_after);
+            stats_hole_added(hole_before + hole_after);
+
+            moved_bytes += block_size;
+            block = moved;
+        }
+    }
+
+    stats_refresh_largest();
+
+    debug_with_guard([&] {
+        return std::format("[*] compaction moved {} bytes", moved_bytes);
+    });
+
+    return moved_bytes;
+}
+
+void allocator_boundary_tags::set_fit_mode(
+    allocator_with_fit_mode::fit_mode mode) {
     std::string fit_mode_string;
 
     switch (mode) {
@@ -175,6 +712,9 @@ allocator_boundary_tags::set_fit_mode(allocator_with_fit_mode::fit_mode mode) {
     case fit_mode::the_worst_fit:
         fit_mode_string = "the_worst_fit";
         break;
+    case fit_mode::next_fit:
+        fit_mode_string = "next_fit";
+        break;
     }
 
     debug_with_guard(std::format("[*] setting fit mode: {}", fit_mode_string));
@@ -191,6 +731,11 @@ allocator_boundary_tags::get_blocks_info() const {
     return get_blocks_info_inner();
 }
 
+allocator_with_stats::stats
+allocator_boundary_tags::get_stats() const noexcept {
+    return get_allocator_metadata().stats_.load();
+}
+
 inline logger *allocator_boundary_tags::get_logger() const {
     const auto &metadata = get_allocator_metadata();
     return metadata.logger_;
@@ -216,8 +761,9 @@ allocator_boundary_tags::get_allocator_metadata(const void *trusted) noexcept {
 }
 
 inline allocator_boundary_tags::block_metadata *
-allocator_boundary_tags::get_block_first_fit(size_t size) const noexcept {
-    for (auto it = begin(); it != end(); ++it) {
+allocator_boundary_tags::get_block_first_fit(void *trusted,
+                                             size_t size) noexcept {
+    for (boundary_iterator it(trusted); it != boundary_iterator(); ++it) {
         if (!it.occupied() && it.size() >= size) {
             return static_cast<block_metadata *>(it.get_ptr());
         }
@@ -227,10 +773,11 @@ allocator_boundary_tags::get_block_first_fit(size_t size) const noexcept {
 }
 
 inline allocator_boundary_tags::block_metadata *
-allocator_boundary_tags::get_block_best_fit(size_t size) const noexcept {
+allocator_boundary_tags::get_block_best_fit(void *trusted,
+                                            size_t size) noexcept {
     boundary_iterator result;
 
-    for (auto it = begin(); it != end(); ++it) {
+    for (boundary_iterator it(trusted); it != boundary_iterator(); ++it) {
         if (!it.occupied() && it.size() >= size &&
             (it.size() < result.size() || result.get_ptr() == nullptr)) {
             result = it;
@@ -241,10 +788,11 @@ allocator_boundary_tags::get_block_best_fit(size_t size) const noexcept {
 }
 
 inline allocator_boundary_tags::block_metadata *
-allocator_boundary_tags::get_block_worst_fit(size_t size) const noexcept {
+allocator_boundary_tags::get_block_worst_fit(void *trusted,
+                                             size_t size) noexcept {
     boundary_iterator result;
 
-    for (auto it = begin(); it != end(); ++it) {
+    for (boundary_iterator it(trusted); it != boundary_iterator(); ++it) {
         if (!it.occupied() && it.size() >= size && it.size() > result.size()) {
             result = it;
         }
@@ -253,11 +801,6 @@ allocator_boundary_tags::get_block_worst_fit(size_t size) const noexcept {
     return static_cast<block_metadata *>(result.get_ptr());
 }
 
-inline size_t allocator_boundary_tags::get_next_free_block_size(
-    const block_metadata *block) const noexcept {
-    return get_next_free_block_size(_trusted_memory, block);
-}
-
 inline size_t allocator_boundary_tags::get_next_free_block_size(
     void *trusted, const block_metadata *block) noexcept {
     const auto &metadata = get_allocator_metadata(trusted);
@@ -267,24 +810,302 @@ inline size_t allocator_boundary_tags::get_next_free_block_size(
             return metadata.mem_size_;
         } else {
             return reinterpret_cast<std::byte *>(metadata.first_block_) -
-                   static_cast<std::byte *>(trusted) -
-                   sizeof(allocator_metadata);
+                   metadata.pool_start();
         }
     }
 
     if (block->next_ == nullptr) {
         return metadata.allocator_end() - block->block_end();
     } else {
-        return reinterpret_cast<std::byte *>(block->next_) - block->block_end();
+        return reinterpret_cast<std::byte *>(
+                   static_cast<block_metadata *>(block->next_)) -
+               block->block_end();
     }
 }
 
+inline std::byte *
+allocator_boundary_tags::get_hole_start(void *trusted,
+                                        const block_metadata *block) noexcept {
+    if (block == trusted) {
+        return get_allocator_metadata(trusted).pool_start();
+    }
+
+    return const_cast<std::byte *>(block->block_end());
+}
+
+inline size_t allocator_boundary_tags::get_padding(const std::byte *hole,
+                                                   size_t alignment) noexcept {
+    const auto data = reinterpret_cast<std::uintptr_t>(hole) +
+                      sizeof(block_metadata);
+    size_t padding = (alignment - data % alignment) % alignment;
+
+    // holes are never smaller than a header, over-alignment is at least 32
+    if (padding != 0 && padding < min_block_size) {
+        padding += alignment;
+    }
+
+    return padding;
+}
+
+inline size_t allocator_boundary_tags::get_size_class(size_t size) noexcept {
+    const size_t bin = std::bit_width(size) - 1;
+
+    // the bits right under the leading one pick the class within the bin
+    const size_t sub_bin =
+        bin >= free_index_sub_bins_log
+            ? size >> (bin - free_index_sub_bins_log)
+            : size << (free_index_sub_bins_log - bin);
+
+    return bin * free_index_sub_bins + (sub_bin & (free_index_sub_bins - 1));
+}
+
+inline size_t
+allocator_boundary_tags::get_size_class_above(size_t size) noexcept {
+    const size_t bin = std::bit_width(size) - 1;
+    const size_t class_width =
+        bin >= free_index_sub_bins_log
+            ? size_t{1} << (bin - free_index_sub_bins_log)
+            : 1;
+
+    return get_size_class(size + class_width - 1);
+}
+
+inline size_t
+allocator_boundary_tags::get_nonempty_class(const free_index &index,
+                                            size_t size_class) noexcept {
+    if (size_class >= free_index_classes) {
+        return free_index_classes;
+    }
+
+    size_t bin = size_class / free_index_sub_bins;
+    size_t sub_bins = index.sub_bins_masks_[bin] &
+                      (~size_t{0} << (size_class % free_index_sub_bins));
+
+    if (sub_bins == 0) {
+        const size_t larger_bins =
+            bin + 1 < free_index_bins
+                ? index.bins_mask_ & (~size_t{0} << (bin + 1))
+                : 0;
+        if (larger_bins == 0) {
+            return free_index_classes;
+        }
+
+        bin = std::countr_zero(larger_bins);
+        sub_bins = index.sub_bins_masks_[bin];
+    }
+
+    return bin * free_index_sub_bins + std::countr_zero(sub_bins);
+}
+
+template <allocator_with_fit_mode::fit_mode Mode>
+inline allocator_boundary_tags::block_metadata *
+allocator_boundary_tags::get_block_indexed(void *trusted,
+                                           size_t size) const noexcept {
+    const auto &index = *get_allocator_metadata(trusted).index_;
+    const size_t size_class = get_size_class(size);
+
+    free_block_metadata *hole = nullptr;
+
+    // smallest hole of the list that is at least `size`, or the largest one
+    const auto scan = [size](free_block_metadata *head, bool largest) {
+        free_block_metadata *result = nullptr;
+        for (auto current = head; current != nullptr; current = current->next_) {
+            if (current->size_ < size) {
+                continue;
+            }
+            if (result == nullptr ||
+                (largest ? current->size_ > result->size_
+                         : current->size_ < result->size_)) {
+                result = current;
+            }
+            if (!largest && result->size_ == size) {
+                break;
+            }
+        }
+        return result;
+    };
+
+    if constexpr (Mode == fit_mode::the_worst_fit) {
+        if (index.bins_mask_ != 0) {
+            const size_t bin = std::bit_width(index.bins_mask_) - 1;
+            hole = scan(index.heads_[bin * free_index_sub_bins +
+                                     std::bit_width(static_cast<size_t>(
+                                         index.sub_bins_masks_[bin])) -
+                                     1],
+                        true);
+        }
+    } else if constexpr (Mode == fit_mode::the_best_fit) {
+        // only the class of `size` mixes holes that fit with ones that don't,
+        // past it the first non-empty class holds the best hole
+        hole = scan(index.heads_[size_class], false);
+        if (hole == nullptr) {
+            const size_t larger = get_nonempty_class(index, size_class + 1);
+            if (larger != free_index_classes) {
+                hole = scan(index.heads_[larger], false);
+            }
+        }
+    } else {
+        // any hole of a class above `size` fits, so the head of one is taken
+        // as is and only the class of `size` itself is ever walked
+        const size_t larger =
+            get_nonempty_class(index, get_size_class_above(size));
+        if (larger != free_index_classes) {
+            hole = index.heads_[larger];
+        } else {
+            for (hole = index.heads_[size_class];
+                 hole != nullptr && hole->size_ < size; hole = hole->next_) {
+            }
+        }
+    }
+
+    return hole != nullptr ? static_cast<block_metadata *>(
+                                 static_cast<void *>(hole->owner_))
+                           : nullptr;
+}
+
+inline void allocator_boundary_tags::index_insert(void *trusted,
+                                                  std::byte *hole, size_t size,
+                                                  void *owner) noexcept {
+    auto &index = *get_allocator_metadata(trusted).index_;
+    const size_t size_class = get_size_class(size);
+
+    const auto node = reinterpret_cast<free_block_metadata *>(hole);
+    node->size_ = size;
+    node->owner_ = owner;
+    node->next_ = index.heads_[size_class];
+    node->prev_ = nullptr;
+
+    if (index.heads_[size_class] != nullptr) {
+        index.heads_[size_class]->prev_ = node;
+    }
+    index.heads_[size_class] = node;
+
+    index.bins_mask_ |= size_t{1} << (size_class / free_index_sub_bins);
+    index.sub_bins_masks_[size_class / free_index_sub_bins] |=
+        std::uint8_t{1} << (size_class % free_index_sub_bins);
+}
+
+inline void allocator_boundary_tags::index_erase(void *trusted,
+                                                 std::byte *hole) noexcept {
+    auto &index = *get_allocator_metadata(trusted).index_;
+    const auto node = reinterpret_cast<free_block_metadata *>(hole);
+    const size_t size_class = get_size_class(node->size_);
+
+    // compact links and the class heads have different types, so no ?: here
+    if (node->prev_ != nullptr) {
+        node->prev_->next_ = node->next_;
+    } else {
+        index.heads_[size_class] = node->next_;
+    }
+    if (node->next_ != nullptr) {
+        node->next_->prev_ = node->prev_;
+    }
+
+    if (index.heads_[size_class] == nullptr) {
+        const size_t bin = size_class / free_index_sub_bins;
+        index.sub_bins_masks_[bin] &=
+            ~(std::uint8_t{1} << (size_class % free_index_sub_bins));
+        if (index.sub_bins_masks_[bin] == 0) {
+            index.bins_mask_ &= ~(size_t{1} << bin);
+        }
+    }
+}
+
+inline void allocator_boundary_tags::stats_hole_added(size_t size) noexcept {
+    if (size == 0) {
+        return;
+    }
+
+    auto &metadata = get_allocator_metadata();
+    auto &largest = metadata.stats_.largest_free_block;
+
+    metadata.stats_.hole_added(size);
+
+    if (size > largest.load(std::memory_order_relaxed)) {
+        largest.store(size, std::memory_order_relaxed);
+        metadata.largest_free_blocks_count_ = 1;
+    } else if (size == largest.load(std::memory_order_relaxed)) {
+        ++metadata.largest_free_blocks_count_;
+    }
+}
+
+inline void allocator_boundary_tags::stats_hole_removed(size_t size) noexcept {
+    if (size == 0) {
+        return;
+    }
+
+    auto &metadata = get_allocator_metadata();
+
+    metadata.stats_.hole_removed(size);
+
+    if (size == metadata.stats_.largest_free_block.load(
+                   std::memory_order_relaxed)) {
+        --metadata.largest_free_blocks_count_;
+    }
+}
+
+void allocator_boundary_tags::stats_refresh_largest() noexcept {
+    auto &metadata = get_allocator_metadata();
+
+    if (metadata.largest_free_blocks_count_ != 0 ||
+        metadata.stats_.largest_free_block.load(std::memory_order_relaxed) ==
+            0) {
+        return;
+    }
+
+    size_t largest = 0;
+    size_t count = 0;
+
+    const auto consider = [&](size_t size) {
+        if (size > largest) {
+            largest = size;
+            count = 1;
+        } else if (size == largest) {
+            ++count;
+        }
+    };
+
+    for (void *arena = _trusted_memory; arena != nullptr;
+         arena = get_allocator_metadata(arena).next_arena_) {
+        if (metadata.index_ != nullptr) {
+            // the largest holes are all in the highest non-empty class
+            const auto &index = *get_allocator_metadata(arena).index_;
+            if (index.bins_mask_ == 0) {
+                continue;
+            }
+
+            const size_t bin = std::bit_width(index.bins_mask_) - 1;
+            for (free_block_metadata *hole =
+                     index.heads_[bin * free_index_sub_bins +
+                                  std::bit_width(static_cast<size_t>(
+                                      index.sub_bins_masks_[bin])) -
+                                  1];
+                 hole != nullptr; hole = hole->next_) {
+                consider(hole->size_);
+            }
+        } else {
+            for (boundary_iterator it(arena); it != boundary_iterator(); ++it) {
+                if (!it.occupied() && it.size() != 0) {
+                    consider(it.size());
+                }
+            }
+        }
+    }
+
+    metadata.stats_.largest_free_block.store(largest,
+                                             std::memory_order_relaxed);
+    metadata.largest_free_blocks_count_ = count;
+}
+
 size_t allocator_boundary_tags::get_available_memory() const noexcept {
     size_t available_memory = 0;
 
-    for (auto it = begin(); it != end(); ++it) {
-        if (!it.occupied()) {
-            available_memory += it.size();
+    for (void *arena = _trusted_memory; arena != nullptr;
+         arena = get_allocator_metadata(arena).next_arena_) {
+        for (boundary_iterator it(arena); it != boundary_iterator(); ++it) {
+            if (!it.occupied()) {
+                available_memory += it.size();
+            }
         }
     }
 
@@ -305,8 +1126,12 @@ std::vector<allocator_test_utils::block_info>
 allocator_boundary_tags::get_blocks_info_inner() const {
     std::vector<allocator_test_utils::block_info> blocks;
 
-    for (auto it = begin(); it != end(); ++it) {
-        blocks.push_back({it.size(), it.occupied()});
+    // arenas are listed one after another in chain order
+    for (void *arena = _trusted_memory; arena != nullptr;
+         arena = get_allocator_metadata(arena).next_arena_) {
+        for (boundary_iterator it(arena); it != boundary_iterator(); ++it) {
+            blocks.push_back({it.size(), it.occupied()});
+        }
     }
 
     return blocks;
@@ -334,7 +1159,8 @@ allocator_boundary_tags::boundary_iterator::operator++() & noexcept {
 
     if (_occupied) {
         const bool next_block_right_after =
-            block->block_end() == reinterpret_cast<std::byte *>(block->next_);
+            block->block_end() == reinterpret_cast<std::byte *>(
+                                     static_cast<block_metadata *>(block->next_));
         const bool last_block = block->block_end() == metadata->allocator_end();
 
         _occupied = next_block_right_after || (!block->next_ && last_block);
@@ -367,14 +1193,14 @@ allocator_boundary_tags::boundary_iterator::operator--() & noexcept {
 }
 
 allocator_boundary_tags::boundary_iterator
-allocator_boundary_tags::boundary_iterator::operator++(int n) {
+allocator_boundary_tags::boundary_iterator::operator++(int) {
     const boundary_iterator tmp = *this;
     ++(*this);
     return tmp;
 }
 
 allocator_boundary_tags::boundary_iterator
-allocator_boundary_tags::boundary_iterator::operator--(int n) {
+allocator_boundary_tags::boundary_iterator::operator--(int) {
     const boundary_iterator tmp = *this;
     --(*this);
     return tmp;
@@ -408,8 +1234,7 @@ allocator_boundary_tags::boundary_iterator::boundary_iterator()
 
 allocator_boundary_tags::boundary_iterator::boundary_iterator(void *trusted)
     : _trusted_memory(trusted) {
-    const auto maybe_first_block =
-        static_cast<std::byte *>(trusted) + sizeof(allocator_metadata);
+    const auto maybe_first_block = get_allocator_metadata(trusted).pool_start();
     const auto first_allocator_block = reinterpret_cast<std::byte *>(
         get_allocator_metadata(trusted).first_block_);
 
@@ -425,3 +1250,15 @@ allocator_boundary_tags::boundary_iterator::boundary_iterator(void *trusted)
 void *allocator_boundary_tags::boundary_iterator::get_ptr() const noexcept {
     return _occupied_ptr;
 }
+
+// allocator_boundary_tags_t is header-only and links against these
+template void *
+allocator_boundary_tags::allocate_sm<allocator_with_fit_mode::fit_mode::first_fit>(
+    size_t, size_t);
+template void *allocator_boundary_tags::allocate_sm<
+    allocator_with_fit_mode::fit_mode::the_best_fit>(size_t, size_t);
+template void *allocator_boundary_tags::allocate_sm<
+    allocator_with_fit_mode::fit_mode::the_worst_fit>(size_t, size_t);
+template void *
+allocator_boundary_tags::allocate_sm<allocator_with_fit_mode::fit_mode::next_fit>(
+    size_t, size_t);
@@ -4,6 +4,11 @@
 #include <client_logger_builder.h>
 #include <memory>
 #include <list>
+#include <cstring>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <pp_vector.h>
 
 logger *create_logger(
     std::vector<std::pair<std::string, logger::severity>> const &output_file_streams_setup,
@@ -27,6 +32,23 @@ logger *create_logger(
     return logger_instance;
 }
 
+#ifdef BOUNDARY_TAGS_COMPACT_HEADERS
+// 32-bit size and links padded to max_align_t, the size of an index node too
+constexpr size_t header_size = alignof(std::max_align_t);
+constexpr size_t min_block_size = header_size;
+#else
+constexpr size_t header_size = sizeof(allocator_dbg_helper::block_size_t) + sizeof(allocator_dbg_helper::block_pointer_t) * 3;
+constexpr size_t min_block_size = header_size;
+#endif
+
+// blocks are rounded up so that every payload stays aligned to max_align_t
+constexpr size_t aligned_block_size(size_t size)
+{
+    constexpr size_t granularity = alignof(std::max_align_t);
+    
+    return (std::max(size + header_size, min_block_size) + granularity - 1) / granularity * granularity;
+}
+
 //TODO: recalculate size
 
 TEST(positiveTests, test1)
@@ -38,14 +60,16 @@ TEST(positiveTests, test1)
                 logger::severity::information
             }
         }));
-    std::unique_ptr<smart_mem_resource> subject(new allocator_boundary_tags(sizeof(int) * 70, nullptr, logger.get(), allocator_with_fit_mode::fit_mode::first_fit));
+    // the freed middle block has to fit two rounded up single int blocks
+    constexpr size_t block_size = aligned_block_size(sizeof(int) * 16);
+    std::unique_ptr<smart_mem_resource> subject(new allocator_boundary_tags(3 * block_size + sizeof(int) * 16, nullptr, logger.get(), allocator_with_fit_mode::fit_mode::first_fit));
     
-    auto *first_block = reinterpret_cast<int *>(subject->allocate(sizeof(int) * 10));
-    auto *second_block = reinterpret_cast<int *>(subject->allocate(sizeof(int) * 10));
-    auto *third_block = reinterpret_cast<int *>(subject->allocate(sizeof(int) * 10));
+    auto *first_block = reinterpret_cast<int *>(subject->allocate(sizeof(int) * 16));
+    auto *second_block = reinterpret_cast<int *>(subject->allocate(sizeof(int) * 16));
+    auto *third_block = reinterpret_cast<int *>(subject->allocate(sizeof(int) * 16));
     
-    ASSERT_EQ(reinterpret_cast<int*>(reinterpret_cast<char*>(first_block + 10) + sizeof(size_t) + sizeof(void*) * 3), second_block);
-    ASSERT_EQ(reinterpret_cast<int*>(reinterpret_cast<char*>(second_block + 10) + sizeof(size_t) + sizeof(void*) * 3), third_block);
+    ASSERT_EQ(reinterpret_cast<int*>(reinterpret_cast<char*>(first_block) + block_size), second_block);
+    ASSERT_EQ(reinterpret_cast<int*>(reinterpret_cast<char*>(second_block) + block_size), third_block);
     
     subject->deallocate(const_cast<void *>(reinterpret_cast<void const *>(second_block)), 1);
     
@@ -55,8 +79,8 @@ TEST(positiveTests, test1)
     the_same_subject->set_fit_mode(allocator_with_fit_mode::fit_mode::the_best_fit);
     auto *fifth_block = reinterpret_cast<int *>(subject->allocate(sizeof(int) * 1));
     
-    ASSERT_EQ(reinterpret_cast<int*>(reinterpret_cast<char*>(first_block + 10) + sizeof(size_t) + sizeof(void*) * 3), fourth_block);
-    ASSERT_EQ(reinterpret_cast<int*>(reinterpret_cast<char*>(fourth_block + 1) + sizeof(size_t) + sizeof(void*) * 3), fifth_block);
+    ASSERT_EQ(reinterpret_cast<int*>(reinterpret_cast<char*>(first_block) + block_size), fourth_block);
+    ASSERT_EQ(reinterpret_cast<int*>(reinterpret_cast<char*>(fourth_block) + aligned_block_size(sizeof(int))), fifth_block);
     
     subject->deallocate(const_cast<void *>(reinterpret_cast<void const *>(first_block)), 1);
     subject->deallocate(const_cast<void *>(reinterpret_cast<void const *>(third_block)), 1);
@@ -83,13 +107,13 @@ TEST(positiveTests, test2)
     auto actual_blocks_state = dynamic_cast<allocator_test_utils *>(allocator_instance.get())->get_blocks_info();
     std::vector<allocator_test_utils::block_info> expected_blocks_state
         {
-            { .block_size = 1000 + sizeof(allocator_dbg_helper::block_size_t) + sizeof(allocator_dbg_helper::block_pointer_t) * 3, .is_block_occupied = true },
-            { .block_size = sizeof(allocator_dbg_helper::block_size_t) + sizeof(allocator_dbg_helper::block_pointer_t) * 3, .is_block_occupied = true },
-            { .block_size = 3000 - (1000 + (sizeof(allocator_dbg_helper::block_size_t) + sizeof(allocator_dbg_helper::block_pointer_t) * 3) * 2), .is_block_occupied = false }
+            { .block_size = aligned_block_size(1000), .is_block_occupied = true },
+            { .block_size = min_block_size, .is_block_occupied = true },
+            { .block_size = 3000 - aligned_block_size(1000) - min_block_size, .is_block_occupied = false }
         };
     
     ASSERT_EQ(actual_blocks_state.size(), expected_blocks_state.size());
-    for (int i = 0; i < actual_blocks_state.size(); i++)
+    for (size_t i = 0; i < actual_blocks_state.size(); i++)
     {
         ASSERT_EQ(actual_blocks_state[i], expected_blocks_state[i]);
     }
@@ -146,8 +170,8 @@ TEST(own, test1)
     std::unique_ptr<smart_mem_resource> alloc(new allocator_boundary_tags(4000, nullptr, logger_instance.get(), allocator_with_fit_mode::fit_mode::first_fit));
 
     auto first_block = reinterpret_cast<int *>(alloc->allocate(sizeof(int)*  250));
-    auto second_block = reinterpret_cast<char *>(alloc->allocate(sizeof(char) * 500));
-    auto third_block = reinterpret_cast<double *>(alloc->allocate(sizeof(double *) * 250));
+    [[maybe_unused]] auto second_block = reinterpret_cast<char *>(alloc->allocate(sizeof(char) * 500));
+    [[maybe_unused]] auto third_block = reinterpret_cast<double *>(alloc->allocate(sizeof(double *) * 250));
     alloc->deallocate(first_block, 1);
     first_block = reinterpret_cast<int *>(alloc->allocate(sizeof(int) * 245));
 
@@ -169,10 +193,13 @@ TEST(own, test1)
                     {
                         case 0:
                             the_same_subject->set_fit_mode(allocator_with_fit_mode::fit_mode::first_fit);
+                            break;
                         case 1:
                             the_same_subject->set_fit_mode(allocator_with_fit_mode::fit_mode::the_best_fit);
+                            break;
                         case 2:
                             the_same_subject->set_fit_mode(allocator_with_fit_mode::fit_mode::the_worst_fit);
+                            break;
                     }
 
                     allocated_blocks.push_front(allocator->allocate(sizeof(void *) * (rand() % 251 + 50)));
@@ -210,6 +237,674 @@ TEST(own, test1)
     }
 }
 
+TEST(freeIndexTests, test1)
+{
+    std::unique_ptr<smart_mem_resource> allocator_instance(new allocator_boundary_tags(3000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, true));
+    
+    char *first_block = reinterpret_cast<char *>(allocator_instance->allocate(sizeof(char) * 1600));
+    char *second_block = reinterpret_cast<char *>(allocator_instance->allocate(sizeof(char) * 0));
+    allocator_instance->deallocate(first_block, 1);
+    first_block = reinterpret_cast<char *>(allocator_instance->allocate(sizeof(char) * 1599));
+    auto actual_blocks_state = dynamic_cast<allocator_test_utils *>(allocator_instance.get())->get_blocks_info();
+    std::vector<allocator_test_utils::block_info> expected_blocks_state
+        {
+            { .block_size = aligned_block_size(1600), .is_block_occupied = true },
+            { .block_size = min_block_size, .is_block_occupied = true },
+            { .block_size = 3000 - aligned_block_size(1600) - min_block_size, .is_block_occupied = false }
+        };
+    
+    ASSERT_EQ(actual_blocks_state.size(), expected_blocks_state.size());
+    for (size_t i = 0; i < actual_blocks_state.size(); i++)
+    {
+        ASSERT_EQ(actual_blocks_state[i], expected_blocks_state[i]);
+    }
+    
+    allocator_instance->deallocate(first_block, 1);
+    allocator_instance->deallocate(second_block, 1);
+}
+
+TEST(freeIndexTests, test2)
+{
+    std::unique_ptr<smart_mem_resource> allocator(new allocator_boundary_tags(20'000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, true));
+    auto *the_same_subject = dynamic_cast<allocator_with_fit_mode *>(allocator.get());
+    auto *test_utils = dynamic_cast<allocator_test_utils *>(allocator.get());
+    
+    std::list<void *> allocated_blocks;
+    srand(42);
+    
+    for (auto i = 0; i < 10000; i++)
+    {
+        if (rand() % 3 != 0)
+        {
+            the_same_subject->set_fit_mode(static_cast<allocator_with_fit_mode::fit_mode>(rand() % 3));
+            try
+            {
+                allocated_blocks.push_back(allocator->allocate(rand() % 300 + 1));
+            }
+            catch (std::bad_alloc const &)
+            {
+            }
+        }
+        else if (!allocated_blocks.empty())
+        {
+            auto it = allocated_blocks.begin();
+            std::advance(it, rand() % allocated_blocks.size());
+            allocator->deallocate(*it, 1);
+            allocated_blocks.erase(it);
+        }
+        
+        size_t total_size = 0;
+        bool previous_free = false;
+        for (auto const &block: test_utils->get_blocks_info())
+        {
+            ASSERT_FALSE(previous_free && !block.is_block_occupied);
+            previous_free = !block.is_block_occupied;
+            total_size += block.block_size;
+        }
+        ASSERT_EQ(total_size, 20'000);
+    }
+    
+    while (!allocated_blocks.empty())
+    {
+        allocator->deallocate(allocated_blocks.front(), 1);
+        allocated_blocks.pop_front();
+    }
+    
+    auto actual_blocks_state = test_utils->get_blocks_info();
+    ASSERT_EQ(actual_blocks_state.size(), 1);
+    ASSERT_EQ(actual_blocks_state[0], (allocator_test_utils::block_info{ .block_size = 20'000, .is_block_occupied = false }));
+    ASSERT_NO_THROW(allocator->deallocate(allocator->allocate(20'000 - header_size), 1));
+}
+
+TEST(alignmentTests, test1)
+{
+    for (bool use_free_index : { false, true })
+    {
+        std::unique_ptr<smart_mem_resource> allocator_instance(new allocator_boundary_tags(10'000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, use_free_index));
+        std::vector<void *> allocated_blocks;
+        
+        for (size_t alignment : { 32, 64, 256, 128 })
+        {
+            auto block = allocator_instance->allocate(sizeof(char) * 13, alignment);
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % alignment, 0);
+            allocated_blocks.push_back(block);
+        }
+        
+        for (auto block: allocated_blocks)
+        {
+            allocator_instance->deallocate(block, 1);
+        }
+        
+        auto actual_blocks_state = dynamic_cast<allocator_test_utils *>(allocator_instance.get())->get_blocks_info();
+        ASSERT_EQ(actual_blocks_state.size(), 1);
+        ASSERT_FALSE(actual_blocks_state[0].is_block_occupied);
+    }
+}
+
+TEST(alignmentTests, test2)
+{
+    for (bool use_free_index : { false, true })
+    {
+        allocator_boundary_tags allocator(10'000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, use_free_index);
+        std::vector<void *> allocated_blocks;
+        
+        // odd sizes in between must not leave the blocks after them misaligned
+        for (size_t size : { 1, 13, 7, 29, 3 })
+        {
+            allocated_blocks.push_back(allocator.allocate(size, 1));
+            
+            auto block = allocator.allocate(16, 8);
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % 8, 0);
+            allocated_blocks.push_back(block);
+            
+            block = allocator.allocate(32, 16);
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % 16, 0);
+            allocated_blocks.push_back(block);
+        }
+        
+        ASSERT_TRUE(allocator.try_resize(allocated_blocks[0], 5));
+        auto block = allocator.allocate(32, 16);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % 16, 0);
+        allocated_blocks.push_back(block);
+        
+        auto handle = allocator.allocate_handle(13);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(allocator.resolve(handle)) % alignof(std::max_align_t), 0);
+        allocator.deallocate_handle(handle);
+        
+        for (auto allocated_block: allocated_blocks)
+        {
+            allocator.deallocate(allocated_block, 1);
+        }
+        
+        ASSERT_EQ(allocator.get_blocks_info().size(), 1);
+    }
+}
+
+TEST(growthTests, test1)
+{
+    for (bool use_free_index : { false, true })
+    {
+        std::unique_ptr<smart_mem_resource> allocator_instance(new allocator_boundary_tags(1000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, use_free_index, 8000));
+        auto *test_utils = dynamic_cast<allocator_test_utils *>(allocator_instance.get());
+        
+        auto first_block = allocator_instance->allocate(400);
+        auto second_block = allocator_instance->allocate(400);
+        auto third_block = allocator_instance->allocate(400);
+        
+        std::vector<allocator_test_utils::block_info> expected_blocks_state
+            {
+                { .block_size = aligned_block_size(400), .is_block_occupied = true },
+                { .block_size = aligned_block_size(400), .is_block_occupied = true },
+                { .block_size = 1000 - aligned_block_size(400) * 2, .is_block_occupied = false },
+                { .block_size = aligned_block_size(400), .is_block_occupied = true },
+                { .block_size = 1000 - aligned_block_size(400), .is_block_occupied = false }
+            };
+        ASSERT_EQ(test_utils->get_blocks_info(), expected_blocks_state);
+        
+        allocator_instance->deallocate(third_block, 1);
+        expected_blocks_state.resize(3);
+        ASSERT_EQ(test_utils->get_blocks_info(), expected_blocks_state);
+        
+        third_block = allocator_instance->allocate(5000);
+        ASSERT_EQ(test_utils->get_blocks_info().size(), 4);
+        ASSERT_THROW(static_cast<void>(allocator_instance->allocate(3000)), std::bad_alloc);
+        
+        std::unique_ptr<smart_mem_resource> other_instance(new allocator_boundary_tags(1000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, use_free_index, 8000));
+        auto foreign_block = other_instance->allocate(2000);
+        ASSERT_THROW(allocator_instance->deallocate(foreign_block, 1), std::logic_error);
+        other_instance->deallocate(foreign_block, 1);
+        
+        allocator_instance->deallocate(first_block, 1);
+        allocator_instance->deallocate(second_block, 1);
+        allocator_instance->deallocate(third_block, 1);
+        
+        ASSERT_EQ(test_utils->get_blocks_info(), (std::vector<allocator_test_utils::block_info>{ { .block_size = 1000, .is_block_occupied = false } }));
+    }
+}
+
+TEST(growthTests, test2)
+{
+    for (bool use_free_index : { false, true })
+    {
+        std::unique_ptr<smart_mem_resource> allocator(new allocator_boundary_tags(2000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, use_free_index, 100'000));
+        auto *the_same_subject = dynamic_cast<allocator_with_fit_mode *>(allocator.get());
+        auto *test_utils = dynamic_cast<allocator_test_utils *>(allocator.get());
+        
+        std::list<std::pair<unsigned char *, size_t>> allocated_blocks;
+        srand(7);
+        
+        for (auto i = 0; i < 10000; i++)
+        {
+            if (rand() % 3 != 0 || allocated_blocks.empty())
+            {
+                the_same_subject->set_fit_mode(static_cast<allocator_with_fit_mode::fit_mode>(rand() % 4));
+                size_t size = rand() % 300 + 1;
+                
+                try
+                {
+                    auto block = reinterpret_cast<unsigned char *>(allocator->allocate(size));
+                    memset(block, static_cast<unsigned char>(size), size);
+                    allocated_blocks.emplace_back(block, size);
+                }
+                catch (std::bad_alloc const &)
+                {
+                }
+            }
+            else
+            {
+                auto it = allocated_blocks.begin();
+                std::advance(it, rand() % allocated_blocks.size());
+                for (size_t j = 0; j < it->second; j++)
+                {
+                    ASSERT_EQ(it->first[j], static_cast<unsigned char>(it->second));
+                }
+                allocator->deallocate(it->first, 1);
+                allocated_blocks.erase(it);
+            }
+        }
+        
+        while (!allocated_blocks.empty())
+        {
+            allocator->deallocate(allocated_blocks.front().first, 1);
+            allocated_blocks.pop_front();
+        }
+        
+        ASSERT_EQ(test_utils->get_blocks_info(), (std::vector<allocator_test_utils::block_info>{ { .block_size = 2000, .is_block_occupied = false } }));
+    }
+}
+
+TEST(statsTests, test1)
+{
+    allocator_boundary_tags allocator(1000);
+    
+    auto stats = allocator.get_stats();
+    ASSERT_EQ(stats.free_bytes, 1000);
+    ASSERT_EQ(stats.largest_free_block, 1000);
+    ASSERT_EQ(stats.free_blocks_count, 1);
+    ASSERT_EQ(stats.fragmentation, 0);
+    
+    auto first_block = allocator.allocate(100);
+    const size_t block_size = 1000 - allocator.get_stats().free_bytes;
+    auto second_block = allocator.allocate(100);
+    auto third_block = allocator.allocate(100);
+    allocator.deallocate(second_block, 1);
+    
+    stats = allocator.get_stats();
+    ASSERT_EQ(stats.free_blocks_count, 2);
+    ASSERT_EQ(stats.largest_free_block, 1000 - 3 * block_size);
+    ASSERT_EQ(stats.free_bytes, 1000 - 2 * block_size);
+    ASSERT_DOUBLE_EQ(stats.fragmentation, static_cast<double>(block_size) / stats.free_bytes);
+    ASSERT_EQ(stats.allocations_count, 3);
+    ASSERT_EQ(stats.deallocations_count, 1);
+    ASSERT_EQ(stats.occupied_bytes, 2 * block_size);
+    ASSERT_EQ(stats.high_water_mark, 3 * block_size);
+    
+    allocator.deallocate(first_block, 1);
+    allocator.deallocate(third_block, 1);
+    
+    stats = allocator.get_stats();
+    ASSERT_EQ(stats.free_blocks_count, 1);
+    ASSERT_EQ(stats.largest_free_block, 1000);
+    ASSERT_EQ(stats.occupied_bytes, 0);
+    ASSERT_EQ(stats.high_water_mark, 3 * block_size);
+}
+
+TEST(statsTests, test2)
+{
+    for (bool use_free_index : { false, true })
+    {
+        allocator_boundary_tags allocator(3000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, use_free_index, 50'000);
+        
+        std::list<void *> allocated_blocks;
+        size_t allocations_count = 0;
+        srand(11);
+        
+        for (auto i = 0; i < 5000; i++)
+        {
+            if (rand() % 3 != 0 || allocated_blocks.empty())
+            {
+                allocator.set_fit_mode(static_cast<allocator_with_fit_mode::fit_mode>(rand() % 4));
+                
+                try
+                {
+                    allocated_blocks.push_back(rand() % 8 == 0
+                        ? allocator.allocate(rand() % 200 + 1, 64)
+                        : allocator.allocate(rand() % 400 + 1));
+                    ++allocations_count;
+                }
+                catch (std::bad_alloc const &)
+                {
+                }
+            }
+            else
+            {
+                auto it = allocated_blocks.begin();
+                std::advance(it, rand() % allocated_blocks.size());
+                allocator.deallocate(*it, 1);
+                allocated_blocks.erase(it);
+            }
+            
+            size_t free_bytes = 0, occupied_bytes = 0, largest_free_block = 0, free_blocks_count = 0;
+            for (auto const &block : allocator.get_blocks_info())
+            {
+                if (block.is_block_occupied)
+                {
+                    occupied_bytes += block.block_size;
+                }
+                else
+                {
+                    free_bytes += block.block_size;
+                    largest_free_block = std::max(largest_free_block, block.block_size);
+                    ++free_blocks_count;
+                }
+            }
+            
+            auto stats = allocator.get_stats();
+            ASSERT_EQ(stats.free_bytes, free_bytes);
+            ASSERT_EQ(stats.occupied_bytes, occupied_bytes);
+            ASSERT_EQ(stats.largest_free_block, largest_free_block);
+            ASSERT_EQ(stats.free_blocks_count, free_blocks_count);
+            ASSERT_EQ(stats.allocations_count, allocations_count);
+            ASSERT_EQ(stats.deallocations_count, allocations_count - allocated_blocks.size());
+            ASSERT_GE(stats.high_water_mark, occupied_bytes);
+        }
+        
+        for (auto block : allocated_blocks)
+        {
+            allocator.deallocate(block, 1);
+        }
+    }
+}
+
+TEST(resizeTests, test1)
+{
+    for (bool use_free_index : { false, true })
+    {
+        allocator_boundary_tags allocator(1000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, use_free_index);
+        
+        auto first_block = allocator.allocate(100);
+        auto second_block = allocator.allocate(100);
+        const size_t block_size = (1000 - allocator.get_stats().free_bytes) / 2;
+        
+        // boxed in by the second block
+        ASSERT_FALSE(allocator.try_resize(first_block, block_size - header_size + 1));
+        ASSERT_TRUE(allocator.try_resize(first_block, 100));
+        
+        ASSERT_TRUE(allocator.try_resize(second_block, 300));
+        ASSERT_EQ(allocator.get_blocks_info(), (std::vector<allocator_test_utils::block_info>
+            {
+                { .block_size = block_size, .is_block_occupied = true },
+                { .block_size = aligned_block_size(300), .is_block_occupied = true },
+                { .block_size = 1000 - block_size - aligned_block_size(300), .is_block_occupied = false }
+            }));
+        
+        ASSERT_FALSE(allocator.try_resize(second_block, 1000));
+        
+        ASSERT_TRUE(allocator.try_resize(second_block, 50));
+        ASSERT_EQ(allocator.get_blocks_info(), (std::vector<allocator_test_utils::block_info>
+            {
+                { .block_size = block_size, .is_block_occupied = true },
+                { .block_size = aligned_block_size(50), .is_block_occupied = true },
+                { .block_size = 1000 - block_size - aligned_block_size(50), .is_block_occupied = false }
+            }));
+        
+        allocator.deallocate(second_block, 1);
+        
+        // the freed neighbour is taken whole, a tail too small for a header included
+        ASSERT_TRUE(allocator.try_resize(first_block, 1000 - block_size + 100 - 1));
+        ASSERT_EQ(allocator.get_blocks_info(), (std::vector<allocator_test_utils::block_info>
+            {
+                { .block_size = 1000, .is_block_occupied = true }
+            }));
+        
+        auto stats = allocator.get_stats();
+        ASSERT_EQ(stats.free_bytes, 0);
+        ASSERT_EQ(stats.free_blocks_count, 0);
+        ASSERT_EQ(stats.occupied_bytes, 1000);
+        
+        allocator.deallocate(first_block, 1);
+        ASSERT_EQ(allocator.get_stats().largest_free_block, 1000);
+    }
+}
+
+TEST(resizeTests, test2)
+{
+    allocator_boundary_tags allocator(300'000);
+    
+    {
+        pp_vector<unsigned int> digits{ pp_allocator<unsigned int>(&allocator) };
+        digits.push_back(0);
+        auto *data = digits.data();
+        
+        for (unsigned int i = 1; i < 10'000; ++i)
+        {
+            digits.push_back(i);
+        }
+        
+        // the only block grows into the hole after it and never moves
+        ASSERT_EQ(digits.data(), data);
+        ASSERT_EQ(allocator.get_stats().allocations_count, 1);
+        
+        for (unsigned int i = 0; i < 10'000; ++i)
+        {
+            ASSERT_EQ(digits[i], i);
+        }
+        
+        pp_vector<unsigned int> blocker{ pp_allocator<unsigned int>(&allocator) };
+        blocker.push_back(1);
+        
+        digits.resize(digits.capacity() + 1, 7);
+        ASSERT_NE(digits.data(), data);
+        ASSERT_EQ(digits[9'999], 9'999);
+        ASSERT_EQ(digits.back(), 7);
+        
+        digits.resize(10);
+        digits.shrink_to_fit();
+        ASSERT_EQ(digits.capacity(), 10);
+    }
+    
+    ASSERT_EQ(allocator.get_stats().occupied_bytes, 0);
+}
+
+TEST(headerTests, test1)
+{
+    allocator_boundary_tags allocator(1 << 16, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, true);
+    std::vector<void *> blocks;
+    size_t occupied = 0;
+    
+    // small objects until the pool runs out, every one of them pays one
+    // rounded up header and only the last one may take a leftover too small
+    // to be a hole
+    try
+    {
+        for (size_t size = 16;; size = size == 32 ? 16 : size + 4)
+        {
+            blocks.push_back(allocator.allocate(size));
+            occupied += aligned_block_size(size);
+        }
+    }
+    catch (std::bad_alloc const &)
+    {
+    }
+    
+    const auto stats = allocator.get_stats();
+    ASSERT_GE(stats.occupied_bytes, occupied);
+    ASSERT_LT(stats.occupied_bytes, occupied + min_block_size);
+    ASSERT_LT(stats.free_bytes, 32 + header_size);
+    
+    for (auto block: blocks)
+    {
+        allocator.deallocate(block, 1);
+    }
+    
+    ASSERT_EQ(allocator.get_blocks_info().size(), 1);
+}
+
+namespace
+{
+    template<allocator_with_fit_mode::fit_mode Mode>
+    void compare_with_runtime_fit_mode(
+        bool use_free_index)
+    {
+        allocator_boundary_tags runtime(20'000, nullptr, nullptr, Mode, use_free_index);
+        allocator_boundary_tags_t<Mode> compiled(20'000, nullptr, nullptr, use_free_index);
+        
+        std::vector<std::pair<void *, void *>> blocks;
+        srand(static_cast<unsigned>(Mode));
+        
+        for (int i = 0; i < 2'000; ++i)
+        {
+            if (blocks.empty() || rand() % 3 != 0)
+            {
+                const size_t size = 1 + rand() % 300;
+                void *runtime_block = nullptr;
+                void *compiled_block = nullptr;
+                
+                try
+                {
+                    runtime_block = runtime.allocate(size);
+                }
+                catch (std::bad_alloc const &)
+                {
+                }
+                
+                try
+                {
+                    compiled_block = compiled.allocate(size);
+                }
+                catch (std::bad_alloc const &)
+                {
+                }
+                
+                ASSERT_EQ(runtime_block == nullptr, compiled_block == nullptr);
+                if (runtime_block != nullptr)
+                {
+                    blocks.emplace_back(runtime_block, compiled_block);
+                }
+            }
+            else
+            {
+                auto it = blocks.begin() + rand() % blocks.size();
+                runtime.deallocate(it->first, 1);
+                compiled.deallocate(it->second, 1);
+                blocks.erase(it);
+            }
+            
+            ASSERT_EQ(runtime.get_blocks_info(), compiled.get_blocks_info());
+        }
+        
+        for (auto [runtime_block, compiled_block]: blocks)
+        {
+            runtime.deallocate(runtime_block, 1);
+            compiled.deallocate(compiled_block, 1);
+        }
+        
+        ASSERT_EQ(compiled.get_stats().occupied_bytes, 0);
+    }
+}
+
+TEST(compileTimeFitModeTests, test1)
+{
+    for (bool use_free_index: { false, true })
+    {
+        compare_with_runtime_fit_mode<allocator_with_fit_mode::fit_mode::first_fit>(use_free_index);
+        compare_with_runtime_fit_mode<allocator_with_fit_mode::fit_mode::the_best_fit>(use_free_index);
+        compare_with_runtime_fit_mode<allocator_with_fit_mode::fit_mode::the_worst_fit>(use_free_index);
+        compare_with_runtime_fit_mode<allocator_with_fit_mode::fit_mode::next_fit>(use_free_index);
+    }
+}
+
+TEST(handleTests, test1)
+{
+    constexpr size_t handle_prefix_size = alignof(std::max_align_t);
+    constexpr size_t handle_block_size = aligned_block_size(100 + handle_prefix_size);
+    
+    for (bool use_free_index: { false, true })
+    {
+        allocator_boundary_tags allocator(20 * handle_block_size + aligned_block_size(50) + 200, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, use_free_index);
+        
+        std::vector<allocator_boundary_tags::handle> handles;
+        for (int i = 0; i < 20; ++i)
+        {
+            handles.push_back(allocator.allocate_handle(100));
+            std::memset(allocator.resolve(handles.back()), i, 100);
+        }
+        void *pinned = allocator.allocate(50);
+        
+        for (int i = 1; i < 20; i += 2)
+        {
+            allocator.deallocate_handle(handles[i]);
+        }
+        ASSERT_THROW(static_cast<void>(allocator.allocate(5 * handle_block_size - header_size)), std::bad_alloc);
+        
+        // small slices, so that it takes several of them
+        size_t slices = 0;
+        while (allocator.compact(handle_block_size) != 0)
+        {
+            ++slices;
+        }
+        ASSERT_EQ(slices, 9);
+        
+        for (int i = 0; i < 20; i += 2)
+        {
+            auto *data = static_cast<unsigned char *>(allocator.resolve(handles[i]));
+            ASSERT_TRUE(std::all_of(data, data + 100, [i](unsigned char byte) { return byte == i; }));
+        }
+        
+        // the freed space piles up in front of the pinned block, which stays put
+        auto stats = allocator.get_stats();
+        ASSERT_EQ(stats.free_blocks_count, 2);
+        ASSERT_EQ(stats.largest_free_block, 10 * handle_block_size);
+        ASSERT_EQ(static_cast<std::byte *>(allocator.resolve(handles[18])) - handle_prefix_size + 11 * handle_block_size, pinned);
+        
+        void *large = allocator.allocate(5 * handle_block_size - header_size);
+        
+        allocator.deallocate(large, 1);
+        allocator.deallocate(pinned, 1);
+        for (int i = 0; i < 20; i += 2)
+        {
+            allocator.deallocate_handle(handles[i]);
+        }
+        ASSERT_EQ(allocator.get_blocks_info().size(), 1);
+    }
+}
+
+TEST(handleTests, test2)
+{
+    allocator_boundary_tags allocator(1000);
+    
+    auto first = allocator.allocate_handle(10);
+    auto second = allocator.allocate_handle(10);
+    ASSERT_NE(first, second);
+    
+    allocator.deallocate_handle(first);
+    ASSERT_THROW(static_cast<void>(allocator.resolve(first)), std::logic_error);
+    ASSERT_THROW(static_cast<void>(allocator.resolve(0)), std::logic_error);
+    
+    // slots are reused, and a compaction with nothing to slide moves nothing
+    ASSERT_EQ(allocator.allocate_handle(10), first);
+    ASSERT_EQ(allocator.compact(1000), 0);
+    
+    allocator.deallocate_handle(first);
+    allocator.deallocate_handle(second);
+}
+
+TEST(handleTests, test3)
+{
+    for (bool use_free_index: { false, true })
+    {
+        allocator_boundary_tags allocator(1 << 16, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit, use_free_index);
+        std::atomic<bool> done = false;
+        
+        // handle blocks are freed while another thread keeps sliding them
+        std::thread compactor([&allocator, &done]
+        {
+            while (!done)
+            {
+                allocator.compact(1 << 16);
+            }
+        });
+        
+        std::mt19937 generator(42);
+        std::vector<allocator_boundary_tags::handle> handles;
+        std::vector<void *> pinned;
+        
+        for (int i = 0; i < 20'000; ++i)
+        {
+            if (handles.size() < 100 && generator() % 2 == 0)
+            {
+                handles.push_back(allocator.allocate_handle(1 + generator() % 200));
+            }
+            else if (!handles.empty())
+            {
+                const size_t k = generator() % handles.size();
+                allocator.deallocate_handle(handles[k]);
+                handles[k] = handles.back();
+                handles.pop_back();
+            }
+            
+            // blocks that stay put keep holes around for the compactor
+            if (i % 1000 == 0)
+            {
+                pinned.push_back(allocator.allocate(1 + generator() % 200));
+            }
+        }
+        
+        done = true;
+        compactor.join();
+        
+        for (auto block: handles)
+        {
+            allocator.deallocate_handle(block);
+        }
+        for (auto block: pinned)
+        {
+            allocator.deallocate(block, 1);
+        }
+        
+        ASSERT_EQ(allocator.get_blocks_info(), (std::vector<allocator_test_utils::block_info>{ { .block_size = 1 << 16, .is_block_occupied = false } }));
+    }
+}
 
 int main(
     int argc,
@@ -0,0 +1,82 @@
+#include <allocator_buddies_system.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // a window of live blocks where a random one is replaced per step, so the pool
+    // stays fragmented into many blocks of every order
+    double measure(
+        allocator_with_fit_mode::fit_mode mode,
+        size_t operations_count,
+        size_t live_blocks_count)
+    {
+        allocator_buddies_system allocator(1 << 24, nullptr, nullptr, mode);
+
+        std::mt19937 gen(0);
+        std::uniform_int_distribution<size_t> size_distribution(8, 1024);
+        std::uniform_int_distribution<size_t> slot_distribution(0, live_blocks_count - 1);
+
+        std::vector<void *> blocks(live_blocks_count, nullptr);
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < operations_count; ++i)
+        {
+            auto &slot = blocks[slot_distribution(gen)];
+
+            if (slot != nullptr)
+            {
+                allocator.deallocate(slot, 1);
+            }
+            slot = allocator.allocate(size_distribution(gen));
+        }
+
+        for (auto block: blocks)
+        {
+            if (block != nullptr)
+            {
+                allocator.deallocate(block, 1);
+            }
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        return operations_count / elapsed.count();
+    }
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    size_t operations_count = argc > 1
+        ? std::stoul(argv[1])
+        : 1'000'000;
+
+    std::cout << std::setw(12) << "live blocks"
+              << std::setw(16) << "first_fit"
+              << std::setw(16) << "the_best_fit"
+              << std::setw(16) << "the_worst_fit"
+              << "    allocations/s" << std::endl;
+
+    for (size_t live_blocks_count: { 16, 256, 4096 })
+    {
+        std::cout << std::setw(12) << live_blocks_count << std::fixed << std::setprecision(0);
+
+        for (auto mode: { allocator_with_fit_mode::fit_mode::first_fit,
+                          allocator_with_fit_mode::fit_mode::the_best_fit,
+                          allocator_with_fit_mode::fit_mode::the_worst_fit })
+        {
+            std::cout << std::setw(16) << measure(mode, operations_count, live_blocks_count);
+        }
+
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
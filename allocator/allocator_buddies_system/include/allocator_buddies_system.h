@@ -4,10 +4,12 @@
 #include <pp_allocator.h>
 #include <allocator_test_utils.h>
 #include <allocator_with_fit_mode.h>
+#include <allocator_with_stats.h>
 #include <logger_guardant.h>
 #include <typename_holder.h>
 #include <mutex>
 #include <cmath>
+#include <algorithm>
 
 namespace __detail {
 constexpr size_t nearest_greater_k_of_2(size_t size) noexcept {
@@ -30,6 +32,7 @@ constexpr size_t nearest_greater_k_of_2(size_t size) noexcept {
 class allocator_buddies_system final : public smart_mem_resource,
                                        public allocator_test_utils,
                                        public allocator_with_fit_mode,
+                                       public allocator_with_stats,
                                        private logger_guardant,
                                        private typename_holder {
 
@@ -42,22 +45,29 @@ class allocator_buddies_system final : public smart_mem_resource,
 
     void *_trusted_memory;
 
-    /**
-     * TODO: You must improve it for alignment support
-     */
-
     static constexpr const size_t allocator_metadata_size =
         sizeof(logger *) + sizeof(allocator_dbg_helper *) + sizeof(fit_mode) +
         sizeof(unsigned char) + sizeof(std::mutex);
 
+    /**
+     * Block header padded so that user data starts on a fundamental
+     * alignment boundary, the block pointer sits right before user data
+     */
     static constexpr const size_t occupied_block_metadata_size =
-        sizeof(block_metadata) + sizeof(void *);
+        alignof(std::max_align_t);
+
+    static_assert(occupied_block_metadata_size >=
+                  sizeof(block_metadata) + sizeof(void *));
 
+    /**
+     * Block header word followed by the indices of the next and previous
+     * blocks in the free list of the same order
+     */
     static constexpr const size_t free_block_metadata_size =
-        sizeof(block_metadata);
+        sizeof(block_metadata) + 2 * sizeof(uint32_t);
 
-    static constexpr const size_t min_k =
-        __detail::nearest_greater_k_of_2(occupied_block_metadata_size);
+    static constexpr const size_t min_k = __detail::nearest_greater_k_of_2(
+        std::max(occupied_block_metadata_size, free_block_metadata_size));
 
   public:
     explicit allocator_buddies_system(
@@ -81,6 +91,12 @@ class allocator_buddies_system final : public smart_mem_resource,
   public:
     [[nodiscard]] void *do_allocate_sm(size_t size) override;
 
+    /**
+     * Blocks are aligned to their own size relative to the pool, so
+     * over-aligned requests only pay `alignment - header` bytes of padding
+     */
+    [[nodiscard]] void *do_allocate_sm(size_t size, size_t alignment) override;
+
     void do_deallocate_sm(void *at) override;
 
     bool
@@ -91,6 +107,8 @@ class allocator_buddies_system final : public smart_mem_resource,
     std::vector<allocator_test_utils::block_info>
     get_blocks_info() const noexcept override;
 
+    stats get_stats() const noexcept override;
+
   private:
     inline logger *get_logger() const override;
 
@@ -99,6 +117,8 @@ class allocator_buddies_system final : public smart_mem_resource,
     std::vector<allocator_test_utils::block_info>
     get_blocks_info_inner() const override;
 
+    size_t get_available_memory() const noexcept;
+
     /** TODO: Highly recommended for helper functions to return references */
 
     class buddy_iterator {
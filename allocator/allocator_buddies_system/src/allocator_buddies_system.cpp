@@ -6,10 +6,19 @@
 #include <new>
 #include <cstdint>
 #include <random>
+#include <bit>
+#include <limits>
 #include "../include/allocator_buddies_system.h"
 
 namespace {
 
+constexpr size_t max_orders = sizeof(size_t) * 8;
+
+// free lists link blocks by their pool offset counted in minimal blocks, so a
+// memcpy of the trusted memory stays consistent and links fit in 16 bytes
+constexpr size_t block_index_shift = 4;
+constexpr uint32_t no_block = std::numeric_limits<uint32_t>::max();
+
 struct alignas(alignof(std::max_align_t)) allocator_metadata {
     logger *logger_ptr;
     std::pmr::memory_resource *parent_allocator;
@@ -19,6 +28,12 @@ struct alignas(alignof(std::max_align_t)) allocator_metadata {
     size_t total_allocated_size;
     uint32_t allocator_id;
 
+    // bit k is set while the free list of order k is non-empty
+    size_t free_orders;
+    uint32_t free_heads[max_orders];
+
+    allocator_with_stats::stats_counters stats;
+
     allocator_metadata() = default;
     ~allocator_metadata() = default;
 };
@@ -83,22 +98,6 @@ bool is_block_occupied(void *block_meta) {
     }
 }
 
-void set_block_occupied(void *block_meta, bool occupied) {
-    if (block_meta == nullptr)
-        return;
-    uint32_t meta = *static_cast<uint32_t *>(block_meta);
-    meta = (meta & ~0x1) | (occupied ? 0x1 : 0);
-    *static_cast<uint32_t *>(block_meta) = meta;
-}
-
-void set_block_size(void *block_meta, size_t size) {
-    if (block_meta == nullptr)
-        return;
-    uint32_t meta = *static_cast<uint32_t *>(block_meta);
-    meta = (meta & ~0xFE) | ((static_cast<uint32_t>(size) & 0x7F) << 1);
-    *static_cast<uint32_t *>(block_meta) = meta;
-}
-
 void set_block_metadata(void *block_meta, bool occupied, size_t size,
                         uint32_t allocator_id) {
     if (block_meta == nullptr)
@@ -123,16 +122,6 @@ uint32_t get_block_allocator_id(void *block_meta) {
     }
 }
 
-void *get_buddy(void *block, size_t block_size, void *pool_start,
-                size_t total_size) {
-    size_t offset =
-        static_cast<char *>(block) - static_cast<char *>(pool_start);
-    size_t buddy_offset = offset ^ block_size;
-    if (buddy_offset >= total_size)
-        return nullptr;
-    return static_cast<char *>(pool_start) + buddy_offset;
-}
-
 size_t next_power_of_two(size_t size) {
     if (size == 0)
         return 1;
@@ -154,6 +143,76 @@ size_t nearest_greater_k_of_2(size_t size) {
     return k;
 }
 
+struct free_block_links {
+    uint32_t next;
+    uint32_t prev;
+};
+
+free_block_links *get_free_block_links(void *block_meta) {
+    return reinterpret_cast<free_block_links *>(static_cast<char *>(block_meta) +
+                                                sizeof(uint32_t));
+}
+
+void *get_free_block(void *trusted_memory, uint32_t index) {
+    return static_cast<char *>(get_pool_start(trusted_memory)) +
+           (static_cast<size_t>(index) << block_index_shift);
+}
+
+// every free block of the highest non-empty order is the largest one
+void update_largest_free_block(allocator_metadata *meta) {
+    meta->stats.largest_free_block.store(
+        meta->free_orders != 0
+            ? size_t{1} << (std::bit_width(meta->free_orders) - 1)
+            : 0,
+        std::memory_order_relaxed);
+}
+
+void free_list_push(void *trusted_memory, void *block_meta, size_t k) {
+    auto *meta = get_metadata(trusted_memory);
+    auto *links = get_free_block_links(block_meta);
+    const auto index = static_cast<uint32_t>(
+        (static_cast<char *>(block_meta) -
+         static_cast<char *>(get_pool_start(trusted_memory))) >>
+        block_index_shift);
+
+    links->next = meta->free_heads[k];
+    links->prev = no_block;
+    if (links->next != no_block) {
+        get_free_block_links(get_free_block(trusted_memory, links->next))
+            ->prev = index;
+    }
+
+    meta->free_heads[k] = index;
+    meta->free_orders |= size_t{1} << k;
+
+    meta->stats.hole_added(size_t{1} << k);
+    update_largest_free_block(meta);
+}
+
+void free_list_erase(void *trusted_memory, void *block_meta, size_t k) {
+    auto *meta = get_metadata(trusted_memory);
+    auto *links = get_free_block_links(block_meta);
+
+    if (links->prev != no_block) {
+        get_free_block_links(get_free_block(trusted_memory, links->prev))
+            ->next = links->next;
+    } else {
+        meta->free_heads[k] = links->next;
+    }
+
+    if (links->next != no_block) {
+        get_free_block_links(get_free_block(trusted_memory, links->next))
+            ->prev = links->prev;
+    }
+
+    if (meta->free_heads[k] == no_block) {
+        meta->free_orders &= ~(size_t{1} << k);
+    }
+
+    meta->stats.hole_removed(size_t{1} << k);
+    update_largest_free_block(meta);
+}
+
 uint32_t generate_unique_id() {
     static std::random_device rd;
     static std::mt19937 gen(rd());
@@ -218,9 +277,13 @@ allocator_buddies_system::allocator_buddies_system(
     : _trusted_memory(nullptr) {
     size_t pool_size = next_power_of_two(space_size);
     size_t pool_k = nearest_greater_k_of_2(pool_size);
+    static_assert(min_k >= block_index_shift);
     if (pool_k < min_k) {
         throw std::logic_error("Pool size too small for allocator");
     }
+    if (pool_k >= 32 + block_index_shift) {
+        throw std::logic_error("Pool size too large for allocator");
+    }
 
     size_t allocator_meta_size = calculate_allocator_metadata_size();
     size_t total_alloc_size = pool_size + allocator_meta_size;
@@ -271,6 +334,11 @@ allocator_buddies_system::allocator_buddies_system(
     void *block_meta = pool_start;
     set_block_metadata(block_meta, false, pool_k, meta->allocator_id);
 
+    meta->free_orders = 0;
+    std::fill(std::begin(meta->free_heads), std::end(meta->free_heads),
+              no_block);
+    free_list_push(_trusted_memory, block_meta, pool_k);
+
     if (meta->logger_ptr) {
         meta->logger_ptr->log(
             "[DEBUG constructor] First block initialized with size: " +
@@ -281,218 +349,76 @@ allocator_buddies_system::allocator_buddies_system(
 }
 
 void *allocator_buddies_system::do_allocate_sm(size_t size) {
+    return do_allocate_sm(size, alignof(std::max_align_t));
+}
+
+void *allocator_buddies_system::do_allocate_sm(size_t size, size_t alignment) {
     if (_trusted_memory == nullptr) {
         throw std::bad_alloc();
     }
 
     auto *meta = get_metadata(_trusted_memory);
-    if (meta == nullptr) {
-        throw std::bad_alloc();
-    }
-
     std::lock_guard<std::mutex> lock(meta->mutex);
-    if (meta->logger_ptr) {
-        meta->logger_ptr->log("do_allocate_sm called with size: " +
-                                  std::to_string(size),
-                              logger::severity::debug);
-    }
+    debug_with_guard(
+        [size] { return "do_allocate_sm called with size: " + std::to_string(size); });
 
-    size_t adjusted_size = size + sizeof(void *) + sizeof(uint32_t);
+    // header plus at most `alignment - header` bytes to reach the boundary
+    alignment = std::max(alignment, occupied_block_metadata_size);
+    size_t adjusted_size = size + alignment;
     size_t k = nearest_greater_k_of_2(adjusted_size);
     k = std::max(k, static_cast<size_t>(min_k));
     if (k > meta->k) {
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log("Requested size too large",
-                                  logger::severity::error);
-        }
+        error_with_guard("Requested size too large");
         throw std::bad_alloc();
     }
 
-    if (meta->logger_ptr) {
-        meta->logger_ptr->log("[DEBUG do_allocate_sm] Adjusted size: " +
-                                  std::to_string(adjusted_size) +
-                                  ", Calculated k: " + std::to_string(k) +
-                                  ", min_k: " + std::to_string(min_k),
-                              logger::severity::debug);
-    }
-
-    buddy_iterator best_block = end();
-    size_t best_size = meta->fit == fit_mode::the_worst_fit
-                           ? 0
-                           : std::numeric_limits<size_t>::max();
-
-    buddy_iterator it_begin = begin();
-    buddy_iterator it_end = end();
-
-    try {
-        for (auto it = it_begin; it != it_end; ++it) {
-            void *block_ptr = *it;
-            if (block_ptr == nullptr) {
-                if (meta->logger_ptr) {
-                    meta->logger_ptr->log(
-                        "[DEBUG do_allocate_sm] Skipping null block pointer",
-                        logger::severity::debug);
-                }
-                continue;
-            }
-
-            void *block_meta = get_block_metadata(block_ptr);
-            if (block_meta == nullptr) {
-                if (meta->logger_ptr) {
-                    meta->logger_ptr->log(
-                        "[DEBUG do_allocate_sm] Invalid block metadata",
-                        logger::severity::debug);
-                }
-                continue;
-            }
-
-            size_t block_size = 1ULL << it.size();
-            void *block_end = static_cast<char *>(block_meta) + block_size;
-            void *pool_end =
-                static_cast<char *>(get_pool_start(_trusted_memory)) +
-                (1ULL << meta->k);
-            if (block_end > pool_end) {
-                if (meta->logger_ptr) {
-                    meta->logger_ptr->log(
-                        "[DEBUG do_allocate_sm] Block exceeds pool boundary",
-                        logger::severity::debug);
-                }
-                continue;
-            }
-
-            if (it.occupied() || it.size() < k) {
-                if (meta->logger_ptr) {
-                    meta->logger_ptr->log("[DEBUG do_allocate_sm] Block "
-                                          "occupied or too small: size=" +
-                                              std::to_string(it.size()) +
-                                              ", required=" + std::to_string(k),
-                                          logger::severity::debug);
-                }
-                continue;
-            }
-
-            if (meta->fit == fit_mode::first_fit) {
-                best_block = it;
-                best_size = block_size;
-                if (meta->logger_ptr) {
-                    meta->logger_ptr->log(
-                        "[DEBUG do_allocate_sm] Found first fit block, size: " +
-                            std::to_string(block_size),
-                        logger::severity::debug);
-                }
-                break;
-            }
-            if (meta->fit == fit_mode::the_best_fit && block_size < best_size) {
-                best_block = it;
-                best_size = block_size;
-                if (meta->logger_ptr) {
-                    meta->logger_ptr->log("[DEBUG do_allocate_sm] Found better "
-                                          "fit block, size: " +
-                                              std::to_string(block_size),
-                                          logger::severity::debug);
-                }
-            }
-            if (meta->fit == fit_mode::the_worst_fit &&
-                block_size > best_size) {
-                best_block = it;
-                best_size = block_size;
-                if (meta->logger_ptr) {
-                    meta->logger_ptr->log(
-                        "[DEBUG do_allocate_sm] Found worse fit block, size: " +
-                            std::to_string(block_size),
-                        logger::severity::debug);
-                }
-            }
-        }
-    } catch (const std::exception &e) {
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log(
-                std::string("Exception during block search: ") + e.what(),
-                logger::severity::error);
-        }
+    // every free block of order k or above fits, so only the order is chosen:
+    // first and best fit take the smallest one, worst fit the largest one
+    const size_t fitting_orders = meta->free_orders & (~size_t{0} << k);
+    if (fitting_orders == 0) {
+        error_with_guard("No suitable block found");
         throw std::bad_alloc();
     }
 
-    void *best_block_ptr = *best_block;
-    if (best_block == end() || best_block_ptr == nullptr) {
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log("No suitable block found",
-                                  logger::severity::error);
-        }
-        throw std::bad_alloc();
-    }
+    size_t current_k = meta->fit == fit_mode::the_worst_fit
+                           ? std::bit_width(fitting_orders) - 1
+                           : std::countr_zero(fitting_orders);
 
-    void *block = best_block_ptr;
-    void *block_meta = get_block_metadata(block);
-    if (block_meta == nullptr) {
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log(
-                "[DEBUG do_allocate_sm] Best block has invalid metadata",
-                logger::severity::error);
-        }
-        throw std::bad_alloc();
-    }
+    void *block_meta =
+        get_free_block(_trusted_memory, meta->free_heads[current_k]);
+    free_list_erase(_trusted_memory, block_meta, current_k);
 
-    size_t current_k = get_block_size(block_meta);
-    if (meta->logger_ptr) {
-        meta->logger_ptr->log(
-            "[DEBUG do_allocate_sm] Starting block split. Initial block k: " +
-                std::to_string(current_k) + ", Target k: " + std::to_string(k),
-            logger::severity::debug);
-    }
+    debug_with_guard([current_k, k] {
+        return "[DEBUG do_allocate_sm] Starting block split. Initial block k: " +
+               std::to_string(current_k) + ", Target k: " + std::to_string(k);
+    });
 
     while (current_k > k) {
         current_k--;
-        size_t split_size = 1ULL << current_k;
-        set_block_size(block_meta, current_k);
-
-        void *current_block_start =
-            static_cast<char *>(block) - sizeof(uint32_t);
         void *buddy_block_start =
-            static_cast<char *>(current_block_start) + split_size;
+            static_cast<char *>(block_meta) + (1ULL << current_k);
         set_block_metadata(buddy_block_start, false, current_k,
                            meta->allocator_id);
-
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log(
-                "[DEBUG do_allocate_sm] Split block. New k: " +
-                    std::to_string(current_k) +
-                    ", Split size: " + std::to_string(split_size) +
-                    ", Allocator ID: " + std::to_string(meta->allocator_id),
-                logger::severity::debug);
-        }
+        free_list_push(_trusted_memory, buddy_block_start, current_k);
     }
 
-    set_block_occupied(block_meta, true);
+    set_block_metadata(block_meta, true, k, meta->allocator_id);
+    meta->stats.block_allocated(size_t{1} << k);
 
-    auto *block_ptr_storage = static_cast<char *>(block);
-    *reinterpret_cast<void **>(block_ptr_storage) = block;
+    void *block = static_cast<char *>(block_meta) + sizeof(uint32_t);
+    const auto data_start = reinterpret_cast<uintptr_t>(block_meta) +
+                            occupied_block_metadata_size;
+    void *user_ptr = reinterpret_cast<void *>((data_start + alignment - 1) &
+                                              ~(alignment - 1));
 
-    void *user_ptr = block_ptr_storage + sizeof(void *);
+    auto *block_ptr_storage = static_cast<char *>(user_ptr) - sizeof(void *);
+    *reinterpret_cast<void **>(block_ptr_storage) = block;
 
-    if (meta->logger_ptr) {
-        size_t available = 0;
-        for (auto it = begin(); it != end(); ++it) {
-            void *block_ptr = *it;
-            if (block_ptr != nullptr && !it.occupied()) {
-                available += 1ULL << it.size();
-            }
-        }
-        meta->logger_ptr->log("Available memory after allocation: " +
-                                  std::to_string(available),
-                              logger::severity::information);
-
-        std::string blocks_state;
-        auto blocks = get_blocks_info_inner();
-        for (const auto &b : blocks) {
-            blocks_state += (b.is_block_occupied ? "occup " : "avail ") +
-                            std::to_string(b.block_size) + "|";
-        }
-        if (!blocks_state.empty())
-            blocks_state.pop_back();
-        meta->logger_ptr->log("Blocks state: " + blocks_state,
-                              logger::severity::debug);
-    }
+    information_with_guard([this] {
+        return "Available memory after allocation: " +
+               std::to_string(get_available_memory());
+    });
+    debug_with_guard([this] { return "Blocks state: " + print_blocks(); });
 
     return user_ptr;
 }
@@ -500,177 +426,85 @@ void *allocator_buddies_system::do_allocate_sm(size_t size) {
 void allocator_buddies_system::do_deallocate_sm(void *at) {
     if (_trusted_memory == nullptr || at == nullptr) {
         if (_trusted_memory) {
-            auto *meta = get_metadata(_trusted_memory);
-            if (meta->logger_ptr) {
-                meta->logger_ptr->log(
-                    "Invalid pointer for deallocation: null pointer",
-                    logger::severity::error);
-            }
+            error_with_guard("Invalid pointer for deallocation: null pointer");
         }
         throw std::invalid_argument("Invalid pointer for deallocation");
     }
 
     auto *meta = get_metadata(_trusted_memory);
-    if (meta == nullptr) {
-        throw std::invalid_argument("Invalid allocator state");
-    }
-
     std::lock_guard<std::mutex> lock(meta->mutex);
-    if (meta->logger_ptr) {
-        meta->logger_ptr->log("do_deallocate_sm called",
-                              logger::severity::debug);
-    }
+    debug_with_guard("do_deallocate_sm called");
 
     void *block_ptr_storage = static_cast<char *>(at) - sizeof(void *);
     void *block = *reinterpret_cast<void **>(block_ptr_storage);
 
-    if (block == nullptr) {
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log("Invalid block pointer",
-                                  logger::severity::error);
-        }
-        throw std::invalid_argument("Invalid block pointer");
-    }
-
-    void *pool_start = get_pool_start(_trusted_memory);
-    if (pool_start == nullptr) {
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log("Invalid pool start",
-                                  logger::severity::error);
-        }
-        throw std::invalid_argument("Invalid pool start");
-    }
-
+    auto *pool_start = static_cast<char *>(get_pool_start(_trusted_memory));
     size_t total_size = 1ULL << meta->k;
-    if (block < pool_start ||
-        block >= static_cast<char *>(pool_start) + total_size) {
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log("Invalid pointer for deallocation",
-                                  logger::severity::error);
-        }
+    if (block < pool_start || block >= pool_start + total_size) {
+        error_with_guard("Invalid pointer for deallocation");
         throw std::invalid_argument(
             "Pointer does not belong to this allocator");
     }
 
     void *block_meta = get_block_metadata(block);
-    if (block_meta == nullptr) {
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log("Invalid block metadata",
-                                  logger::severity::error);
-        }
-        throw std::invalid_argument("Invalid block metadata");
-    }
-
     if (get_block_allocator_id(block_meta) != meta->allocator_id) {
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log(
-                "Block does not belong to this allocator (ID mismatch)",
-                logger::severity::error);
-        }
+        error_with_guard("Block does not belong to this allocator (ID mismatch)");
         throw std::invalid_argument("Block does not belong to this allocator");
     }
 
-    // Because this!
-    //  void** parent = reinterpret_cast<void**>(reinterpret_cast<char*>(at) -
-    //  sizeof(void**));
-    //
-    //  if ((*parent != _trusted_memory)) {
-    //      throw std::runtime_error("do_deallocate_sm - invalid block");
-    //  }
-
     if (!is_block_occupied(block_meta)) {
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log("Block already free",
-                                  logger::severity::error);
-        }
+        error_with_guard("Block already free");
         throw std::invalid_argument("Block is not occupied");
     }
 
-    set_block_occupied(block_meta, false);
     size_t current_k = get_block_size(block_meta);
-    if (meta->logger_ptr) {
-        meta->logger_ptr->log(
-            "[DEBUG do_deallocate_sm] Block freed, current k: " +
-                std::to_string(current_k),
-            logger::severity::debug);
-    }
+    meta->stats.block_deallocated(size_t{1} << current_k);
 
+    // the buddy of a block always starts on a block boundary, so its header
+    // word tells whether it is a whole free block of the same order
     while (current_k < meta->k) {
-        size_t block_size = 1ULL << current_k;
-        void *buddy = get_buddy(block, block_size, pool_start, total_size);
-        if (!buddy) {
-            if (meta->logger_ptr) {
-                meta->logger_ptr->log("[DEBUG do_deallocate_sm] No buddy found",
-                                      logger::severity::debug);
-            }
-            break;
-        }
-
-        void *buddy_meta = get_block_metadata(buddy);
-        if (buddy_meta == nullptr) {
-            if (meta->logger_ptr) {
-                meta->logger_ptr->log(
-                    "[DEBUG do_deallocate_sm] Invalid buddy metadata",
-                    logger::severity::debug);
-            }
-            break;
-        }
+        const size_t offset = static_cast<char *>(block_meta) - pool_start;
+        void *buddy_meta = pool_start + (offset ^ (1ULL << current_k));
 
         if (is_block_occupied(buddy_meta) ||
             get_block_size(buddy_meta) != current_k ||
             get_block_allocator_id(buddy_meta) != meta->allocator_id) {
-            if (meta->logger_ptr) {
-                meta->logger_ptr->log(
-                    "[DEBUG do_deallocate_sm] Buddy occupied, different size, "
-                    "or different allocator",
-                    logger::severity::debug);
-            }
             break;
         }
 
-        block = std::min(block, buddy);
-        block_meta = get_block_metadata(block);
-        if (block_meta == nullptr) {
-            if (meta->logger_ptr) {
-                meta->logger_ptr->log("[DEBUG do_deallocate_sm] Invalid block "
-                                      "metadata after merge",
-                                      logger::severity::debug);
-            }
-            break;
-        }
+        free_list_erase(_trusted_memory, buddy_meta, current_k);
+        block_meta = std::min(block_meta, buddy_meta);
+        ++current_k;
 
-        set_block_size(block_meta, ++current_k);
-        if (meta->logger_ptr) {
-            meta->logger_ptr->log(
-                "[DEBUG do_deallocate_sm] Merged with buddy, new k: " +
-                    std::to_string(current_k),
-                logger::severity::debug);
-        }
+        debug_with_guard([current_k] {
+            return "[DEBUG do_deallocate_sm] Merged with buddy, new k: " +
+                   std::to_string(current_k);
+        });
     }
 
-    if (meta->logger_ptr) {
-        size_t available = 0;
-        for (auto it = begin(); it != end(); ++it) {
-            void *block_ptr = *it;
-            if (block_ptr != nullptr && !it.occupied()) {
-                available += 1ULL << it.size();
-            }
-        }
-        meta->logger_ptr->log("Available memory after deallocation: " +
-                                  std::to_string(available),
-                              logger::severity::information);
-
-        std::string blocks_state;
-        auto blocks = get_blocks_info_inner();
-        for (const auto &b : blocks) {
-            blocks_state += (b.is_block_occupied ? "occup " : "avail ") +
-                            std::to_string(b.block_size) + "|";
+    set_block_metadata(block_meta, false, current_k, meta->allocator_id);
+    free_list_push(_trusted_memory, block_meta, current_k);
+
+    information_with_guard([this] {
+        return "Available memory after deallocation: " +
+               std::to_string(get_available_memory());
+    });
+    debug_with_guard([this] { return "Blocks state: " + print_blocks(); });
+}
+
+size_t allocator_buddies_system::get_available_memory() const noexcept {
+    auto *meta = get_metadata(_trusted_memory);
+    size_t available = 0;
+
+    for (size_t k = min_k; k <= meta->k; ++k) {
+        for (auto index = meta->free_heads[k]; index != no_block;
+             index = get_free_block_links(get_free_block(_trusted_memory, index))
+                         ->next) {
+            available += 1ULL << k;
         }
-        if (!blocks_state.empty())
-            blocks_state.pop_back();
-        meta->logger_ptr->log("Blocks state: " + blocks_state,
-                              logger::severity::debug);
     }
+
+    return available;
 }
 
 allocator_buddies_system::allocator_buddies_system(
@@ -820,6 +654,11 @@ allocator_buddies_system::get_blocks_info() const noexcept {
     return get_blocks_info_inner();
 }
 
+allocator_with_stats::stats
+allocator_buddies_system::get_stats() const noexcept {
+    return get_metadata(_trusted_memory)->stats.load();
+}
+
 logger *allocator_buddies_system::get_logger() const {
     return get_metadata(_trusted_memory)->logger_ptr;
 }
@@ -832,200 +671,15 @@ std::vector<allocator_test_utils::block_info>
 allocator_buddies_system::get_blocks_info_inner() const {
     std::vector<allocator_test_utils::block_info> blocks;
 
-    if (_trusted_memory == nullptr) {
-        std::cerr << "[DEBUG get_blocks_info_inner] _trusted_memory is null. "
-                     "Returning empty."
-                  << std::endl;
-        return blocks;
-    }
     auto *meta = get_metadata(_trusted_memory);
-    logger *log = meta ? meta->logger_ptr : nullptr;
-
-    if (log)
-        log->log("[DEBUG get_blocks_info_inner] Entered function.",
-                 logger::severity::debug);
-    else
-        std::cerr << "[DEBUG get_blocks_info_inner] Entered function (logger "
-                     "unavailable)."
-                  << std::endl;
+    auto *current = static_cast<char *>(get_pool_start(_trusted_memory));
+    auto *pool_end = current + (size_t{1} << meta->k);
 
-    if (meta == nullptr) {
-        if (log)
-            log->log("[DEBUG get_blocks_info_inner] Allocator metadata is "
-                     "null. Returning empty.",
-                     logger::severity::error);
-        else
-            std::cerr << "[DEBUG get_blocks_info_inner] Allocator metadata is "
-                         "null. Returning empty."
-                      << std::endl;
-        return blocks;
+    while (current < pool_end) {
+        const size_t block_size = size_t{1} << get_block_size(current);
+        blocks.push_back({block_size, is_block_occupied(current)});
+        current += block_size;
     }
-    void *pool_start = get_pool_start(_trusted_memory);
-    if (pool_start == nullptr) {
-        if (log)
-            log->log("[DEBUG get_blocks_info_inner] Pool start is null. "
-                     "Returning empty.",
-                     logger::severity::error);
-        else
-            std::cerr << "[DEBUG get_blocks_info_inner] Pool start is null. "
-                         "Returning empty."
-                      << std::endl;
-        return blocks;
-    }
-
-    void *current_block_meta = pool_start;
-    void *pool_end = static_cast<char *>(pool_start) + (1ULL << meta->k);
-
-    if (log) {
-        log->log("[DEBUG get_blocks_info_inner] Pool start: " +
-                     std::to_string(reinterpret_cast<uintptr_t>(pool_start)) +
-                     ", Pool end: " +
-                     std::to_string(reinterpret_cast<uintptr_t>(pool_end)) +
-                     ", Pool k: " + std::to_string(meta->k) +
-                     ", Min k: " + std::to_string(min_k),
-                 logger::severity::debug);
-    } else {
-        std::cerr << "[DEBUG get_blocks_info_inner] Pool start: " << pool_start
-                  << ", Pool end: " << pool_end << ", Pool k: " << meta->k
-                  << ", Min k: " << min_k << std::endl;
-    }
-
-    int block_count = 0;
-    while (current_block_meta < pool_end) {
-        block_count++;
-        if (log)
-            log->log("[DEBUG get_blocks_info_inner] Iteration " +
-                         std::to_string(block_count) + ": current_meta = " +
-                         std::to_string(
-                             reinterpret_cast<uintptr_t>(current_block_meta)),
-                     logger::severity::debug);
-        else
-            std::cerr << "[DEBUG get_blocks_info_inner] Iteration "
-                      << block_count
-                      << ": current_meta = " << current_block_meta << std::endl;
-
-        try {
-            volatile unsigned char touch =
-                static_cast<block_metadata *>(current_block_meta)->size;
-            (void)touch;
-        } catch (...) {
-            if (log)
-                log->log("[DEBUG get_blocks_info_inner] Cannot read block "
-                         "metadata byte. Exiting loop.",
-                         logger::severity::warning);
-            else
-                std::cerr << "[DEBUG get_blocks_info_inner] Cannot read block "
-                             "metadata byte. Exiting loop."
-                          << std::endl;
-            break;
-        }
-
-        size_t block_k = get_block_size(current_block_meta);
-        if (log)
-            log->log("[DEBUG get_blocks_info_inner]   Read block_k = " +
-                         std::to_string(block_k),
-                     logger::severity::debug);
-        else
-            std::cerr << "[DEBUG get_blocks_info_inner]   Read block_k = "
-                      << block_k << std::endl;
-
-        if (block_k > meta->k || block_k < min_k) {
-            if (log)
-                log->log("[DEBUG get_blocks_info_inner] Invalid block k "
-                         "detected (block_k=" +
-                             std::to_string(block_k) +
-                             ", meta->k=" + std::to_string(meta->k) +
-                             ", min_k=" + std::to_string(min_k) +
-                             "). Exiting loop.",
-                         logger::severity::warning);
-            else
-                std::cerr << "[DEBUG get_blocks_info_inner] Invalid block k "
-                             "detected (block_k="
-                          << block_k
-                          << ", meta->k=" << static_cast<int>(meta->k)
-                          << ", min_k=" << min_k << "). Exiting loop."
-                          << std::endl;
-            break;
-        }
-
-        size_t block_size = 1ULL << block_k;
-        if (log)
-            log->log(
-                "[DEBUG get_blocks_info_inner]   Calculated block_size = " +
-                    std::to_string(block_size),
-                logger::severity::debug);
-        else
-            std::cerr
-                << "[DEBUG get_blocks_info_inner]   Calculated block_size = "
-                << block_size << std::endl;
-
-        if (static_cast<char *>(current_block_meta) + block_size >
-            static_cast<char *>(pool_end)) {
-            if (log)
-                log->log("[DEBUG get_blocks_info_inner] Block exceeds pool "
-                         "boundary. Exiting loop.",
-                         logger::severity::warning);
-            else
-                std::cerr << "[DEBUG get_blocks_info_inner] Block exceeds pool "
-                             "boundary. Exiting loop."
-                          << std::endl;
-            break;
-        }
-
-        bool is_occupied = is_block_occupied(current_block_meta);
-        if (log)
-            log->log("[DEBUG get_blocks_info_inner]   Is occupied = " +
-                         std::string(is_occupied ? "true" : "false"),
-                     logger::severity::debug);
-        else
-            std::cerr << "[DEBUG get_blocks_info_inner]   Is occupied = "
-                      << (is_occupied ? "true" : "false") << std::endl;
-
-        blocks.push_back({block_size, is_occupied});
-        if (log)
-            log->log("[DEBUG get_blocks_info_inner]   Block added to vector.",
-                     logger::severity::debug);
-        else
-            std::cerr
-                << "[DEBUG get_blocks_info_inner]   Block added to vector."
-                << std::endl;
-
-        void *next_block_meta =
-            static_cast<char *>(current_block_meta) + block_size;
-        if (log)
-            log->log("[DEBUG get_blocks_info_inner]   Next meta = " +
-                         std::to_string(
-                             reinterpret_cast<uintptr_t>(next_block_meta)),
-                     logger::severity::debug);
-        else
-            std::cerr << "[DEBUG get_blocks_info_inner]   Next meta = "
-                      << next_block_meta << std::endl;
-        current_block_meta = next_block_meta;
-    }
-
-    if (current_block_meta != pool_end) {
-        if (log)
-            log->log("[DEBUG get_blocks_info_inner] Final metadata pointer (" +
-                         std::to_string(
-                             reinterpret_cast<uintptr_t>(current_block_meta)) +
-                         ") does not match pool end (" +
-                         std::to_string(reinterpret_cast<uintptr_t>(pool_end)) +
-                         "). Potential error.",
-                     logger::severity::warning);
-        else
-            std::cerr
-                << "[DEBUG get_blocks_info_inner] Final metadata pointer ("
-                << current_block_meta << ") does not match pool end ("
-                << pool_end << "). Potential error." << std::endl;
-    }
-
-    if (log)
-        log->log("[DEBUG get_blocks_info_inner] Exiting function. Found " +
-                     std::to_string(blocks.size()) + " blocks.",
-                 logger::severity::debug);
-    else
-        std::cerr << "[DEBUG get_blocks_info_inner] Exiting function. Found "
-                  << blocks.size() << " blocks." << std::endl;
 
     return blocks;
 }
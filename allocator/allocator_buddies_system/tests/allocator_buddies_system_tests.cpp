@@ -199,11 +199,180 @@ TEST(positiveTests, test53)
     }
 }
 
+TEST(freeListTests, test1)
+{
+    std::unique_ptr<smart_mem_resource> allocator_instance(new allocator_buddies_system(256, nullptr, nullptr, allocator_with_fit_mode::fit_mode::the_best_fit));
+    auto *fit_mode_holder = dynamic_cast<allocator_with_fit_mode *>(allocator_instance.get());
+    
+    void *first_block = allocator_instance->allocate(sizeof(unsigned char) * 0);
+    fit_mode_holder->set_fit_mode(allocator_with_fit_mode::fit_mode::the_worst_fit);
+    void *second_block = allocator_instance->allocate(sizeof(unsigned char) * 0);
+    fit_mode_holder->set_fit_mode(allocator_with_fit_mode::fit_mode::the_best_fit);
+    void *third_block = allocator_instance->allocate(sizeof(unsigned char) * 0);
+    
+    auto actual_blocks_state = dynamic_cast<allocator_test_utils *>(allocator_instance.get())->get_blocks_info();
+    std::vector<allocator_test_utils::block_info> expected_blocks_state
+        {
+            { .block_size = 16, .is_block_occupied = true },
+            { .block_size = 16, .is_block_occupied = false },
+            { .block_size = 32, .is_block_occupied = false },
+            { .block_size = 64, .is_block_occupied = false },
+            { .block_size = 16, .is_block_occupied = true },
+            { .block_size = 16, .is_block_occupied = true },
+            { .block_size = 32, .is_block_occupied = false },
+            { .block_size = 64, .is_block_occupied = false }
+        };
+    
+    ASSERT_EQ(actual_blocks_state.size(), expected_blocks_state.size());
+    for (int i = 0; i < actual_blocks_state.size(); i++)
+    {
+        ASSERT_EQ(actual_blocks_state[i], expected_blocks_state[i]);
+    }
+    
+    allocator_instance->deallocate(first_block, 1);
+    allocator_instance->deallocate(second_block, 1);
+    allocator_instance->deallocate(third_block, 1);
+}
+
+TEST(freeListTests, test2)
+{
+    std::unique_ptr<smart_mem_resource> allocator_instance(new allocator_buddies_system(1 << 16));
+    auto *fit_mode_holder = dynamic_cast<allocator_with_fit_mode *>(allocator_instance.get());
+    auto *test_utils = dynamic_cast<allocator_test_utils *>(allocator_instance.get());
+    std::list<void *> allocated_blocks;
+    srand(0);
+    
+    for (int i = 0; i < 5000; i++)
+    {
+        if (rand() % 3 != 0 || allocated_blocks.empty())
+        {
+            fit_mode_holder->set_fit_mode(static_cast<allocator_with_fit_mode::fit_mode>(rand() % 3));
+            
+            try
+            {
+                allocated_blocks.push_back(allocator_instance->allocate(rand() % 600));
+            }
+            catch (std::bad_alloc const &)
+            {
+            }
+        }
+        else
+        {
+            auto it = allocated_blocks.begin();
+            std::advance(it, rand() % allocated_blocks.size());
+            allocator_instance->deallocate(*it, 1);
+            allocated_blocks.erase(it);
+        }
+    }
+    
+    while (!allocated_blocks.empty())
+    {
+        allocator_instance->deallocate(allocated_blocks.front(), 1);
+        allocated_blocks.pop_front();
+    }
+    
+    auto actual_blocks_state = test_utils->get_blocks_info();
+    ASSERT_EQ(actual_blocks_state.size(), 1);
+    ASSERT_EQ(actual_blocks_state[0], (allocator_test_utils::block_info{ .block_size = 1 << 16, .is_block_occupied = false }));
+}
+
+TEST(alignmentTests, test1)
+{
+    std::unique_ptr<smart_mem_resource> allocator_instance(new allocator_buddies_system(4096));
+    std::vector<void *> allocated_blocks;
+    
+    for (size_t alignment : { 32, 64, 256, 16, 128 })
+    {
+        auto block = allocator_instance->allocate(sizeof(char) * 13, alignment);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % alignment, 0);
+        allocated_blocks.push_back(block);
+    }
+    
+    for (auto block: allocated_blocks)
+    {
+        allocator_instance->deallocate(block, 1);
+    }
+    
+    auto actual_blocks_state = dynamic_cast<allocator_test_utils *>(allocator_instance.get())->get_blocks_info();
+    ASSERT_EQ(actual_blocks_state.size(), 1);
+    ASSERT_FALSE(actual_blocks_state[0].is_block_occupied);
+}
+
 TEST(falsePositiveTests, test1)
 {
     ASSERT_THROW(new allocator_buddies_system(1), std::logic_error);
 }
 
+TEST(statsTests, test1)
+{
+    allocator_buddies_system allocator(4096);
+    
+    auto stats = allocator.get_stats();
+    ASSERT_EQ(stats.free_bytes, 4096);
+    ASSERT_EQ(stats.largest_free_block, 4096);
+    ASSERT_EQ(stats.free_blocks_count, 1);
+    
+    std::list<void *> allocated_blocks;
+    size_t allocations_count = 0;
+    srand(5);
+    
+    for (auto i = 0; i < 3000; i++)
+    {
+        if (rand() % 3 != 0 || allocated_blocks.empty())
+        {
+            try
+            {
+                allocated_blocks.push_back(allocator.allocate(rand() % 300 + 1));
+                ++allocations_count;
+            }
+            catch (std::bad_alloc const &)
+            {
+            }
+        }
+        else
+        {
+            auto it = allocated_blocks.begin();
+            std::advance(it, rand() % allocated_blocks.size());
+            allocator.deallocate(*it, 1);
+            allocated_blocks.erase(it);
+        }
+        
+        size_t free_bytes = 0, occupied_bytes = 0, largest_free_block = 0, free_blocks_count = 0;
+        for (auto const &block : allocator.get_blocks_info())
+        {
+            if (block.is_block_occupied)
+            {
+                occupied_bytes += block.block_size;
+            }
+            else
+            {
+                free_bytes += block.block_size;
+                largest_free_block = std::max(largest_free_block, block.block_size);
+                ++free_blocks_count;
+            }
+        }
+        
+        stats = allocator.get_stats();
+        ASSERT_EQ(stats.free_bytes, free_bytes);
+        ASSERT_EQ(stats.occupied_bytes, occupied_bytes);
+        ASSERT_EQ(stats.largest_free_block, largest_free_block);
+        ASSERT_EQ(stats.free_blocks_count, free_blocks_count);
+        ASSERT_EQ(stats.allocations_count, allocations_count);
+        ASSERT_EQ(stats.deallocations_count, allocations_count - allocated_blocks.size());
+        ASSERT_GE(stats.high_water_mark, occupied_bytes);
+    }
+    
+    for (auto block : allocated_blocks)
+    {
+        allocator.deallocate(block, 1);
+    }
+    
+    stats = allocator.get_stats();
+    ASSERT_EQ(stats.free_bytes, 4096);
+    ASSERT_EQ(stats.free_blocks_count, 1);
+    ASSERT_EQ(stats.fragmentation, 0);
+}
+
 int main(
     int argc,
     char *argv[])
@@ -2,6 +2,7 @@
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_GLOBAL_HEAP_H
 
 #include <allocator_dbg_helper.h>
+#include <allocator_with_stats.h>
 #include <logger.h>
 #include <logger_guardant.h>
 #include <pp_allocator.h>
@@ -10,6 +11,7 @@
 class allocator_global_heap final:
     private allocator_dbg_helper,
     public smart_mem_resource,
+    public allocator_with_stats,
     private logger_guardant,
     private typename_holder
 {
@@ -18,8 +20,24 @@ private:
     
     logger *_logger;
 
+    /** Every block is prefixed with a header of max(alignment, alignof(max_align_t))
+     *  bytes whose last size_t stores the header size itself and the one before it
+     *  the usable size
+     */
     static constexpr const size_t size_t_size = sizeof(size_t);
 
+public:
+
+    /** Blocks of up to this many bytes with default alignment are rounded up to
+     *  a multiple of `cached_size_step` and, once freed, kept in a small per-thread
+     *  cache for the next allocation of the same class
+     */
+    static constexpr const size_t max_cached_size = 256;
+
+    static constexpr const size_t cached_size_step = 16;
+
+    static constexpr const size_t cache_depth = 32;
+
 public:
     
     explicit allocator_global_heap(
@@ -43,12 +61,24 @@ public:
     
     [[nodiscard]] void *do_allocate_sm(
         size_t size) override;
+
+    [[nodiscard]] void *do_allocate_sm(
+        size_t size,
+        size_t alignment) override;
     
     void do_deallocate_sm(
         void *at) override;
 
     bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
 
+public:
+
+    /** Counters are shared by all instances, just like the heap and the caches are.
+     *  Cached blocks count as neither free nor occupied, `::operator new` shows
+     *  no holes, so the free block fields stay 0
+     */
+    stats get_stats() const noexcept override;
+
 private:
     
     inline logger *get_logger() const override;
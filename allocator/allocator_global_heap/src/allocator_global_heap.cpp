@@ -1,5 +1,74 @@
 #include "../include/allocator_global_heap.h"
-#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <new>
+
+namespace
+{
+    constexpr size_t cached_classes_count = allocator_global_heap::max_cached_size / allocator_global_heap::cached_size_step;
+
+    struct thread_cache
+    {
+        void *blocks[cached_classes_count][allocator_global_heap::cache_depth];
+
+        size_t counts[cached_classes_count] = {};
+
+        ~thread_cache();
+    };
+
+    // trivially destructible, so it can still be read by frees that come after the
+    // cache itself is gone at thread exit
+    thread_local bool thread_cache_destroyed = false;
+
+    thread_local thread_cache cache;
+
+    thread_cache::~thread_cache()
+    {
+        thread_cache_destroyed = true;
+
+        for (size_t size_class = 0; size_class < cached_classes_count; ++size_class)
+        {
+            for (size_t i = 0; i < counts[size_class]; ++i)
+            {
+                // cached blocks all have the default header
+                ::operator delete(static_cast<std::byte *>(blocks[size_class][i]) - alignof(std::max_align_t));
+            }
+        }
+    }
+
+    struct heap_counters
+    {
+        std::atomic<size_t> allocations_count{ 0 };
+
+        std::atomic<size_t> deallocations_count{ 0 };
+
+        std::atomic<size_t> occupied_bytes{ 0 };
+
+        std::atomic<size_t> high_water_mark{ 0 };
+    };
+
+    heap_counters counters;
+
+    void count_allocation(
+        size_t size) noexcept
+    {
+        counters.allocations_count.fetch_add(1, std::memory_order_relaxed);
+        const size_t occupied = counters.occupied_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+
+        size_t peak = counters.high_water_mark.load(std::memory_order_relaxed);
+        while (occupied > peak && !counters.high_water_mark.compare_exchange_weak(peak, occupied, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void count_deallocation(
+        size_t size) noexcept
+    {
+        counters.deallocations_count.fetch_add(1, std::memory_order_relaxed);
+        counters.occupied_bytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+}
 
 allocator_global_heap::allocator_global_heap(logger *logger)
     : _logger(logger)
@@ -52,25 +121,53 @@ allocator_global_heap &allocator_global_heap::operator=(allocator_global_heap &&
 
 void* allocator_global_heap::do_allocate_sm(const size_t size)
 {
-    debug_with_guard("Starting allocation of size " + std::to_string(size));
-    try
-    {
-        void* ptr = ::operator new(size);
-        std::ostringstream oss;
-        oss << "0x" << std::hex << reinterpret_cast<std::uintptr_t>(ptr);
-        debug_with_guard("Successfully allocated memory at " + oss.str() + " of size " + std::to_string(size));
-        return ptr;
-    }
-    catch (const std::bad_alloc& e)
+    return do_allocate_sm(size, alignof(std::max_align_t));
+}
+
+void* allocator_global_heap::do_allocate_sm(const size_t size, const size_t alignment)
+{
+    debug_with_guard([size]() { return std::format("Starting allocation of size {}", size); });
+
+    const size_t header_size = std::max(alignment, alignof(std::max_align_t));
+    const bool cached = header_size == alignof(std::max_align_t) && size <= max_cached_size;
+    const size_t capacity = cached
+        ? std::max((size + cached_size_step - 1) / cached_size_step, size_t{ 1 }) * cached_size_step
+        : size;
+
+    void *ptr = nullptr;
+
+    if (cached && !thread_cache_destroyed)
     {
-        error_with_guard("Failed to allocate memory of size " + std::to_string(size) + ": " + std::string(e.what()));
-        throw;
+        const size_t size_class = capacity / cached_size_step - 1;
+        if (cache.counts[size_class] != 0)
+        {
+            ptr = cache.blocks[size_class][--cache.counts[size_class]];
+        }
     }
-    catch (const std::exception& e)
+
+    if (ptr == nullptr)
     {
-        error_with_guard("Unexpected exception during memory allocation: " + std::string(e.what()));
-        throw;
+        try
+        {
+            void* block = header_size > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+                ? ::operator new(header_size + capacity, std::align_val_t(header_size))
+                : ::operator new(header_size + capacity);
+
+            ptr = static_cast<std::byte*>(block) + header_size;
+            *reinterpret_cast<size_t*>(static_cast<std::byte*>(ptr) - size_t_size) = header_size;
+            *reinterpret_cast<size_t*>(static_cast<std::byte*>(ptr) - 2 * size_t_size) = capacity;
+        }
+        catch (const std::bad_alloc& e)
+        {
+            error_with_guard([&]() { return std::format("Failed to allocate memory of size {}: {}", size, e.what()); });
+            throw;
+        }
     }
+
+    count_allocation(capacity);
+
+    debug_with_guard([ptr, size]() { return std::format("Successfully allocated memory at {:p} of size {}", ptr, size); });
+    return ptr;
 }
 
 void allocator_global_heap::do_deallocate_sm(void* at)
@@ -80,12 +177,37 @@ void allocator_global_heap::do_deallocate_sm(void* at)
         debug_with_guard("Attempted to deallocate NULL pointer - ignoring");
         return;
     }
-    
-    std::ostringstream oss;
-    oss << "0x" << std::hex << reinterpret_cast<std::uintptr_t>(at);
-    debug_with_guard("Starting deallocation of memory at " + oss.str());
-    ::operator delete(at);
-    debug_with_guard("Successfully deallocated memory at " + oss.str());
+
+    debug_with_guard([at]() { return std::format("Starting deallocation of memory at {:p}", at); });
+
+    const size_t header_size = *reinterpret_cast<size_t*>(static_cast<std::byte*>(at) - size_t_size);
+    const size_t capacity = *reinterpret_cast<size_t*>(static_cast<std::byte*>(at) - 2 * size_t_size);
+    void* block = static_cast<std::byte*>(at) - header_size;
+
+    count_deallocation(capacity);
+
+    // default aligned blocks this small were all rounded up to a class
+    if (header_size == alignof(std::max_align_t) && capacity <= max_cached_size && !thread_cache_destroyed)
+    {
+        const size_t size_class = capacity / cached_size_step - 1;
+        if (cache.counts[size_class] != cache_depth)
+        {
+            cache.blocks[size_class][cache.counts[size_class]++] = at;
+            debug_with_guard([at]() { return std::format("Cached memory at {:p}", at); });
+            return;
+        }
+    }
+
+    if (header_size > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        ::operator delete(block, std::align_val_t(header_size));
+    }
+    else
+    {
+        ::operator delete(block);
+    }
+
+    debug_with_guard([at]() { return std::format("Successfully deallocated memory at {:p}", at); });
 }
 
 bool allocator_global_heap::do_is_equal(const std::pmr::memory_resource& other) const noexcept
@@ -93,6 +215,21 @@ bool allocator_global_heap::do_is_equal(const std::pmr::memory_resource& other)
     return dynamic_cast<const allocator_global_heap*>(&other) != nullptr;
 }
 
+allocator_with_stats::stats allocator_global_heap::get_stats() const noexcept
+{
+    return
+        {
+            .free_bytes = 0,
+            .largest_free_block = 0,
+            .free_blocks_count = 0,
+            .fragmentation = 0,
+            .allocations_count = counters.allocations_count.load(std::memory_order_relaxed),
+            .deallocations_count = counters.deallocations_count.load(std::memory_order_relaxed),
+            .occupied_bytes = counters.occupied_bytes.load(std::memory_order_relaxed),
+            .high_water_mark = counters.high_water_mark.load(std::memory_order_relaxed)
+        };
+}
+
 logger* allocator_global_heap::get_logger() const
 {
     return _logger;
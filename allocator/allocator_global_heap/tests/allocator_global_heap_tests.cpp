@@ -77,6 +77,46 @@ TEST(allocatorGlobalHeapTests, test4)
     allocator_instance->deallocate(second_block, 1);
 }
 
+TEST(allocatorGlobalHeapTests, test5)
+{
+    std::unique_ptr<smart_mem_resource> allocator_instance(new allocator_global_heap);
+    
+    for (size_t alignment : { 8, 16, 64, 4096 })
+    {
+        auto block = allocator_instance->allocate(sizeof(char) * 13, alignment);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % alignment, 0);
+        allocator_instance->deallocate(block, 1);
+    }
+}
+
+TEST(allocatorGlobalHeapTests, test6)
+{
+    allocator_global_heap allocator;
+    auto before = allocator.get_stats();
+    
+    // 20 and 24 bytes share a class, so the freed block comes back from the cache
+    auto first_block = allocator.allocate(20);
+    allocator.deallocate(first_block, 20);
+    auto second_block = allocator.allocate(24);
+    ASSERT_EQ(second_block, first_block);
+    
+    auto large_block = allocator.allocate(allocator_global_heap::max_cached_size + 1);
+    
+    auto stats = allocator.get_stats();
+    ASSERT_EQ(stats.allocations_count - before.allocations_count, 3);
+    ASSERT_EQ(stats.deallocations_count - before.deallocations_count, 1);
+    ASSERT_EQ(stats.occupied_bytes - before.occupied_bytes, 32 + allocator_global_heap::max_cached_size + 1);
+    
+    // a block freed through another instance still lands in this thread's cache
+    allocator_global_heap another_allocator;
+    another_allocator.deallocate(second_block, 24);
+    allocator.deallocate(large_block, 1);
+    
+    ASSERT_EQ(allocator.get_stats().occupied_bytes, before.occupied_bytes);
+    ASSERT_EQ(allocator.allocate(32), first_block);
+    allocator.deallocate(first_block, 32);
+}
+
 int main(
     int argc,
     char *argv[])
@@ -0,0 +1,90 @@
+#include <allocator_boundary_tags.h>
+#include <allocator_magazine.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t operations_per_thread = 200'000;
+    constexpr size_t live_blocks_per_thread = 64;
+
+    // each thread keeps a small window of live blocks and replaces a random one per step
+    double measure(std::pmr::memory_resource &resource, size_t threads_count)
+    {
+        std::vector<std::thread> threads;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (size_t t = 0; t < threads_count; ++t)
+        {
+            threads.emplace_back([&resource, t]()
+            {
+                std::mt19937 gen(t);
+                std::uniform_int_distribution<size_t> size_distribution(8, 128);
+                std::uniform_int_distribution<size_t> slot_distribution(0, live_blocks_per_thread - 1);
+
+                std::vector<void *> blocks(live_blocks_per_thread, nullptr);
+
+                for (size_t i = 0; i < operations_per_thread; ++i)
+                {
+                    auto &slot = blocks[slot_distribution(gen)];
+
+                    if (slot != nullptr)
+                    {
+                        resource.deallocate(slot, 1);
+                    }
+                    slot = resource.allocate(size_distribution(gen));
+                }
+
+                for (auto block: blocks)
+                {
+                    if (block != nullptr)
+                    {
+                        resource.deallocate(block, 1);
+                    }
+                }
+            });
+        }
+
+        for (auto &thread: threads)
+        {
+            thread.join();
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        return 2.0 * operations_per_thread * threads_count / elapsed.count();
+    }
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    size_t max_threads = argc > 1
+        ? std::stoul(argv[1])
+        : std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << std::setw(8) << "threads"
+              << std::setw(20) << "bndr_tgs ops/s"
+              << std::setw(20) << "magazine ops/s" << std::endl;
+
+    for (size_t threads_count = 1; threads_count <= max_threads; threads_count *= 2)
+    {
+        const size_t space_size = (threads_count + 4) << 20;
+
+        allocator_boundary_tags plain(space_size);
+        allocator_boundary_tags upstream(space_size);
+        allocator_magazine magazine(&upstream);
+
+        std::cout << std::setw(8) << threads_count
+                  << std::setw(20) << std::fixed << std::setprecision(0) << measure(plain, threads_count)
+                  << std::setw(20) << measure(magazine, threads_count) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_MAGAZINE_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_MAGAZINE_H
+
+#include <logger_guardant.h>
+#include <pp_allocator.h>
+#include <typename_holder.h>
+#include <memory>
+
+/**
+ * Per-thread small-object cache in front of any other memory resource.
+ *
+ * Every thread keeps a magazine of free blocks per size class and serves
+ * requests from it without locking. An empty magazine is refilled and a full
+ * one is half flushed in a single acquisition of the shared depot lock, so the
+ * upstream allocator (and its own mutex) is touched once per batch instead of
+ * once per request. Requests above `max_cached_size` go straight upstream.
+ */
+class allocator_magazine final : public smart_mem_resource,
+                                 private logger_guardant,
+                                 private typename_holder {
+
+  public:
+    struct shared_state;
+
+    struct thread_cache;
+
+  private:
+    std::shared_ptr<shared_state> _state;
+
+  public:
+    explicit allocator_magazine(
+        std::pmr::memory_resource *upstream_allocator = nullptr,
+        size_t max_cached_size = 256, size_t magazine_capacity = 64,
+        logger *logger = nullptr);
+
+    ~allocator_magazine() override;
+
+    allocator_magazine(allocator_magazine const &other) = delete;
+
+    allocator_magazine &operator=(allocator_magazine const &other) = delete;
+
+    allocator_magazine(allocator_magazine &&other) noexcept;
+
+    allocator_magazine &operator=(allocator_magazine &&other) noexcept;
+
+  public:
+    [[nodiscard]] void *do_allocate_sm(size_t size) override;
+
+    /** Over-aligned requests bypass the caches */
+    [[nodiscard]] void *do_allocate_sm(size_t size, size_t alignment) override;
+
+    void do_deallocate_sm(void *at) override;
+
+    bool
+    do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+  private:
+    thread_cache &get_thread_cache() const;
+
+    inline logger *get_logger() const override;
+
+    inline std::string get_typename() const noexcept override;
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_MAGAZINE_H
@@ -0,0 +1,304 @@
+#include "../include/allocator_magazine.h"
+#include <algorithm>
+#include <format>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// sits right before user data; cached blocks are never larger than
+// `max_cached_size_` and never over-aligned, so the header alone tells where a
+// block goes back to
+struct block_header {
+    size_t size_;
+
+    // distance back to the start of the upstream block
+    size_t offset_;
+};
+
+constexpr size_t block_header_size = alignof(std::max_align_t);
+constexpr size_t size_class_granularity = 16;
+
+static_assert(sizeof(block_header) <= block_header_size);
+
+// magazines kept in the depot per size class, beyond that blocks go upstream
+constexpr size_t depot_magazines_limit = 8;
+
+struct free_list {
+    struct node {
+        node *next_;
+    };
+
+    node *head_ = nullptr;
+    size_t count_ = 0;
+
+    void push(void *block) noexcept {
+        const auto n = static_cast<node *>(block);
+        n->next_ = head_;
+        head_ = n;
+        ++count_;
+    }
+
+    void *pop() noexcept {
+        const auto n = head_;
+        head_ = n->next_;
+        --count_;
+        return n;
+    }
+};
+
+block_header &get_block_header(void *at) noexcept {
+    return *reinterpret_cast<block_header *>(static_cast<std::byte *>(at) -
+                                             sizeof(block_header));
+}
+
+size_t round_to_size_class(size_t size) noexcept {
+    size = std::max(size, size_t{1});
+    return (size + size_class_granularity - 1) / size_class_granularity *
+           size_class_granularity;
+}
+
+} // namespace
+
+struct allocator_magazine::shared_state {
+    std::pmr::memory_resource *upstream_;
+    logger *logger_;
+    size_t max_cached_size_;
+    size_t magazine_capacity_;
+
+    // guards everything below, never taken on the fast path
+    std::mutex mutex_;
+    bool alive_ = true;
+    std::vector<free_list> depot_;
+    std::vector<thread_cache *> caches_;
+
+    void *allocate_upstream(size_t size,
+                            size_t alignment = block_header_size) {
+        const size_t offset = std::max(alignment, block_header_size);
+        const auto block = static_cast<std::byte *>(
+            upstream_->allocate(offset + size, offset));
+
+        get_block_header(block + offset) = {size, offset};
+        return block + offset;
+    }
+
+    void deallocate_upstream(void *at) {
+        const auto [size, offset] = get_block_header(at);
+        upstream_->deallocate(static_cast<std::byte *>(at) - offset,
+                              offset + size, offset);
+    }
+
+    void release(free_list &list) {
+        while (list.count_ != 0) {
+            deallocate_upstream(list.pop());
+        }
+    }
+
+    /** Moves `count` blocks of `magazine` to the depot, mutex must be held */
+    void flush(free_list &magazine, size_t size_class, size_t count) {
+        auto &depot = depot_[size_class];
+        const size_t depot_limit = magazine_capacity_ * depot_magazines_limit;
+
+        for (; count != 0; --count) {
+            if (depot.count_ < depot_limit) {
+                depot.push(magazine.pop());
+            } else {
+                deallocate_upstream(magazine.pop());
+            }
+        }
+    }
+};
+
+struct allocator_magazine::thread_cache {
+    std::shared_ptr<shared_state> state_;
+    std::vector<free_list> magazines_;
+};
+
+namespace {
+
+struct thread_cache_registry {
+    std::vector<std::unique_ptr<allocator_magazine::thread_cache>> caches_;
+
+    ~thread_cache_registry() {
+        for (auto &cache : caches_) {
+            auto &state = *cache->state_;
+            std::lock_guard lock(state.mutex_);
+
+            if (!state.alive_) {
+                continue;
+            }
+
+            for (size_t i = 0; i < cache->magazines_.size(); ++i) {
+                state.flush(cache->magazines_[i], i,
+                            cache->magazines_[i].count_);
+            }
+
+            std::erase(state.caches_, cache.get());
+        }
+    }
+};
+
+thread_local thread_cache_registry thread_caches;
+
+} // namespace
+
+allocator_magazine::allocator_magazine(
+    std::pmr::memory_resource *upstream_allocator, size_t max_cached_size,
+    size_t magazine_capacity, logger *logger)
+    : _state(std::make_shared<shared_state>()) {
+    if (magazine_capacity < 2) {
+        throw std::logic_error("`magazine_capacity` must be at least 2");
+    }
+
+    _state->upstream_ = upstream_allocator != nullptr
+                            ? upstream_allocator
+                            : std::pmr::get_default_resource();
+    _state->logger_ = logger;
+    _state->max_cached_size_ =
+        max_cached_size / size_class_granularity * size_class_granularity;
+    _state->magazine_capacity_ = magazine_capacity;
+    _state->depot_.resize(_state->max_cached_size_ / size_class_granularity);
+}
+
+allocator_magazine::~allocator_magazine() {
+    if (!_state) {
+        return;
+    }
+
+    std::lock_guard lock(_state->mutex_);
+
+    // threads that touched this allocator may still be running, their caches
+    // stay registered in them and are dropped lazily once seen dead
+    for (const auto cache : _state->caches_) {
+        for (auto &magazine : cache->magazines_) {
+            _state->release(magazine);
+        }
+    }
+
+    for (auto &depot : _state->depot_) {
+        _state->release(depot);
+    }
+
+    _state->caches_.clear();
+    _state->alive_ = false;
+}
+
+allocator_magazine::allocator_magazine(allocator_magazine &&other) noexcept
+    : _state(std::move(other._state)) {
+}
+
+allocator_magazine &
+allocator_magazine::operator=(allocator_magazine &&other) noexcept {
+    if (this != &other) {
+        std::swap(_state, other._state);
+    }
+    return *this;
+}
+
+[[nodiscard]] void *allocator_magazine::do_allocate_sm(size_t size) {
+    return do_allocate_sm(size, alignof(std::max_align_t));
+}
+
+[[nodiscard]] void *allocator_magazine::do_allocate_sm(size_t size,
+                                                       size_t alignment) {
+    const size_t rounded_size = round_to_size_class(size);
+
+    if (rounded_size > _state->max_cached_size_ ||
+        alignment > block_header_size) {
+        return _state->allocate_upstream(size, alignment);
+    }
+
+    const size_t size_class = rounded_size / size_class_granularity - 1;
+    auto &magazine = get_thread_cache().magazines_[size_class];
+
+    if (magazine.count_ == 0) {
+        auto &state = *_state;
+        std::lock_guard lock(state.mutex_);
+
+        auto &depot = state.depot_[size_class];
+        const size_t batch = state.magazine_capacity_ / 2;
+
+        while (magazine.count_ < batch && depot.count_ != 0) {
+            magazine.push(depot.pop());
+        }
+
+        if (magazine.count_ == 0) {
+            debug_with_guard([rounded_size] {
+                return std::format(
+                    "[*] refilling magazine of {} byte blocks from upstream",
+                    rounded_size);
+            });
+
+            magazine.push(state.allocate_upstream(rounded_size));
+
+            try {
+                while (magazine.count_ < batch) {
+                    magazine.push(state.allocate_upstream(rounded_size));
+                }
+            } catch (std::bad_alloc const &) {
+                // a partial batch is still enough to serve this request
+            }
+        }
+    }
+
+    return magazine.pop();
+}
+
+void allocator_magazine::do_deallocate_sm(void *at) {
+    const auto [size, offset] = get_block_header(at);
+
+    if (size > _state->max_cached_size_ || offset != block_header_size) {
+        _state->deallocate_upstream(at);
+        return;
+    }
+
+    const size_t size_class = size / size_class_granularity - 1;
+    auto &magazine = get_thread_cache().magazines_[size_class];
+
+    magazine.push(at);
+
+    if (magazine.count_ > _state->magazine_capacity_) {
+        std::lock_guard lock(_state->mutex_);
+        _state->flush(magazine, size_class, magazine.count_ / 2);
+    }
+}
+
+allocator_magazine::thread_cache &
+allocator_magazine::get_thread_cache() const {
+    auto &caches = thread_caches.caches_;
+
+    for (auto &cache : caches) {
+        if (cache->state_ == _state) {
+            return *cache;
+        }
+    }
+
+    std::erase_if(caches, [](const auto &cache) {
+        std::lock_guard lock(cache->state_->mutex_);
+        return !cache->state_->alive_;
+    });
+
+    auto cache = std::make_unique<thread_cache>();
+    cache->state_ = _state;
+    cache->magazines_.resize(_state->depot_.size());
+
+    {
+        std::lock_guard lock(_state->mutex_);
+        _state->caches_.push_back(cache.get());
+    }
+
+    return *caches.emplace_back(std::move(cache));
+}
+
+bool allocator_magazine::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+inline logger *allocator_magazine::get_logger() const {
+    return _state ? _state->logger_ : nullptr;
+}
+
+inline std::string allocator_magazine::get_typename() const noexcept {
+    return "allocator_magazine";
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <allocator_magazine.h>
+#include <allocator_boundary_tags.h>
+#include <cstring>
+#include <list>
+#include <thread>
+
+namespace
+{
+    bool all_blocks_free(allocator_test_utils const &allocator)
+    {
+        auto blocks = allocator.get_blocks_info();
+
+        return std::all_of(blocks.begin(), blocks.end(), [](auto const &block) { return !block.is_block_occupied; });
+    }
+}
+
+TEST(allocatorMagazineTests, test1)
+{
+    allocator_boundary_tags upstream(10'000);
+
+    {
+        std::unique_ptr<smart_mem_resource> allocator(new allocator_magazine(&upstream, 128, 8));
+
+        auto first_block = reinterpret_cast<char *>(allocator->allocate(sizeof(char) * 11));
+        strcpy(first_block, "0123456789");
+        allocator->deallocate(first_block, 1);
+
+        auto second_block = reinterpret_cast<char *>(allocator->allocate(sizeof(char) * 11));
+        ASSERT_EQ(first_block, second_block);
+        allocator->deallocate(second_block, 1);
+
+        ASSERT_FALSE(all_blocks_free(upstream));
+    }
+
+    ASSERT_TRUE(all_blocks_free(upstream));
+}
+
+TEST(allocatorMagazineTests, test2)
+{
+    allocator_boundary_tags upstream(10'000);
+
+    {
+        std::unique_ptr<smart_mem_resource> allocator(new allocator_magazine(&upstream, 128, 8));
+
+        auto block = allocator->allocate(sizeof(char) * 1000);
+        allocator->deallocate(block, 1);
+
+        ASSERT_TRUE(all_blocks_free(upstream));
+
+        ASSERT_THROW(static_cast<void>(allocator->allocate(sizeof(char) * 20'000)), std::bad_alloc);
+    }
+}
+
+TEST(allocatorMagazineTests, test3)
+{
+    allocator_boundary_tags upstream(1'000'000);
+
+    {
+        allocator_magazine allocator(&upstream, 256, 16);
+        std::vector<std::thread> threads;
+
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&allocator, t]()
+            {
+                std::list<unsigned char *> allocated_blocks;
+                srand(t);
+
+                for (int i = 0; i < 10000; ++i)
+                {
+                    if (rand() % 2 == 0 || allocated_blocks.empty())
+                    {
+                        size_t size = rand() % 300 + 1;
+                        auto block = reinterpret_cast<unsigned char *>(allocator.allocate(size));
+                        memset(block, t, size);
+                        block[0] = static_cast<unsigned char>(t);
+                        allocated_blocks.push_back(block);
+                    }
+                    else
+                    {
+                        ASSERT_EQ(allocated_blocks.front()[0], t);
+                        allocator.deallocate(allocated_blocks.front(), 1);
+                        allocated_blocks.pop_front();
+                    }
+                }
+
+                for (auto block: allocated_blocks)
+                {
+                    allocator.deallocate(block, 1);
+                }
+            });
+        }
+
+        for (auto &thread: threads)
+        {
+            thread.join();
+        }
+    }
+
+    ASSERT_TRUE(all_blocks_free(upstream));
+}
+
+TEST(allocatorMagazineTests, test4)
+{
+    allocator_boundary_tags upstream(10'000);
+    
+    {
+        allocator_magazine allocator(&upstream, 128, 8);
+        
+        for (size_t alignment : { 32, 64, 256 })
+        {
+            auto block = allocator.allocate(sizeof(char) * 13, alignment);
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % alignment, 0);
+            allocator.deallocate(block, 1);
+        }
+    }
+    
+    ASSERT_TRUE(all_blocks_free(upstream));
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
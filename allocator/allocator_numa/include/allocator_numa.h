@@ -0,0 +1,92 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_NUMA_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_NUMA_H
+
+#include <logger_guardant.h>
+#include <pp_allocator.h>
+#include <typename_holder.h>
+#include <functional>
+#include <memory>
+
+/**
+ * NUMA-aware front end keeping one child pool per node.
+ *
+ * Requests go to the pool of the node the calling thread runs on, found
+ * with `getcpu` on Linux. Elsewhere, or when the node topology can't be
+ * read, everything lives on node 0. Each block carries the index of the
+ * pool it came from, so it always goes back there. A block freed from
+ * another node is counted as a cross-node free.
+ *
+ * Pools only get local memory if their pages are first touched on their
+ * node. Giving them a lazily committed parent such as `allocator_pages`
+ * does that, because the pool's allocations happen on the pool's node.
+ */
+class allocator_numa final : public smart_mem_resource,
+                             private logger_guardant,
+                             private typename_holder {
+
+  public:
+    using pool_factory =
+        std::function<std::unique_ptr<smart_mem_resource>(size_t node)>;
+
+    struct numa_state;
+
+  private:
+    std::unique_ptr<numa_state> _state;
+
+  public:
+    /**
+     * @param nodes_count number of pools, zero asks the system. Nodes above
+     * the count share pools round-robin.
+     */
+    explicit allocator_numa(pool_factory const &factory,
+                            size_t nodes_count = 0,
+                            logger *logger = nullptr);
+
+    ~allocator_numa() override;
+
+    allocator_numa(allocator_numa const &other) = delete;
+
+    allocator_numa &operator=(allocator_numa const &other) = delete;
+
+    allocator_numa(allocator_numa &&other) noexcept;
+
+    allocator_numa &operator=(allocator_numa &&other) noexcept;
+
+  public:
+    [[nodiscard]] void *do_allocate_sm(size_t size) override;
+
+    [[nodiscard]] void *do_allocate_sm(size_t size, size_t alignment) override;
+
+    void do_deallocate_sm(void *at) override;
+
+    bool
+    do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+  public:
+    /** Allocates from the pool of `node` whatever node the caller is on */
+    [[nodiscard]] void *allocate_on_node(size_t node, size_t size,
+                                         size_t alignment = alignof(
+                                             std::max_align_t));
+
+    size_t nodes_count() const noexcept;
+
+    /** Pool index requests of the calling thread go to */
+    size_t current_node() const noexcept;
+
+    smart_mem_resource &pool(size_t node) const noexcept;
+
+    size_t allocations_count(size_t node) const noexcept;
+
+    /** Blocks freed by a thread on another node than the one they came from */
+    size_t cross_node_frees_count() const noexcept;
+
+    /** Nodes the system reports online, 1 when it can't tell */
+    static size_t system_nodes_count() noexcept;
+
+  private:
+    inline logger *get_logger() const override;
+
+    inline std::string get_typename() const noexcept override;
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_NUMA_H
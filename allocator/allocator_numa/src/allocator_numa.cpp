@@ -0,0 +1,226 @@
+#include "../include/allocator_numa.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace {
+
+// sits right before every block, the rest of the header is padding that
+// keeps the block aligned
+struct block_header {
+    std::uint32_t node_;
+    std::uint32_t header_size_;
+};
+
+static_assert(sizeof(block_header) <= alignof(std::max_align_t));
+
+struct alignas(64) node_counters {
+    std::atomic<size_t> allocations_{0};
+};
+
+/** Parses sysfs lists such as `0-3,8-11` */
+std::vector<size_t> parse_list(std::string const &path) {
+    std::vector<size_t> values;
+    std::ifstream stream(path);
+    std::string range;
+
+    while (std::getline(stream, range, ',')) {
+        size_t first = 0, last = 0;
+        char dash = 0;
+        std::istringstream range_stream(range);
+
+        if (!(range_stream >> first)) {
+            break;
+        }
+        last = range_stream >> dash >> last && dash == '-' ? last : first;
+
+        for (size_t value = first; value <= last; ++value) {
+            values.push_back(value);
+        }
+    }
+
+    return values;
+}
+
+// cpu index -> node, read once, sched_getcpu is a vDSO call so routing never
+// enters the kernel
+std::vector<std::uint32_t> const &get_cpu_nodes() {
+    static const std::vector<std::uint32_t> cpu_nodes = [] {
+        std::vector<std::uint32_t> result;
+
+#ifdef __linux__
+        for (auto node : parse_list("/sys/devices/system/node/online")) {
+            for (auto cpu : parse_list(std::format(
+                     "/sys/devices/system/node/node{}/cpulist", node))) {
+                result.resize(std::max(result.size(), cpu + 1), 0);
+                result[cpu] = static_cast<std::uint32_t>(node);
+            }
+        }
+#endif
+
+        return result;
+    }();
+
+    return cpu_nodes;
+}
+
+} // namespace
+
+struct allocator_numa::numa_state {
+    logger *logger_;
+    std::vector<std::unique_ptr<smart_mem_resource>> pools_;
+    std::unique_ptr<node_counters[]> counters_;
+    std::atomic<size_t> cross_node_frees_{0};
+};
+
+allocator_numa::allocator_numa(pool_factory const &factory,
+                               size_t nodes_count, logger *logger)
+    : _state(std::make_unique<numa_state>()) {
+    if (nodes_count == 0) {
+        nodes_count = system_nodes_count();
+    }
+
+    _state->logger_ = logger;
+    _state->counters_ = std::make_unique<node_counters[]>(nodes_count);
+
+    for (size_t node = 0; node < nodes_count; ++node) {
+        _state->pools_.push_back(factory(node));
+
+        if (_state->pools_.back() == nullptr) {
+            throw std::logic_error(
+                std::format("no pool was made for node {}", node));
+        }
+    }
+
+    information_with_guard([nodes_count] {
+        return std::format("[*] {} node pools", nodes_count);
+    });
+}
+
+allocator_numa::~allocator_numa() = default;
+
+allocator_numa::allocator_numa(allocator_numa &&other) noexcept
+    : _state(std::move(other._state)) {
+}
+
+allocator_numa &allocator_numa::operator=(allocator_numa &&other) noexcept {
+    if (this != &other) {
+        std::swap(_state, other._state);
+    }
+    return *this;
+}
+
+[[nodiscard]] void *allocator_numa::do_allocate_sm(size_t size) {
+    return do_allocate_sm(size, alignof(std::max_align_t));
+}
+
+[[nodiscard]] void *allocator_numa::do_allocate_sm(size_t size,
+                                                   size_t alignment) {
+    return allocate_on_node(current_node(), size, alignment);
+}
+
+void *allocator_numa::allocate_on_node(size_t node, size_t size,
+                                       size_t alignment) {
+    node %= _state->pools_.size();
+
+    const size_t header_size = std::max(alignment, alignof(std::max_align_t));
+
+    const auto block =
+        static_cast<std::byte *>(_state->pools_[node]->allocate(
+            header_size + size, header_size)) +
+        header_size;
+
+    *reinterpret_cast<block_header *>(block - sizeof(block_header)) = {
+        static_cast<std::uint32_t>(node),
+        static_cast<std::uint32_t>(header_size)};
+
+    _state->counters_[node].allocations_.fetch_add(1,
+                                                   std::memory_order_relaxed);
+
+    return block;
+}
+
+void allocator_numa::do_deallocate_sm(void *at) {
+    const auto block = static_cast<std::byte *>(at);
+    const auto header =
+        *reinterpret_cast<block_header *>(block - sizeof(block_header));
+
+    if (header.node_ >= _state->pools_.size()) {
+        error_with_guard([at] {
+            return std::format(
+                "[!] block doesn't belong to this allocator: {:p}", at);
+        });
+        throw std::logic_error("unknown block");
+    }
+
+    if (const size_t node = current_node(); node != header.node_) {
+        _state->cross_node_frees_.fetch_add(1, std::memory_order_relaxed);
+
+        debug_with_guard([&] {
+            return std::format("[*] block {:p} of node {} freed on node {}", at,
+                               header.node_, node);
+        });
+    }
+
+    _state->pools_[header.node_]->deallocate(block - header.header_size_, 1);
+}
+
+bool allocator_numa::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+size_t allocator_numa::nodes_count() const noexcept {
+    return _state->pools_.size();
+}
+
+size_t allocator_numa::current_node() const noexcept {
+#ifdef __linux__
+    auto const &cpu_nodes = get_cpu_nodes();
+
+    if (const int cpu = ::sched_getcpu();
+        cpu >= 0 && static_cast<size_t>(cpu) < cpu_nodes.size()) {
+        return cpu_nodes[cpu] % _state->pools_.size();
+    }
+#endif
+
+    return 0;
+}
+
+smart_mem_resource &allocator_numa::pool(size_t node) const noexcept {
+    return *_state->pools_[node];
+}
+
+size_t allocator_numa::allocations_count(size_t node) const noexcept {
+    return _state->counters_[node].allocations_.load(std::memory_order_relaxed);
+}
+
+size_t allocator_numa::cross_node_frees_count() const noexcept {
+    return _state->cross_node_frees_.load(std::memory_order_relaxed);
+}
+
+size_t allocator_numa::system_nodes_count() noexcept {
+    size_t nodes_count = 1;
+
+    for (auto cpu_node : get_cpu_nodes()) {
+        nodes_count = std::max<size_t>(nodes_count, cpu_node + 1);
+    }
+
+    return nodes_count;
+}
+
+inline logger *allocator_numa::get_logger() const {
+    return _state->logger_;
+}
+
+inline std::string allocator_numa::get_typename() const noexcept {
+    return "allocator_numa";
+}
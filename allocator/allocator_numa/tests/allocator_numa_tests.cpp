@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <allocator_boundary_tags.h>
+#include <allocator_buddies_system.h>
+#include <allocator_numa.h>
+#include <thread>
+#include <vector>
+
+TEST(allocatorNumaTests, test1)
+{
+    std::vector<size_t> nodes;
+
+    allocator_numa allocator([&nodes](size_t node)
+    {
+        nodes.push_back(node);
+        return std::make_unique<allocator_boundary_tags>(100'000);
+    }, 2);
+
+    ASSERT_EQ(nodes, (std::vector<size_t>{ 0, 1 }));
+    ASSERT_EQ(allocator.nodes_count(), 2);
+    ASSERT_LT(allocator.current_node(), 2);
+    ASSERT_GE(allocator_numa::system_nodes_count(), 1);
+
+    const size_t local_node = allocator.current_node();
+    const size_t remote_node = 1 - local_node;
+
+    auto local_block = allocator.allocate(100);
+    auto remote_block = allocator.allocate_on_node(remote_node, 100);
+    auto aligned_block = allocator.allocate_on_node(remote_node, 100, 64);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned_block) % 64, 0);
+
+    ASSERT_EQ(allocator.allocations_count(local_node), 1);
+    ASSERT_EQ(allocator.allocations_count(remote_node), 2);
+
+    auto &remote_pool = dynamic_cast<allocator_boundary_tags &>(allocator.pool(remote_node));
+    ASSERT_EQ(remote_pool.get_stats().allocations_count, 2);
+
+    allocator.deallocate(local_block, 100);
+    ASSERT_EQ(allocator.cross_node_frees_count(), 0);
+
+    allocator.deallocate(remote_block, 100);
+    allocator.deallocate(aligned_block, 100, 64);
+    ASSERT_EQ(allocator.cross_node_frees_count(), 2);
+    ASSERT_EQ(remote_pool.get_stats().occupied_bytes, 0);
+}
+
+TEST(allocatorNumaTests, test2)
+{
+    constexpr size_t threads_count = 8;
+
+    allocator_numa allocator([](size_t)
+    {
+        return std::make_unique<allocator_buddies_system>(1 << 22);
+    });
+
+    std::vector<std::vector<void *>> blocks(threads_count);
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < threads_count; ++t)
+    {
+        threads.emplace_back([&allocator, &blocks, t]()
+        {
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                blocks[t].push_back(allocator.allocate(i % 200 + 1));
+            }
+        });
+    }
+
+    for (auto &thread: threads)
+    {
+        thread.join();
+    }
+
+    size_t allocations_count = 0;
+    for (size_t node = 0; node < allocator.nodes_count(); ++node)
+    {
+        allocations_count += allocator.allocations_count(node);
+    }
+    ASSERT_EQ(allocations_count, threads_count * 1000);
+
+    // every block finds its way back to the pool it came from
+    for (auto const &thread_blocks: blocks)
+    {
+        for (auto block: thread_blocks)
+        {
+            allocator.deallocate(block, 1);
+        }
+    }
+
+    for (size_t node = 0; node < allocator.nodes_count(); ++node)
+    {
+        ASSERT_EQ(dynamic_cast<allocator_buddies_system &>(allocator.pool(node)).get_stats().occupied_bytes, 0);
+    }
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
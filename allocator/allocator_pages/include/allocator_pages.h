@@ -0,0 +1,90 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_PAGES_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_PAGES_H
+
+#include <logger_guardant.h>
+#include <pp_allocator.h>
+#include <typename_holder.h>
+#include <atomic>
+
+/**
+ * Page-level resource meant as the `parent_allocator` of the pool
+ * allocators.
+ *
+ * Every block is its own anonymous mapping reserved without swap backing,
+ * so nothing is committed until a page is first touched and a multi-GB pool
+ * costs nothing up front. Huge page modes round mappings up to 2 MiB and
+ * align them to it, which keeps the TLB footprint of large pools small.
+ * `decommit` hands pages a pool no longer uses back to the kernel while the
+ * mapping stays valid.
+ *
+ * POSIX only, the constructor throws `operation_not_supported` elsewhere.
+ */
+class allocator_pages final : public smart_mem_resource,
+                              private logger_guardant,
+                              private typename_holder {
+
+  public:
+    enum class page_mode {
+        regular,
+
+        /** `madvise(MADV_HUGEPAGE)` on 2 MiB aligned mappings */
+        transparent_huge,
+
+        /**
+         * `MAP_HUGETLB` from the reserved huge page pool, falling back to
+         * transparent huge pages when the pool is empty
+         */
+        explicit_huge
+    };
+
+  private:
+    logger *_logger;
+    page_mode _mode;
+
+    /** Bytes mapped by live blocks, headers and rounding included */
+    std::atomic<size_t> _mapped_bytes;
+
+  public:
+    explicit allocator_pages(page_mode mode = page_mode::regular,
+                             logger *logger = nullptr);
+
+    ~allocator_pages() override;
+
+    allocator_pages(allocator_pages const &other) = delete;
+
+    allocator_pages &operator=(allocator_pages const &other) = delete;
+
+    allocator_pages(allocator_pages &&other) = delete;
+
+    allocator_pages &operator=(allocator_pages &&other) = delete;
+
+  public:
+    [[nodiscard]] void *do_allocate_sm(size_t size) override;
+
+    /** Alignments up to the page size are honoured */
+    [[nodiscard]] void *do_allocate_sm(size_t size, size_t alignment) override;
+
+    void do_deallocate_sm(void *at) override;
+
+    bool
+    do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+  public:
+    /**
+     * Drops the whole pages inside [at, at + size) of a live block. They
+     * read back as zeros and are committed again on the next write.
+     */
+    void decommit(void *at, size_t size) noexcept;
+
+    size_t mapped_bytes() const noexcept;
+
+    /** Granularity mappings are rounded up to in the current mode */
+    size_t page_size() const noexcept;
+
+  private:
+    inline logger *get_logger() const override;
+
+    inline std::string get_typename() const noexcept override;
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_PAGES_H
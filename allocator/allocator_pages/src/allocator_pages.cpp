@@ -0,0 +1,205 @@
+#include <operation_not_supported.h>
+#include "../include/allocator_pages.h"
+#include <algorithm>
+#include <cstdint>
+#include <format>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// the only huge page size x86-64 and aarch64 kernels use by default
+constexpr size_t huge_page_size = size_t{2} << 20;
+
+// sits right before every block, the mapping may start earlier when the
+// block is over-aligned
+struct mapping_header {
+    void *base_;
+    size_t length_;
+};
+
+static_assert(sizeof(mapping_header) <= alignof(std::max_align_t));
+
+size_t round_up(size_t value, size_t granularity) noexcept {
+    return (value + granularity - 1) / granularity * granularity;
+}
+
+#ifndef _WIN32
+
+size_t system_page_size() noexcept {
+    static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+void *map_anonymous(size_t length, int flags) noexcept {
+    void *base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    return base != MAP_FAILED ? base : nullptr;
+}
+
+// over-maps by a huge page and trims both ends to land on a boundary
+void *map_huge_aligned(size_t length) noexcept {
+    const auto raw = static_cast<std::byte *>(
+        map_anonymous(length + huge_page_size, MAP_NORESERVE));
+    if (raw == nullptr) {
+        return nullptr;
+    }
+
+    const auto base = reinterpret_cast<std::byte *>(
+        round_up(reinterpret_cast<std::uintptr_t>(raw), huge_page_size));
+
+    if (base != raw) {
+        ::munmap(raw, base - raw);
+    }
+    if (const size_t tail = raw + huge_page_size - base; tail != 0) {
+        ::munmap(base + length, tail);
+    }
+
+#ifdef MADV_HUGEPAGE
+    // a kernel without THP just keeps regular pages
+    ::madvise(base, length, MADV_HUGEPAGE);
+#endif
+
+    return base;
+}
+
+#endif
+
+} // namespace
+
+allocator_pages::allocator_pages(page_mode mode, logger *logger)
+    : _logger(logger), _mode(mode), _mapped_bytes(0) {
+#ifdef _WIN32
+    throw operation_not_supported();
+#endif
+}
+
+allocator_pages::~allocator_pages() {
+    if (const size_t leaked = _mapped_bytes.load(); leaked != 0) {
+        warning_with_guard([leaked] {
+            return std::format("[!] destroyed with {} bytes still mapped",
+                               leaked);
+        });
+    }
+}
+
+[[nodiscard]] void *allocator_pages::do_allocate_sm(size_t size) {
+    return do_allocate_sm(size, alignof(std::max_align_t));
+}
+
+[[nodiscard]] void *allocator_pages::do_allocate_sm(size_t size,
+                                                    size_t alignment) {
+#ifdef _WIN32
+    throw operation_not_supported();
+#else
+    if (alignment > system_page_size()) {
+        error_with_guard([alignment] {
+            return std::format("[!] can't align a mapping to {} bytes",
+                               alignment);
+        });
+        throw std::bad_alloc();
+    }
+
+    const size_t header_size = std::max(alignment, alignof(std::max_align_t));
+    const size_t length = round_up(header_size + size, page_size());
+
+    void *base = nullptr;
+
+    switch (_mode) {
+    case page_mode::regular:
+        base = map_anonymous(length, MAP_NORESERVE);
+        break;
+    case page_mode::explicit_huge:
+#ifdef MAP_HUGETLB
+        // reserved up front, an empty pool fails here instead of faulting
+        // with SIGBUS on first touch
+        base = map_anonymous(length, MAP_HUGETLB);
+#endif
+        if (base == nullptr) {
+            warning_with_guard("[*] huge page pool exhausted, falling back to "
+                               "transparent huge pages");
+        }
+        [[fallthrough]];
+    case page_mode::transparent_huge:
+        if (base == nullptr) {
+            base = map_huge_aligned(length);
+        }
+        break;
+    }
+
+    if (base == nullptr) {
+        error_with_guard([length] {
+            return std::format("[!] can't map {} bytes", length);
+        });
+        throw std::bad_alloc();
+    }
+
+    const auto block = static_cast<std::byte *>(base) + header_size;
+    *reinterpret_cast<mapping_header *>(block - sizeof(mapping_header)) = {
+        base, length};
+
+    _mapped_bytes += length;
+
+    debug_with_guard([&] {
+        return std::format("[+] mapped {} bytes at {:p}", length, base);
+    });
+
+    return block;
+#endif
+}
+
+void allocator_pages::do_deallocate_sm(void *at) {
+#ifndef _WIN32
+    const auto header = *reinterpret_cast<mapping_header *>(
+        static_cast<std::byte *>(at) - sizeof(mapping_header));
+
+    ::munmap(header.base_, header.length_);
+    _mapped_bytes -= header.length_;
+
+    debug_with_guard([&] {
+        return std::format("[-] unmapped {} bytes at {:p}", header.length_,
+                           header.base_);
+    });
+#endif
+}
+
+bool allocator_pages::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+void allocator_pages::decommit(void *at, size_t size) noexcept {
+#ifndef _WIN32
+    const auto begin = round_up(reinterpret_cast<std::uintptr_t>(at),
+                                system_page_size());
+    const auto end = (reinterpret_cast<std::uintptr_t>(at) + size) /
+                     system_page_size() * system_page_size();
+
+    if (begin < end) {
+        ::madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+    }
+#endif
+}
+
+size_t allocator_pages::mapped_bytes() const noexcept {
+    return _mapped_bytes.load(std::memory_order_relaxed);
+}
+
+size_t allocator_pages::page_size() const noexcept {
+#ifdef _WIN32
+    return huge_page_size;
+#else
+    return _mode == page_mode::regular ? system_page_size() : huge_page_size;
+#endif
+}
+
+inline logger *allocator_pages::get_logger() const {
+    return _logger;
+}
+
+inline std::string allocator_pages::get_typename() const noexcept {
+    return "allocator_pages";
+}
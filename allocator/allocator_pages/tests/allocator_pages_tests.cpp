@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <allocator_boundary_tags.h>
+#include <allocator_buddies_system.h>
+#include <allocator_pages.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    size_t resident_pages(
+        void *at,
+        size_t size)
+    {
+        const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const auto begin = reinterpret_cast<uintptr_t>(at) / page_size * page_size;
+        const size_t pages = (reinterpret_cast<uintptr_t>(at) + size - begin + page_size - 1) / page_size;
+
+        std::vector<unsigned char> residency(pages);
+        mincore(reinterpret_cast<void *>(begin), pages * page_size, residency.data());
+
+        return std::count_if(residency.begin(), residency.end(), [](unsigned char page) { return page & 1; });
+    }
+}
+
+TEST(allocatorPagesTests, test1)
+{
+    constexpr size_t size = 64 << 20;
+
+    allocator_pages allocator;
+
+    auto block = static_cast<unsigned char *>(allocator.allocate(size));
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % alignof(std::max_align_t), 0);
+    ASSERT_GE(allocator.mapped_bytes(), size);
+
+    // nothing is committed before it is touched
+    ASSERT_LE(resident_pages(block, size), 1);
+
+    std::memset(block, 0xAB, size);
+    ASSERT_EQ(resident_pages(block, size), resident_pages(block, size));
+    ASSERT_GT(resident_pages(block, size), size / allocator.page_size() / 2);
+
+    // the partial pages at both ends stay
+    allocator.decommit(block + size / 2, size / 2);
+    ASSERT_LE(resident_pages(block + size / 2, size / 2), 2);
+    ASSERT_EQ(block[size / 2 - 1], 0xAB);
+    ASSERT_EQ(block[size / 4 * 3], 0);
+
+    allocator.deallocate(block, size);
+    ASSERT_EQ(allocator.mapped_bytes(), 0);
+
+    auto aligned_block = allocator.allocate(100, 4096);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned_block) % 4096, 0);
+    allocator.deallocate(aligned_block, 100, 4096);
+
+    ASSERT_THROW(static_cast<void>(allocator.allocate(100, 1 << 30)), std::bad_alloc);
+}
+
+TEST(allocatorPagesTests, test2)
+{
+    for (auto mode : { allocator_pages::page_mode::transparent_huge, allocator_pages::page_mode::explicit_huge })
+    {
+        allocator_pages allocator(mode);
+        ASSERT_EQ(allocator.page_size(), 2 << 20);
+
+        auto block = allocator.allocate(3 << 20);
+        ASSERT_EQ(allocator.mapped_bytes(), 4 << 20);
+
+        // the block follows a header at the start of the mapping
+        ASSERT_EQ((reinterpret_cast<uintptr_t>(block) - alignof(std::max_align_t)) % (2 << 20), 0);
+
+        std::memset(block, 1, 3 << 20);
+        allocator.deallocate(block, 3 << 20);
+        ASSERT_EQ(allocator.mapped_bytes(), 0);
+    }
+}
+
+TEST(allocatorPagesTests, test3)
+{
+    allocator_pages pages(allocator_pages::page_mode::transparent_huge);
+
+    {
+        allocator_boundary_tags boundary_tags(1 << 30, &pages);
+        allocator_buddies_system buddies_system(1 << 20, &pages);
+
+        ASSERT_GE(pages.mapped_bytes(), (1 << 30) + (1 << 20));
+
+        std::vector<void *> blocks;
+        for (int i = 0; i < 1000; ++i)
+        {
+            blocks.push_back(boundary_tags.allocate(1000));
+            blocks.push_back(buddies_system.allocate(100));
+        }
+
+        for (size_t i = 0; i < blocks.size(); i += 2)
+        {
+            boundary_tags.deallocate(blocks[i], 1000);
+            buddies_system.deallocate(blocks[i + 1], 100);
+        }
+
+        ASSERT_EQ(boundary_tags.get_stats().occupied_bytes, 0);
+        ASSERT_EQ(buddies_system.get_stats().occupied_bytes, 0);
+    }
+
+    ASSERT_EQ(pages.mapped_bytes(), 0);
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
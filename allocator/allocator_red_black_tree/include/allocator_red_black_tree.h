@@ -1,121 +1,210 @@
 #ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_RED_BLACK_TREE_H
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_RED_BLACK_TREE_H
 
-#include <pp_allocator.h>
 #include <allocator_test_utils.h>
 #include <allocator_with_fit_mode.h>
+#include <pp_allocator.h>
 #include <logger_guardant.h>
 #include <typename_holder.h>
+#include <cstddef>
+#include <iterator>
 #include <mutex>
 
-class allocator_red_black_tree final:
-    public smart_mem_resource,
-    public allocator_test_utils,
-    public allocator_with_fit_mode,
-    private logger_guardant,
-    private typename_holder
-{
+/**
+ * Blocks tile the whole pool and are linked to their physical neighbours.
+ * Free blocks additionally form a red-black tree keyed by (size, address),
+ * stored in their own headers, so allocation and deallocation with
+ * coalescing are O(log n) in the number of free blocks.
+ */
+class allocator_red_black_tree final : public smart_mem_resource,
+                                       public allocator_test_utils,
+                                       public allocator_with_fit_mode,
+                                       private logger_guardant,
+                                       private typename_holder {
+
+  private:
+    enum class block_color : unsigned char { RED, BLACK };
+
+    struct block_data {
+        bool occupied : 4;
+        block_color color : 4;
+    };
 
-private:
+    /** Physical neighbours, a block spans up to `next_` or the pool end */
+    struct block_metadata {
+        block_data data_;
 
-    enum class block_color : unsigned char
-    { RED, BLACK };
+        block_metadata *prev_;
+        block_metadata *next_;
+    };
 
-    struct block_data
-    {
-        bool occupied : 4;
-        block_color color : 4;
+    struct free_block_metadata : block_metadata {
+        free_block_metadata *parent_;
+        free_block_metadata *left_;
+        free_block_metadata *right_;
+    };
+
+    struct alignas(std::max_align_t) allocator_metadata {
+        logger *logger_;
+
+        memory_resource *allocator_;
+
+        fit_mode fit_mode_;
+
+        size_t mem_size_;
+
+        std::mutex mutex_;
+
+        free_block_metadata *root_;
+
+        std::byte *pool_start() noexcept {
+            return reinterpret_cast<std::byte *>(this) +
+                   allocator_metadata_size;
+        }
+
+        const std::byte *pool_start() const noexcept {
+            return reinterpret_cast<const std::byte *>(this) +
+                   allocator_metadata_size;
+        }
+
+        const std::byte *allocator_end() const noexcept {
+            return pool_start() + mem_size_;
+        }
     };
 
     void *_trusted_memory;
 
-    static constexpr const size_t allocator_metadata_size = sizeof(logger*) + sizeof(allocator_dbg_helper*) + sizeof(fit_mode) + sizeof(size_t) + sizeof(std::mutex) + sizeof(void*);
-    static constexpr const size_t occupied_block_metadata_size = sizeof(block_data) + 3 * sizeof(void*);
-    static constexpr const size_t free_block_metadata_size = sizeof(block_data) + 5 * sizeof(void*);
+    /** Block sizes are kept multiples of it */
+    static constexpr const size_t block_granularity =
+        alignof(std::max_align_t);
 
-public:
-    
+    /**
+     * The pool starts this far past an aligned address, so that every header
+     * ends and every payload starts on one
+     */
+    static constexpr const size_t pool_offset =
+        (block_granularity - sizeof(block_metadata) % block_granularity) %
+        block_granularity;
+
+    static constexpr const size_t allocator_metadata_size =
+        sizeof(allocator_metadata) + pool_offset;
+    static constexpr const size_t occupied_block_metadata_size =
+        sizeof(block_metadata);
+    static constexpr const size_t free_block_metadata_size =
+        sizeof(free_block_metadata);
+
+    static_assert(free_block_metadata_size % block_granularity == 0);
+
+  public:
     ~allocator_red_black_tree() override;
-    
-    allocator_red_black_tree(
-        allocator_red_black_tree const &other);
-    
-    allocator_red_black_tree &operator=(
-        allocator_red_black_tree const &other);
-    
-    allocator_red_black_tree(
-        allocator_red_black_tree &&other) noexcept;
-    
-    allocator_red_black_tree &operator=(
-        allocator_red_black_tree &&other) noexcept;
-
-public:
-    
+
+    allocator_red_black_tree(allocator_red_black_tree const &other) = delete;
+
+    allocator_red_black_tree &
+    operator=(allocator_red_black_tree const &other) = delete;
+
+    allocator_red_black_tree(allocator_red_black_tree &&other) noexcept;
+
+    allocator_red_black_tree &
+    operator=(allocator_red_black_tree &&other) noexcept;
+
+  public:
     explicit allocator_red_black_tree(
-            size_t space_size,
-            std::pmr::memory_resource *parent_allocator = nullptr,
-            logger *logger = nullptr,
-            allocator_with_fit_mode::fit_mode allocate_fit_mode = allocator_with_fit_mode::fit_mode::first_fit);
-
-public:
-    
-    [[nodiscard]] void *do_allocate_sm(
-        size_t size) override;
-    
-    void do_deallocate_sm(
-        void *at) override;
-
-    bool do_is_equal(const std::pmr::memory_resource&) const noexcept override;
-
-    std::vector<allocator_test_utils::block_info> get_blocks_info() const override;
-    
+        size_t space_size,
+        std::pmr::memory_resource *parent_allocator = nullptr,
+        logger *logger = nullptr,
+        allocator_with_fit_mode::fit_mode allocate_fit_mode =
+            allocator_with_fit_mode::fit_mode::first_fit);
+
+  public:
+    /**
+     * Best fit takes the smallest fitting block, worst fit the largest one
+     * and first fit the first fitting block met on the way down from the
+     * root. Each is a single O(log n) descent.
+     */
+    [[nodiscard]] void *do_allocate_sm(size_t size) override;
+
+    void do_deallocate_sm(void *at) override;
+
+    bool
+    do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    std::vector<allocator_test_utils::block_info>
+    get_blocks_info() const override;
+
     inline void set_fit_mode(allocator_with_fit_mode::fit_mode mode) override;
 
     inline logger *get_logger() const override;
 
-private:
-
-    std::vector<allocator_test_utils::block_info> get_blocks_info_inner() const override;
+  private:
+    std::vector<allocator_test_utils::block_info>
+    get_blocks_info_inner() const override;
 
     inline std::string get_typename() const noexcept override;
 
-    class rb_iterator
-    {
-        void* _block_ptr;
-        void* _trusted;
+    inline allocator_metadata &get_allocator_metadata() const noexcept;
+
+    inline size_t get_block_size(const block_metadata *block) const noexcept;
+
+    inline size_t get_available_memory() const noexcept;
+
+    inline bool is_less(const free_block_metadata *left,
+                        const free_block_metadata *right) const noexcept;
 
-    public:
+    inline free_block_metadata *get_block_first_fit(size_t size) const noexcept;
 
+    inline free_block_metadata *get_block_best_fit(size_t size) const noexcept;
+
+    inline free_block_metadata *get_block_worst_fit(size_t size) const noexcept;
+
+    void tree_insert(free_block_metadata *node) noexcept;
+
+    void tree_erase(free_block_metadata *node) noexcept;
+
+    void rotate_left(free_block_metadata *node) noexcept;
+
+    void rotate_right(free_block_metadata *node) noexcept;
+
+    void transplant(free_block_metadata *from,
+                    free_block_metadata *to) noexcept;
+
+    static inline bool is_red(const free_block_metadata *node) noexcept;
+
+    class rb_iterator {
+        void *_block_ptr;
+        void *_trusted;
+
+      public:
         using iterator_category = std::forward_iterator_tag;
-        using value_type = void*;
-        using reference = void*&;
-        using pointer = void**;
+        using value_type = void *;
+        using reference = void *&;
+        using pointer = void **;
         using difference_type = ptrdiff_t;
 
-        bool operator==(const rb_iterator&) const noexcept;
+        bool operator==(const rb_iterator &) const noexcept;
 
-        bool operator!=(const rb_iterator&) const noexcept;
+        bool operator!=(const rb_iterator &) const noexcept;
 
-        rb_iterator& operator++() & noexcept;
+        rb_iterator &operator++() & noexcept;
 
         rb_iterator operator++(int n);
 
         size_t size() const noexcept;
 
-        void* operator*() const noexcept;
+        void *operator*() const noexcept;
 
-        bool occupied()const noexcept;
+        bool occupied() const noexcept;
 
         rb_iterator();
 
-        rb_iterator(void* trusted);
+        rb_iterator(void *trusted);
     };
 
     friend class rb_iterator;
 
     rb_iterator begin() const noexcept;
-    rb_iterator end() const noexcept;
 
+    rb_iterator end() const noexcept;
 };
 
-#endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_RED_BLACK_TREE_H
\ No newline at end of file
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_RED_BLACK_TREE_H
@@ -1,140 +1,549 @@
-#include <not_implemented.h>
-
 #include "../include/allocator_red_black_tree.h"
+#include <format>
+
+allocator_red_black_tree::~allocator_red_black_tree() {
+    if (_trusted_memory == nullptr) {
+        return;
+    }
 
-allocator_red_black_tree::~allocator_red_black_tree()
-{
-    throw not_implemented("allocator_red_black_tree::~allocator_red_black_tree()", "your code should be here...");
+    auto &metadata = get_allocator_metadata();
+    metadata.mutex_.~mutex();
+    metadata.allocator_->deallocate(
+        _trusted_memory, allocator_metadata_size + metadata.mem_size_,
+        alignof(allocator_metadata));
 }
 
 allocator_red_black_tree::allocator_red_black_tree(
-    allocator_red_black_tree &&other) noexcept
-{
-    throw not_implemented("allocator_red_black_tree::allocator_red_black_tree(allocator_red_black_tree &&) noexcept", "your code should be here...");
+    allocator_red_black_tree &&other) noexcept {
+    _trusted_memory = std::exchange(other._trusted_memory, nullptr);
 }
 
-allocator_red_black_tree &allocator_red_black_tree::operator=(
-    allocator_red_black_tree &&other) noexcept
-{
-    throw not_implemented("allocator_red_black_tree &allocator_red_black_tree::operator=(allocator_red_black_tree &&) noexcept", "your code should be here...");
+allocator_red_black_tree &
+allocator_red_black_tree::operator=(allocator_red_black_tree &&other) noexcept {
+    if (this != &other) {
+        std::swap(_trusted_memory, other._trusted_memory);
+    }
+    return *this;
 }
 
 allocator_red_black_tree::allocator_red_black_tree(
-        size_t space_size,
-        std::pmr::memory_resource *parent_allocator,
-        logger *logger,
-        allocator_with_fit_mode::fit_mode allocate_fit_mode)
-{
-    throw not_implemented("allocator_red_black_tree::allocator_red_black_tree(size_t ,std::pmr::memory_resource *,logger *,allocator_with_fit_mode::fit_mode)", "your code should be here...");
+    size_t space_size, std::pmr::memory_resource *parent_allocator,
+    logger *logger, allocator_with_fit_mode::fit_mode allocate_fit_mode) {
+    if (space_size < free_block_metadata_size) {
+        throw std::logic_error(
+            "`space_size` is not enough to fit a single block");
+    }
+
+    const auto allocator = parent_allocator != nullptr
+                               ? parent_allocator
+                               : std::pmr::get_default_resource();
+
+    _trusted_memory = allocator->allocate(allocator_metadata_size + space_size,
+                                          alignof(allocator_metadata));
+
+    const auto metadata = static_cast<allocator_metadata *>(_trusted_memory);
+
+    metadata->logger_ = logger;
+    metadata->allocator_ = allocator;
+    metadata->fit_mode_ = allocate_fit_mode;
+    metadata->mem_size_ = space_size;
+    metadata->root_ = nullptr;
+
+    std::construct_at(&metadata->mutex_);
+
+    auto block = reinterpret_cast<free_block_metadata *>(metadata->pool_start());
+    block->prev_ = nullptr;
+    block->next_ = nullptr;
+    block->data_.occupied = false;
+    tree_insert(block);
+}
+
+bool allocator_red_black_tree::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+[[nodiscard]] void *allocator_red_black_tree::do_allocate_sm(size_t size) {
+    // a freed block must be able to hold the tree node again
+    const size_t total_size = std::max(
+        (size + occupied_block_metadata_size + block_granularity - 1) /
+            block_granularity * block_granularity,
+        free_block_metadata_size);
+
+    debug_with_guard(
+        [&] { return std::format("[*] allocating {} bytes", total_size); });
+
+    auto &metadata = get_allocator_metadata();
+
+    std::lock_guard lock(metadata.mutex_);
+
+    free_block_metadata *block = nullptr;
+
+    switch (metadata.fit_mode_) {
+    case fit_mode::first_fit:
+    case fit_mode::next_fit:
+        block = get_block_first_fit(total_size);
+        break;
+    case fit_mode::the_best_fit:
+        block = get_block_best_fit(total_size);
+        break;
+    case fit_mode::the_worst_fit:
+        block = get_block_worst_fit(total_size);
+        break;
+    }
+
+    if (block == nullptr) {
+        error_with_guard(
+            std::format("[!] out of memory: requested {} bytes", total_size));
+        throw std::bad_alloc();
+    }
+
+    tree_erase(block);
+
+    const size_t block_size = get_block_size(block);
+
+    if (block_size - total_size >= free_block_metadata_size) {
+        auto rest = reinterpret_cast<free_block_metadata *>(
+            reinterpret_cast<std::byte *>(block) + total_size);
+
+        rest->prev_ = block;
+        rest->next_ = block->next_;
+        rest->data_.occupied = false;
+
+        if (rest->next_ != nullptr) {
+            rest->next_->prev_ = rest;
+        }
+        block->next_ = rest;
+
+        tree_insert(rest);
+    } else {
+        warning_with_guard([&] {
+            return std::format("[*] changing block size to {} bytes",
+                               block_size);
+        });
+    }
+
+    block->data_.occupied = true;
+
+    void *user_data = reinterpret_cast<std::byte *>(block) +
+                      occupied_block_metadata_size;
+
+    debug_with_guard([&] {
+        return std::format("[+] allocated {} bytes at {:p}",
+                           get_block_size(block), user_data);
+    });
+    information_with_guard([this] {
+        return std::format("[*] available memory: {}", get_available_memory());
+    });
+    debug_with_guard([this] { return print_blocks(); });
+
+    return user_data;
+}
+
+void allocator_red_black_tree::do_deallocate_sm(void *at) {
+    debug_with_guard(
+        [at] { return std::format("[*] deallocating block {:p}", at); });
+
+    auto &metadata = get_allocator_metadata();
+
+    std::lock_guard lock(metadata.mutex_);
+
+    auto block = reinterpret_cast<block_metadata *>(
+        static_cast<std::byte *>(at) - occupied_block_metadata_size);
+
+    if (reinterpret_cast<std::byte *>(block) < metadata.pool_start() ||
+        reinterpret_cast<std::byte *>(block) >= metadata.allocator_end() ||
+        !block->data_.occupied) {
+        error_with_guard([at] {
+            return std::format(
+                "[!] block doesn't belong to this allocator: {:p}", at);
+        });
+        throw std::logic_error("unknown block");
+    }
+
+    debug_with_guard([&] {
+        return get_dump(static_cast<char *>(at),
+                        get_block_size(block) - occupied_block_metadata_size);
+    });
+
+    // neighbours leave the tree before their sizes change
+    if (block->next_ != nullptr && !block->next_->data_.occupied) {
+        auto next = static_cast<free_block_metadata *>(block->next_);
+        tree_erase(next);
+
+        block->next_ = next->next_;
+        if (block->next_ != nullptr) {
+            block->next_->prev_ = block;
+        }
+    }
+
+    if (block->prev_ != nullptr && !block->prev_->data_.occupied) {
+        auto prev = static_cast<free_block_metadata *>(block->prev_);
+        tree_erase(prev);
+
+        prev->next_ = block->next_;
+        if (prev->next_ != nullptr) {
+            prev->next_->prev_ = prev;
+        }
+        block = prev;
+    }
+
+    block->data_.occupied = false;
+    tree_insert(static_cast<free_block_metadata *>(block));
+
+    debug_with_guard("[+] block deallocated successfully");
+    information_with_guard([this] {
+        return std::format("[*] available memory: {}", get_available_memory());
+    });
+    debug_with_guard([this] { return print_blocks(); });
+}
+
+inline void
+allocator_red_black_tree::set_fit_mode(allocator_with_fit_mode::fit_mode mode) {
+    auto &metadata = get_allocator_metadata();
+    std::lock_guard lock(metadata.mutex_);
+    metadata.fit_mode_ = mode;
+}
+
+std::vector<allocator_test_utils::block_info>
+allocator_red_black_tree::get_blocks_info() const {
+    auto &metadata = get_allocator_metadata();
+    std::lock_guard lock(metadata.mutex_);
+    return get_blocks_info_inner();
+}
+
+inline logger *allocator_red_black_tree::get_logger() const {
+    return get_allocator_metadata().logger_;
+}
+
+std::vector<allocator_test_utils::block_info>
+allocator_red_black_tree::get_blocks_info_inner() const {
+    std::vector<allocator_test_utils::block_info> blocks;
+
+    for (auto it = begin(); it != end(); ++it) {
+        blocks.push_back({it.size(), it.occupied()});
+    }
+
+    return blocks;
 }
 
-allocator_red_black_tree::allocator_red_black_tree(const allocator_red_black_tree &other)
-{
-    throw not_implemented("allocator_red_black_tree::allocator_red_black_tree(const allocator_red_black_tree &other)", "your code should be here...");
+inline std::string allocator_red_black_tree::get_typename() const noexcept {
+    return "allocator_red_black_tree";
 }
 
-allocator_red_black_tree &allocator_red_black_tree::operator=(const allocator_red_black_tree &other)
-{
-    throw not_implemented("allocator_red_black_tree &allocator_red_black_tree::operator=(const allocator_red_black_tree &other)", "your code should be here...");
+allocator_red_black_tree::allocator_metadata &
+allocator_red_black_tree::get_allocator_metadata() const noexcept {
+    return *static_cast<allocator_metadata *>(_trusted_memory);
 }
 
-bool allocator_red_black_tree::do_is_equal(const std::pmr::memory_resource &other) const noexcept
-{
-    throw not_implemented("bool allocator_red_black_tree::do_is_equal(const std::pmr::memory_resource &other) const noexcept", "your code should be here...");
+size_t allocator_red_black_tree::get_block_size(
+    const block_metadata *block) const noexcept {
+    const std::byte *block_end =
+        block->next_ != nullptr
+            ? reinterpret_cast<const std::byte *>(block->next_)
+            : get_allocator_metadata().allocator_end();
+
+    return block_end - reinterpret_cast<const std::byte *>(block);
 }
 
-[[nodiscard]] void *allocator_red_black_tree::do_allocate_sm(
-    size_t size)
-{
-    throw not_implemented("[[nodiscard]] void *allocator_red_black_tree::do_allocate_sm(size_t)", "your code should be here...");
+size_t allocator_red_black_tree::get_available_memory() const noexcept {
+    size_t available_memory = 0;
+
+    for (auto it = begin(); it != end(); ++it) {
+        if (!it.occupied()) {
+            available_memory += it.size();
+        }
+    }
+
+    return available_memory;
 }
 
+bool allocator_red_black_tree::is_less(
+    const free_block_metadata *left,
+    const free_block_metadata *right) const noexcept {
+    const size_t left_size = get_block_size(left);
+    const size_t right_size = get_block_size(right);
 
-void allocator_red_black_tree::do_deallocate_sm(
-    void *at)
-{
-    throw not_implemented("void allocator_red_black_tree::do_deallocate_sm(void *)", "your code should be here...");
+    return left_size < right_size || (left_size == right_size && left < right);
 }
 
-void allocator_red_black_tree::set_fit_mode(allocator_with_fit_mode::fit_mode mode)
-{
-    throw not_implemented("void allocator_red_black_tree::set_fit_mode(allocator_with_fit_mode::fit_mode)", "your code should be here...");
+allocator_red_black_tree::free_block_metadata *
+allocator_red_black_tree::get_block_first_fit(size_t size) const noexcept {
+    auto node = get_allocator_metadata().root_;
+
+    while (node != nullptr && get_block_size(node) < size) {
+        node = node->right_;
+    }
+
+    return node;
 }
 
+allocator_red_black_tree::free_block_metadata *
+allocator_red_black_tree::get_block_best_fit(size_t size) const noexcept {
+    free_block_metadata *best = nullptr;
+    auto node = get_allocator_metadata().root_;
+
+    while (node != nullptr) {
+        if (get_block_size(node) >= size) {
+            best = node;
+            node = node->left_;
+        } else {
+            node = node->right_;
+        }
+    }
 
-std::vector<allocator_test_utils::block_info> allocator_red_black_tree::get_blocks_info() const
-{
-    throw not_implemented("std::vector<allocator_test_utils::block_info> allocator_red_black_tree::get_blocks_info() const", "your code should be here...");
+    return best;
 }
 
-inline logger *allocator_red_black_tree::get_logger() const
-{
-    throw not_implemented("inline logger *allocator_red_black_tree::get_logger() const", "your code should be here...");
+allocator_red_black_tree::free_block_metadata *
+allocator_red_black_tree::get_block_worst_fit(size_t size) const noexcept {
+    auto node = get_allocator_metadata().root_;
+
+    if (node == nullptr) {
+        return nullptr;
+    }
+
+    while (node->right_ != nullptr) {
+        node = node->right_;
+    }
+
+    return get_block_size(node) >= size ? node : nullptr;
 }
 
-std::vector<allocator_test_utils::block_info> allocator_red_black_tree::get_blocks_info_inner() const
-{
-    throw not_implemented("std::vector<allocator_test_utils::block_info> allocator_red_black_tree::get_blocks_info_inner() const", "your code should be here...");
+bool allocator_red_black_tree::is_red(
+    const free_block_metadata *node) noexcept {
+    return node != nullptr && node->data_.color == block_color::RED;
 }
 
-inline std::string allocator_red_black_tree::get_typename() const noexcept
-{
-    throw not_implemented("inline std::string allocator_red_black_tree::get_typename() const noexcept", "your code should be here...");
+void allocator_red_black_tree::rotate_left(free_block_metadata *node) noexcept {
+    auto child = node->right_;
+
+    node->right_ = child->left_;
+    if (child->left_ != nullptr) {
+        child->left_->parent_ = node;
+    }
+
+    transplant(node, child);
+
+    child->left_ = node;
+    node->parent_ = child;
+}
+
+void allocator_red_black_tree::rotate_right(
+    free_block_metadata *node) noexcept {
+    auto child = node->left_;
+
+    node->left_ = child->right_;
+    if (child->right_ != nullptr) {
+        child->right_->parent_ = node;
+    }
+
+    transplant(node, child);
+
+    child->right_ = node;
+    node->parent_ = child;
+}
+
+void allocator_red_black_tree::transplant(free_block_metadata *from,
+                                          free_block_metadata *to) noexcept {
+    auto parent = from->parent_;
+
+    if (parent == nullptr) {
+        get_allocator_metadata().root_ = to;
+    } else if (parent->left_ == from) {
+        parent->left_ = to;
+    } else {
+        parent->right_ = to;
+    }
+
+    if (to != nullptr) {
+        to->parent_ = parent;
+    }
+}
+
+void allocator_red_black_tree::tree_insert(free_block_metadata *node) noexcept {
+    auto &root = get_allocator_metadata().root_;
+
+    free_block_metadata *parent = nullptr;
+    auto *link = &root;
+
+    while (*link != nullptr) {
+        parent = *link;
+        link = is_less(node, parent) ? &parent->left_ : &parent->right_;
+    }
+
+    *link = node;
+    node->parent_ = parent;
+    node->left_ = nullptr;
+    node->right_ = nullptr;
+    node->data_.color = block_color::RED;
+
+    while (is_red(node->parent_)) {
+        auto parent_node = node->parent_;
+        auto grandparent = parent_node->parent_;
+        const bool is_left = parent_node == grandparent->left_;
+        auto uncle = is_left ? grandparent->right_ : grandparent->left_;
+
+        if (is_red(uncle)) {
+            parent_node->data_.color = block_color::BLACK;
+            uncle->data_.color = block_color::BLACK;
+            grandparent->data_.color = block_color::RED;
+            node = grandparent;
+            continue;
+        }
+
+        if (node == (is_left ? parent_node->right_ : parent_node->left_)) {
+            node = parent_node;
+            is_left ? rotate_left(node) : rotate_right(node);
+            parent_node = node->parent_;
+        }
+
+        parent_node->data_.color = block_color::BLACK;
+        grandparent->data_.color = block_color::RED;
+        is_left ? rotate_right(grandparent) : rotate_left(grandparent);
+    }
+
+    root->data_.color = block_color::BLACK;
 }
 
+void allocator_red_black_tree::tree_erase(free_block_metadata *node) noexcept {
+    auto &root = get_allocator_metadata().root_;
+
+    free_block_metadata *child;
+    free_block_metadata *child_parent;
+    block_color erased_color = node->data_.color;
+
+    if (node->left_ == nullptr || node->right_ == nullptr) {
+        child = node->left_ != nullptr ? node->left_ : node->right_;
+        child_parent = node->parent_;
+        transplant(node, child);
+    } else {
+        auto successor = node->right_;
+        while (successor->left_ != nullptr) {
+            successor = successor->left_;
+        }
+
+        erased_color = successor->data_.color;
+        child = successor->right_;
+
+        if (successor->parent_ == node) {
+            child_parent = successor;
+        } else {
+            child_parent = successor->parent_;
+            transplant(successor, successor->right_);
+            successor->right_ = node->right_;
+            successor->right_->parent_ = successor;
+        }
+
+        transplant(node, successor);
+        successor->left_ = node->left_;
+        successor->left_->parent_ = successor;
+        successor->data_.color = node->data_.color;
+    }
+
+    if (erased_color == block_color::RED) {
+        return;
+    }
 
-allocator_red_black_tree::rb_iterator allocator_red_black_tree::begin() const noexcept
-{
-    throw not_implemented("allocator_red_black_tree::rb_iterator allocator_red_black_tree::begin() const noexcept", "your code should be here...");
+    // `child` carries an extra black until it is absorbed or reaches the root
+    while (child != root && !is_red(child)) {
+        const bool is_left = child == child_parent->left_;
+        auto sibling = is_left ? child_parent->right_ : child_parent->left_;
+
+        if (is_red(sibling)) {
+            sibling->data_.color = block_color::BLACK;
+            child_parent->data_.color = block_color::RED;
+            is_left ? rotate_left(child_parent) : rotate_right(child_parent);
+            sibling = is_left ? child_parent->right_ : child_parent->left_;
+        }
+
+        auto near_nephew = is_left ? sibling->left_ : sibling->right_;
+        auto far_nephew = is_left ? sibling->right_ : sibling->left_;
+
+        if (!is_red(near_nephew) && !is_red(far_nephew)) {
+            sibling->data_.color = block_color::RED;
+            child = child_parent;
+            child_parent = child->parent_;
+            continue;
+        }
+
+        if (!is_red(far_nephew)) {
+            near_nephew->data_.color = block_color::BLACK;
+            sibling->data_.color = block_color::RED;
+            is_left ? rotate_right(sibling) : rotate_left(sibling);
+            sibling = is_left ? child_parent->right_ : child_parent->left_;
+            far_nephew = is_left ? sibling->right_ : sibling->left_;
+        }
+
+        sibling->data_.color = child_parent->data_.color;
+        child_parent->data_.color = block_color::BLACK;
+        far_nephew->data_.color = block_color::BLACK;
+        is_left ? rotate_left(child_parent) : rotate_right(child_parent);
+        child = root;
+    }
+
+    if (child != nullptr) {
+        child->data_.color = block_color::BLACK;
+    }
 }
 
-allocator_red_black_tree::rb_iterator allocator_red_black_tree::end() const noexcept
-{
-    throw not_implemented("allocator_red_black_tree::rb_iterator allocator_red_black_tree::end() const noexcept", "your code should be here...");
+allocator_red_black_tree::rb_iterator
+allocator_red_black_tree::begin() const noexcept {
+    return {_trusted_memory};
 }
 
+allocator_red_black_tree::rb_iterator
+allocator_red_black_tree::end() const noexcept {
+    return {};
+}
 
-bool allocator_red_black_tree::rb_iterator::operator==(const allocator_red_black_tree::rb_iterator &other) const noexcept
-{
-    throw not_implemented("bool allocator_red_black_tree::rb_iterator::operator==(const allocator_red_black_tree::rb_iterator &) const noexcept", "your code should be here...");
+bool allocator_red_black_tree::rb_iterator::operator==(
+    const allocator_red_black_tree::rb_iterator &other) const noexcept {
+    return _block_ptr == other._block_ptr;
 }
 
-bool allocator_red_black_tree::rb_iterator::operator!=(const allocator_red_black_tree::rb_iterator &other) const noexcept
-{
-    throw not_implemented("bool allocator_red_black_tree::rb_iterator::operator!=(const allocator_red_black_tree::rb_iterator &) const noexcept", "your code should be here...");
+bool allocator_red_black_tree::rb_iterator::operator!=(
+    const allocator_red_black_tree::rb_iterator &other) const noexcept {
+    return !(*this == other);
 }
 
-allocator_red_black_tree::rb_iterator &allocator_red_black_tree::rb_iterator::operator++() & noexcept
-{
-    throw not_implemented("allocator_red_black_tree::rb_iterator &allocator_red_black_tree::rb_iterator::operator++() & noexcept", "your code should be here...");
+allocator_red_black_tree::rb_iterator &
+allocator_red_black_tree::rb_iterator::operator++() & noexcept {
+    _block_ptr = static_cast<block_metadata *>(_block_ptr)->next_;
+    return *this;
 }
 
-allocator_red_black_tree::rb_iterator allocator_red_black_tree::rb_iterator::operator++(int n)
-{
-    throw not_implemented("allocator_red_black_tree::rb_iterator allocator_red_black_tree::rb_iterator::operator++(int)", "your code should be here...");
+allocator_red_black_tree::rb_iterator
+allocator_red_black_tree::rb_iterator::operator++(int) {
+    auto previous = *this;
+    ++*this;
+    return previous;
 }
 
-size_t allocator_red_black_tree::rb_iterator::size() const noexcept
-{
-    throw not_implemented("size_t allocator_red_black_tree::rb_iterator::size() const noexcept", "your code should be here...");
+size_t allocator_red_black_tree::rb_iterator::size() const noexcept {
+    const auto block = static_cast<const block_metadata *>(_block_ptr);
+    const std::byte *block_end =
+        block->next_ != nullptr
+            ? reinterpret_cast<const std::byte *>(block->next_)
+            : static_cast<const allocator_metadata *>(_trusted)
+                  ->allocator_end();
+
+    return block_end - reinterpret_cast<const std::byte *>(block);
 }
 
-void *allocator_red_black_tree::rb_iterator::operator*() const noexcept
-{
-    throw not_implemented("void *allocator_red_black_tree::rb_iterator::operator*() const noexcept", "your code should be here...");
+void *allocator_red_black_tree::rb_iterator::operator*() const noexcept {
+    return _block_ptr;
 }
 
-allocator_red_black_tree::rb_iterator::rb_iterator()
-{
-    throw not_implemented("allocator_red_black_tree::rb_iterator::rb_iterator()", "your code should be here...");
+bool allocator_red_black_tree::rb_iterator::occupied() const noexcept {
+    return static_cast<const block_metadata *>(_block_ptr)->data_.occupied;
 }
 
-allocator_red_black_tree::rb_iterator::rb_iterator(void *trusted)
-{
-    throw not_implemented("allocator_red_black_tree::rb_iterator::rb_iterator(void *)", "your code should be here...");
+allocator_red_black_tree::rb_iterator::rb_iterator()
+    : _block_ptr(nullptr), _trusted(nullptr) {
 }
 
-bool allocator_red_black_tree::rb_iterator::occupied() const noexcept
-{
-    throw not_implemented("bool allocator_red_black_tree::rb_iterator::occupied() const noexcept", "your code should be here...");
+allocator_red_black_tree::rb_iterator::rb_iterator(void *trusted)
+    : _block_ptr(static_cast<allocator_metadata *>(trusted)->pool_start()),
+      _trusted(trusted) {
 }
@@ -3,6 +3,7 @@
 #include <logger_builder.h>
 #include <client_logger_builder.h>
 #include <list>
+#include <cstring>
 #include <allocator_red_black_tree.h>
 
 logger *create_logger(
@@ -220,6 +221,134 @@ TEST(allocatorRBTPositiveTests, test7)
 }
 
 
+TEST(allocatorRBTPositiveTests, test8)
+{
+	std::unique_ptr<smart_mem_resource> allocator(new allocator_red_black_tree(3000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::the_best_fit));
+	auto *fit_mode_holder = dynamic_cast<allocator_with_fit_mode *>(allocator.get());
+	auto *test_utils = dynamic_cast<allocator_test_utils *>(allocator.get());
+
+	void *first = allocator->allocate(400);
+	void *second = allocator->allocate(80);
+	void *third = allocator->allocate(200);
+	void *fourth = allocator->allocate(80);
+
+	allocator->deallocate(first, 1);
+	allocator->deallocate(third, 1);
+
+	first = allocator->allocate(150);
+
+	std::vector<allocator_test_utils::block_info> expected_blocks_state
+		{
+			{ .block_size = 432, .is_block_occupied = false },
+			{ .block_size = 112, .is_block_occupied = true },
+			{ .block_size = 176, .is_block_occupied = true },
+			{ .block_size = 48, .is_block_occupied = false },
+			{ .block_size = 112, .is_block_occupied = true },
+			{ .block_size = 3000 - 432 - 112 - 224 - 112, .is_block_occupied = false }
+		};
+	ASSERT_EQ(test_utils->get_blocks_info(), expected_blocks_state);
+
+	fit_mode_holder->set_fit_mode(allocator_with_fit_mode::fit_mode::the_worst_fit);
+	third = allocator->allocate(150);
+	ASSERT_EQ(test_utils->get_blocks_info()[5], (allocator_test_utils::block_info{ .block_size = 176, .is_block_occupied = true }));
+
+	allocator->deallocate(second, 1);
+	allocator->deallocate(fourth, 1);
+	allocator->deallocate(first, 1);
+	allocator->deallocate(third, 1);
+
+	ASSERT_EQ(test_utils->get_blocks_info(), (std::vector<allocator_test_utils::block_info>{ { .block_size = 3000, .is_block_occupied = false } }));
+}
+
+TEST(allocatorRBTPositiveTests, test9)
+{
+	std::unique_ptr<smart_mem_resource> allocator(new allocator_red_black_tree(100'000));
+	auto *fit_mode_holder = dynamic_cast<allocator_with_fit_mode *>(allocator.get());
+	auto *test_utils = dynamic_cast<allocator_test_utils *>(allocator.get());
+
+	std::list<std::pair<unsigned char *, size_t>> allocated_blocks;
+	srand(0);
+
+	for (int i = 0; i < 20000; i++)
+	{
+		if (rand() % 3 != 0 || allocated_blocks.empty())
+		{
+			fit_mode_holder->set_fit_mode(static_cast<allocator_with_fit_mode::fit_mode>(rand() % 3));
+			size_t size = rand() % 500;
+
+			try
+			{
+				auto block = reinterpret_cast<unsigned char *>(allocator->allocate(size));
+				ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % alignof(std::max_align_t), 0);
+				memset(block, static_cast<unsigned char>(size), size);
+				allocated_blocks.emplace_back(block, size);
+			}
+			catch (std::bad_alloc const &)
+			{
+			}
+		}
+		else
+		{
+			auto it = allocated_blocks.begin();
+			std::advance(it, rand() % allocated_blocks.size());
+			for (size_t j = 0; j < it->second; j++)
+			{
+				ASSERT_EQ(it->first[j], static_cast<unsigned char>(it->second));
+			}
+			allocator->deallocate(it->first, 1);
+			allocated_blocks.erase(it);
+		}
+
+		auto blocks = test_utils->get_blocks_info();
+		for (size_t j = 1; j < blocks.size(); j++)
+		{
+			ASSERT_TRUE(blocks[j - 1].is_block_occupied || blocks[j].is_block_occupied);
+		}
+	}
+
+	for (auto const &[block, size]: allocated_blocks)
+	{
+		allocator->deallocate(block, 1);
+	}
+
+	ASSERT_EQ(test_utils->get_blocks_info(), (std::vector<allocator_test_utils::block_info>{ { .block_size = 100'000, .is_block_occupied = false } }));
+}
+
+TEST(allocatorRBTPositiveTests, test10)
+{
+	allocator_red_black_tree allocator(1 << 16);
+	std::vector<void *> blocks;
+
+	// odd sizes in between must not shift the blocks after them
+	for (size_t size = 1; size < 40; ++size)
+	{
+		blocks.push_back(allocator.allocate(size, 1));
+
+		void *aligned_8 = allocator.allocate(16, 8);
+		void *aligned_16 = allocator.allocate(32, 16);
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned_8) % 8, 0);
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned_16) % 16, 0);
+
+		blocks.push_back(aligned_8);
+		blocks.push_back(aligned_16);
+	}
+
+	for (auto block: blocks)
+	{
+		allocator.deallocate(block, 1);
+	}
+
+	ASSERT_EQ(allocator.get_blocks_info().size(), 1);
+}
+
+TEST(allocatorRBTFalsePositiveTests, test1)
+{
+	ASSERT_THROW(new allocator_red_black_tree(16), std::logic_error);
+
+	std::unique_ptr<smart_mem_resource> allocator(new allocator_red_black_tree(1000));
+	ASSERT_THROW(static_cast<void>(allocator->allocate(1000)), std::bad_alloc);
+}
+
 int main(
     int argc,
     char *argv[])
@@ -0,0 +1,89 @@
+#include <allocator_global_heap.h>
+#include <allocator_slab.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t operations_per_thread = 1'000'000;
+    constexpr size_t live_blocks_per_thread = 256;
+
+    // same size as a binary search tree node holding a pair of ints
+    constexpr size_t node_size = 40;
+
+    // each thread keeps a window of live nodes and replaces a random one per step
+    double measure(std::pmr::memory_resource &resource, size_t threads_count)
+    {
+        std::vector<std::thread> threads;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (size_t t = 0; t < threads_count; ++t)
+        {
+            threads.emplace_back([&resource, t]()
+            {
+                std::mt19937 gen(t);
+                std::uniform_int_distribution<size_t> slot_distribution(0, live_blocks_per_thread - 1);
+
+                std::vector<void *> blocks(live_blocks_per_thread, nullptr);
+
+                for (size_t i = 0; i < operations_per_thread; ++i)
+                {
+                    auto &slot = blocks[slot_distribution(gen)];
+
+                    if (slot != nullptr)
+                    {
+                        resource.deallocate(slot, node_size, alignof(void *));
+                    }
+                    slot = resource.allocate(node_size, alignof(void *));
+                }
+
+                for (auto block: blocks)
+                {
+                    if (block != nullptr)
+                    {
+                        resource.deallocate(block, node_size, alignof(void *));
+                    }
+                }
+            });
+        }
+
+        for (auto &thread: threads)
+        {
+            thread.join();
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        return 2.0 * operations_per_thread * threads_count / elapsed.count();
+    }
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    size_t max_threads = argc > 1
+        ? std::stoul(argv[1])
+        : std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << std::setw(8) << "threads"
+              << std::setw(20) << "glbl_hp ops/s"
+              << std::setw(20) << "slab ops/s" << std::endl;
+
+    for (size_t threads_count = 1; threads_count <= max_threads; threads_count *= 2)
+    {
+        allocator_global_heap global_heap;
+        allocator_slab slab(node_size, 1024);
+
+        std::cout << std::setw(8) << threads_count
+                  << std::setw(20) << std::fixed << std::setprecision(0) << measure(global_heap, threads_count)
+                  << std::setw(20) << measure(slab, threads_count) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_SLAB_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_SLAB_H
+
+#include <logger_guardant.h>
+#include <pp_allocator.h>
+#include <typename_holder.h>
+#include <cstddef>
+#include <memory>
+
+/**
+ * Fixed-size object allocator for node-based containers.
+ *
+ * Slabs of `objects_per_slab` slots are taken from the parent allocator and
+ * never given back before destruction. Free slots form a Treiber stack whose
+ * head carries a modification tag next to the pointer, so allocation and
+ * deallocation are a single compare-and-swap each and never block. Only
+ * carving a new slab takes a lock.
+ *
+ * Slots are aligned to `object_alignment`, the slot size is rounded up to
+ * it. The default serves plain pmr `allocate(n)` calls; node containers
+ * allocating through `pp_allocator<T>` ask for `alignof(T)` only and may pass
+ * that to pack slots denser. Requests larger than the slot or needing more
+ * alignment than the slots have throw `std::bad_alloc`. Pointers are not
+ * validated on deallocation.
+ */
+class allocator_slab final : public smart_mem_resource,
+                             private logger_guardant,
+                             private typename_holder {
+
+  public:
+    struct slab_state;
+
+  private:
+    std::unique_ptr<slab_state> _state;
+
+  public:
+    explicit allocator_slab(
+        size_t object_size, size_t objects_per_slab = 256,
+        std::pmr::memory_resource *parent_allocator = nullptr,
+        logger *logger = nullptr,
+        size_t object_alignment = alignof(std::max_align_t));
+
+    ~allocator_slab() override;
+
+    allocator_slab(allocator_slab const &other) = delete;
+
+    allocator_slab &operator=(allocator_slab const &other) = delete;
+
+    allocator_slab(allocator_slab &&other) noexcept;
+
+    allocator_slab &operator=(allocator_slab &&other) noexcept;
+
+  public:
+    [[nodiscard]] void *do_allocate_sm(size_t size) override;
+
+    [[nodiscard]] void *do_allocate_sm(size_t size, size_t alignment) override;
+
+    void do_deallocate_sm(void *at) override;
+
+    bool
+    do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    /**
+     * Bytes every slot takes, `object_size` rounded up to the slot alignment,
+     * which is at least pointer size
+     */
+    size_t slot_size() const noexcept;
+
+  private:
+    void *allocate_from_new_slab();
+
+    inline logger *get_logger() const override;
+
+    inline std::string get_typename() const noexcept override;
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_SLAB_H
@@ -0,0 +1,243 @@
+#include "../include/allocator_slab.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <format>
+#include <mutex>
+
+namespace {
+
+struct free_slot {
+    std::atomic<free_slot *> next_;
+};
+
+// user-space addresses fit in the low 48 bits on the 64-bit targets we build
+// for, the upper bits of the head count its modifications against ABA
+constexpr std::uint64_t slot_pointer_mask = (std::uint64_t{1} << 48) - 1;
+constexpr std::uint64_t head_tag_increment = slot_pointer_mask + 1;
+
+static_assert(sizeof(void *) == sizeof(std::uint64_t),
+              "tagged free list heads need 64-bit pointers");
+
+free_slot *get_slot(std::uint64_t head) noexcept {
+    return reinterpret_cast<free_slot *>(head & slot_pointer_mask);
+}
+
+std::uint64_t make_head(free_slot *slot, std::uint64_t previous) noexcept {
+    return reinterpret_cast<std::uint64_t>(slot) |
+           ((previous & ~slot_pointer_mask) + head_tag_increment);
+}
+
+// chains the slabs for destruction, padded so that slots stay aligned
+struct slab_header {
+    slab_header *next_;
+    size_t size_;
+};
+
+constexpr size_t slab_header_size = alignof(std::max_align_t);
+
+static_assert(sizeof(slab_header) <= slab_header_size);
+
+} // namespace
+
+struct allocator_slab::slab_state {
+    // the only contended word, kept away from the read-mostly fields
+    alignas(64) std::atomic<std::uint64_t> head_{0};
+
+    alignas(64) std::pmr::memory_resource *parent_;
+    logger *logger_;
+    size_t slot_size_;
+    size_t slot_alignment_;
+    size_t objects_per_slab_;
+
+    // guards growth only, never taken while the free list has slots
+    std::mutex mutex_;
+    slab_header *slabs_ = nullptr;
+
+    size_t slab_alignment() const noexcept {
+        return std::max(alignof(std::max_align_t), slot_alignment_);
+    }
+
+    /** Offset of the first slot, the header padded to the slot alignment */
+    size_t slots_offset() const noexcept {
+        return std::max(slab_header_size, slot_alignment_);
+    }
+
+    free_slot *pop() noexcept {
+        auto head = head_.load(std::memory_order_acquire);
+
+        // slabs outlive every slot, so a stale `next_` read is harmless: the
+        // tag makes the exchange fail whenever the head moved meanwhile
+        while (get_slot(head) != nullptr) {
+            const auto next =
+                get_slot(head)->next_.load(std::memory_order_relaxed);
+
+            if (head_.compare_exchange_weak(head, make_head(next, head),
+                                            std::memory_order_acquire,
+                                            std::memory_order_acquire)) {
+                return get_slot(head);
+            }
+        }
+
+        return nullptr;
+    }
+
+    /** Pushes the chain `first` ... `last` linked through `next_` */
+    void push(free_slot *first, free_slot *last) noexcept {
+        auto head = head_.load(std::memory_order_relaxed);
+
+        do {
+            last->next_.store(get_slot(head), std::memory_order_relaxed);
+        } while (!head_.compare_exchange_weak(head, make_head(first, head),
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+    }
+};
+
+allocator_slab::allocator_slab(size_t object_size, size_t objects_per_slab,
+                               std::pmr::memory_resource *parent_allocator,
+                               logger *logger, size_t object_alignment)
+    : _state(std::make_unique<slab_state>()) {
+    if (object_size == 0 || objects_per_slab == 0) {
+        throw std::logic_error(
+            "`object_size` and `objects_per_slab` must be positive");
+    }
+
+    if (!std::has_single_bit(object_alignment)) {
+        throw std::logic_error("`object_alignment` must be a power of two");
+    }
+
+    // slot offsets are multiples of the slot size, so it carries the alignment
+    const size_t slot_alignment =
+        std::max(object_alignment, alignof(free_slot));
+    const size_t slot_size =
+        (std::max(object_size, sizeof(free_slot)) + slot_alignment - 1) /
+        slot_alignment * slot_alignment;
+
+    _state->parent_ = parent_allocator != nullptr
+                          ? parent_allocator
+                          : std::pmr::get_default_resource();
+    _state->logger_ = logger;
+    _state->slot_size_ = slot_size;
+    _state->slot_alignment_ = slot_alignment;
+    _state->objects_per_slab_ = objects_per_slab;
+}
+
+allocator_slab::~allocator_slab() {
+    if (!_state) {
+        return;
+    }
+
+    for (auto slab = _state->slabs_; slab != nullptr;) {
+        const auto next = slab->next_;
+        _state->parent_->deallocate(slab, slab->size_,
+                                    _state->slab_alignment());
+        slab = next;
+    }
+}
+
+allocator_slab::allocator_slab(allocator_slab &&other) noexcept
+    : _state(std::move(other._state)) {
+}
+
+allocator_slab &allocator_slab::operator=(allocator_slab &&other) noexcept {
+    if (this != &other) {
+        std::swap(_state, other._state);
+    }
+    return *this;
+}
+
+[[nodiscard]] void *allocator_slab::do_allocate_sm(size_t size) {
+    return do_allocate_sm(size, 1);
+}
+
+[[nodiscard]] void *allocator_slab::do_allocate_sm(size_t size,
+                                                   size_t alignment) {
+    if (size > _state->slot_size_ || alignment > _state->slot_alignment_) {
+        error_with_guard([&] {
+            return std::format(
+                "[!] can't serve {} bytes aligned to {} from {} byte slots",
+                size, alignment, _state->slot_size_);
+        });
+        throw std::bad_alloc();
+    }
+
+    if (const auto slot = _state->pop()) {
+        return slot;
+    }
+
+    return allocate_from_new_slab();
+}
+
+void *allocator_slab::allocate_from_new_slab() {
+    auto &state = *_state;
+
+    std::lock_guard lock(state.mutex_);
+
+    // someone else may have carved a slab while we waited
+    if (const auto slot = state.pop()) {
+        return slot;
+    }
+
+    const size_t slab_size =
+        state.slots_offset() + state.slot_size_ * state.objects_per_slab_;
+    const auto slab = static_cast<std::byte *>(
+        state.parent_->allocate(slab_size, state.slab_alignment()));
+
+    if (reinterpret_cast<std::uint64_t>(slab + slab_size) > slot_pointer_mask) {
+        state.parent_->deallocate(slab, slab_size, state.slab_alignment());
+        error_with_guard("[!] slab lies outside of the taggable address range");
+        throw std::bad_alloc();
+    }
+
+    const auto header = reinterpret_cast<slab_header *>(slab);
+    header->next_ = state.slabs_;
+    header->size_ = slab_size;
+    state.slabs_ = header;
+
+    const auto slot_at = [&](size_t i) {
+        return reinterpret_cast<free_slot *>(slab + state.slots_offset() +
+                                             i * state.slot_size_);
+    };
+
+    // the first slot goes to the caller, the rest is published in one push
+    if (state.objects_per_slab_ > 1) {
+        for (size_t i = 1; i + 1 < state.objects_per_slab_; ++i) {
+            std::construct_at(slot_at(i))
+                ->next_.store(slot_at(i + 1), std::memory_order_relaxed);
+        }
+        std::construct_at(slot_at(state.objects_per_slab_ - 1));
+
+        state.push(slot_at(1), slot_at(state.objects_per_slab_ - 1));
+    }
+
+    information_with_guard([&] {
+        return std::format("[*] new slab of {} slots of {} bytes",
+                           state.objects_per_slab_, state.slot_size_);
+    });
+
+    return slot_at(0);
+}
+
+void allocator_slab::do_deallocate_sm(void *at) {
+    const auto slot = std::construct_at(static_cast<free_slot *>(at));
+    _state->push(slot, slot);
+}
+
+bool allocator_slab::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+size_t allocator_slab::slot_size() const noexcept {
+    return _state->slot_size_;
+}
+
+inline logger *allocator_slab::get_logger() const {
+    return _state->logger_;
+}
+
+inline std::string allocator_slab::get_typename() const noexcept {
+    return "allocator_slab";
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <allocator_slab.h>
+#include <atomic>
+#include <list>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct tree_node
+    {
+        int key;
+        tree_node *left;
+        tree_node *right;
+    };
+}
+
+TEST(allocatorSlabTests, test1)
+{
+    counting_mem_resource parent;
+
+    {
+        allocator_slab allocator(20, 4, &parent, nullptr, alignof(void *));
+        ASSERT_EQ(allocator.slot_size(), 24);
+
+        std::vector<void *> blocks;
+        for (int i = 0; i < 8; ++i)
+        {
+            blocks.push_back(allocator.allocate(20, alignof(void *)));
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(blocks.back()) % alignof(void *), 0);
+        }
+        ASSERT_EQ(parent.allocations, 2);
+
+        allocator.deallocate(blocks[3], 20);
+        ASSERT_EQ(allocator.allocate(20, alignof(void *)), blocks[3]);
+
+        ASSERT_THROW(static_cast<void>(allocator.allocate(25, alignof(void *))), std::bad_alloc);
+        // slots 24 bytes apart can't keep 16-byte alignment
+        ASSERT_THROW(static_cast<void>(allocator.allocate(24, 16)), std::bad_alloc);
+        ASSERT_THROW(static_cast<void>(allocator.allocate(16)), std::bad_alloc);
+
+        for (auto block: blocks)
+        {
+            allocator.deallocate(block, 20);
+        }
+        ASSERT_EQ(parent.allocations, 2);
+    }
+
+    ASSERT_EQ(parent.deallocations, 2);
+    ASSERT_THROW(allocator_slab(0), std::logic_error);
+    ASSERT_THROW(allocator_slab(16, 4, nullptr, nullptr, 24), std::logic_error);
+}
+
+TEST(allocatorSlabTests, test4)
+{
+    // the default slot alignment serves default-aligned pmr requests
+    allocator_slab allocator(24, 4);
+    ASSERT_EQ(allocator.slot_size(), 32);
+
+    std::vector<void *> blocks;
+    for (int i = 0; i < 8; ++i)
+    {
+        blocks.push_back(allocator.allocate(24, 16));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(blocks.back()) % 16, 0);
+    }
+    ASSERT_THROW(static_cast<void>(allocator.allocate(24, 32)), std::bad_alloc);
+
+    allocator_slab over_aligned(24, 4, nullptr, nullptr, 64);
+    ASSERT_EQ(over_aligned.slot_size(), 64);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        blocks.push_back(over_aligned.allocate(24, 64));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(blocks.back()) % 64, 0);
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+        allocator.deallocate(blocks[i], 24, 16);
+        over_aligned.deallocate(blocks[i + 8], 24, 64);
+    }
+}
+
+TEST(allocatorSlabTests, test2)
+{
+    allocator_slab allocator(sizeof(tree_node), 64);
+    pp_allocator<tree_node> node_allocator(&allocator);
+
+    auto root = node_allocator.new_object<tree_node>(tree_node{ 1, nullptr, nullptr });
+    root->left = node_allocator.new_object<tree_node>(tree_node{ 0, nullptr, nullptr });
+    root->right = node_allocator.new_object<tree_node>(tree_node{ 2, nullptr, nullptr });
+
+    ASSERT_EQ(root->left->key + root->key + root->right->key, 3);
+
+    node_allocator.delete_object(root->left);
+    node_allocator.delete_object(root->right);
+    node_allocator.delete_object(root);
+
+    allocator_slab list_allocator(64);
+    std::list<int, pp_allocator<int>> list{ pp_allocator<int>(&list_allocator) };
+    for (int i = 0; i < 1000; ++i)
+    {
+        list.push_back(i);
+    }
+    ASSERT_EQ(list.size(), 1000);
+    ASSERT_EQ(list.back(), 999);
+}
+
+TEST(allocatorSlabTests, test3)
+{
+    constexpr size_t threads_count = 8;
+    constexpr size_t exchange_slots = 64;
+
+    allocator_slab allocator(sizeof(uint64_t) * 4, 32);
+    std::atomic<uint64_t *> exchange[exchange_slots] = {};
+    std::vector<std::thread> threads;
+    std::atomic<size_t> corrupted = 0;
+
+    // blocks travel between threads through `exchange`, so slots are freed by
+    // other threads than the ones that got them; a slot handed out twice
+    // shows up as a stamp overwritten while its holder still owns it
+    for (size_t t = 0; t < threads_count; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::vector<uint64_t *> held;
+            srand(static_cast<unsigned>(t));
+
+            for (uint64_t i = 0; i < 50'000; ++i)
+            {
+                const uint64_t stamp = (t << 32) | i;
+
+                auto block = static_cast<uint64_t *>(allocator.allocate(sizeof(uint64_t) * 4));
+                std::fill(block, block + 4, stamp);
+                held.push_back(block);
+
+                if (held.size() > 16 || rand() % 2 == 0)
+                {
+                    auto it = held.begin() + rand() % held.size();
+                    if (std::any_of(*it, *it + 4, [&](uint64_t value) { return value != (*it)[0]; }))
+                    {
+                        ++corrupted;
+                    }
+
+                    auto swapped = exchange[rand() % exchange_slots].exchange(*it);
+                    held.erase(it);
+
+                    if (swapped != nullptr)
+                    {
+                        allocator.deallocate(swapped, 1);
+                    }
+                }
+            }
+
+            for (auto block: held)
+            {
+                allocator.deallocate(block, 1);
+            }
+        });
+    }
+
+    for (auto &thread: threads)
+    {
+        thread.join();
+    }
+
+    for (auto &slot: exchange)
+    {
+        if (auto block = slot.load())
+        {
+            allocator.deallocate(block, 1);
+        }
+    }
+
+    ASSERT_EQ(corrupted, 0);
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -1,143 +1,206 @@
 #ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_SORTED_LIST_H
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_SORTED_LIST_H
 
-#include <pp_allocator.h>
 #include <allocator_test_utils.h>
 #include <allocator_with_fit_mode.h>
+#include <pp_allocator.h>
 #include <logger_guardant.h>
 #include <typename_holder.h>
+#include <cstddef>
 #include <iterator>
 #include <mutex>
 
-class allocator_sorted_list final:
-    public smart_mem_resource,
-    public allocator_test_utils,
-    public allocator_with_fit_mode,
-    private logger_guardant,
-    private typename_holder
-{
+/**
+ * Blocks tile the whole pool back to back, free ones are chained in address
+ * order, so a freed block finds both its free neighbours in one pass.
+ */
+class allocator_sorted_list final : public smart_mem_resource,
+                                    public allocator_test_utils,
+                                    public allocator_with_fit_mode,
+                                    private logger_guardant,
+                                    private typename_holder {
+
+  private:
+    struct block_metadata {
+        size_t block_size_;
+
+        /** Next free block while free, trusted memory while occupied */
+        void *ptr_;
+
+        std::byte *block_end() noexcept {
+            return reinterpret_cast<std::byte *>(this + 1) + block_size_;
+        }
+    };
+
+    struct alignas(std::max_align_t) allocator_metadata {
+        logger *logger_;
+
+        memory_resource *allocator_;
+
+        fit_mode fit_mode_;
+
+        size_t mem_size_;
+
+        std::mutex mutex_;
+
+        block_metadata *first_free_;
+
+        /**
+         * Free block after which `next_fit` resumes scanning, nullptr for the
+         * list head
+         */
+        block_metadata *cursor_;
+
+        std::byte *pool_start() noexcept {
+            return reinterpret_cast<std::byte *>(this + 1);
+        }
+
+        const std::byte *pool_start() const noexcept {
+            return reinterpret_cast<const std::byte *>(this + 1);
+        }
+
+        const std::byte *allocator_end() const noexcept {
+            return pool_start() + mem_size_;
+        }
+    };
 
-private:
-    
     void *_trusted_memory;
 
-    static constexpr const size_t allocator_metadata_size = sizeof(logger*) + sizeof(std::pmr::memory_resource *) + sizeof(fit_mode) + sizeof(size_t) + sizeof(std::mutex) + sizeof(void*);
+    static constexpr const size_t allocator_metadata_size =
+        sizeof(allocator_metadata);
+
+    static constexpr const size_t block_metadata_size = sizeof(block_metadata);
 
-    static constexpr const size_t block_metadata_size = sizeof(void*) + sizeof(size_t);
+    /**
+     * Block sizes are kept multiples of it and the header is one of them, so
+     * every payload is aligned for any fundamental type
+     */
+    static constexpr const size_t block_granularity =
+        alignof(std::max_align_t);
 
-public:
+    static_assert(block_metadata_size % block_granularity == 0);
 
+  public:
     explicit allocator_sorted_list(
-            size_t space_size,
-            std::pmr::memory_resource *parent_allocator = nullptr,
-            logger *logger = nullptr,
-            allocator_with_fit_mode::fit_mode allocate_fit_mode = allocator_with_fit_mode::fit_mode::first_fit);
-    
-    allocator_sorted_list(
-        allocator_sorted_list const &other);
-    
-    allocator_sorted_list &operator=(
-        allocator_sorted_list const &other);
-
-    allocator_sorted_list(
-        allocator_sorted_list &&other) noexcept;
-    
-    allocator_sorted_list &operator=(
-        allocator_sorted_list &&other) noexcept;
+        size_t space_size,
+        std::pmr::memory_resource *parent_allocator = nullptr,
+        logger *logger = nullptr,
+        allocator_with_fit_mode::fit_mode allocate_fit_mode =
+            allocator_with_fit_mode::fit_mode::first_fit);
+
+    allocator_sorted_list(allocator_sorted_list const &other) = delete;
+
+    allocator_sorted_list &operator=(allocator_sorted_list const &other) = delete;
+
+    allocator_sorted_list(allocator_sorted_list &&other) noexcept;
+
+    allocator_sorted_list &operator=(allocator_sorted_list &&other) noexcept;
 
     ~allocator_sorted_list() override;
-    
-    [[nodiscard]] void *do_allocate_sm(
-        size_t size) override;
-    
-    void do_deallocate_sm(
-        void *at) override;
 
-    bool do_is_equal(const std::pmr::memory_resource&) const noexcept override;
-    
-    inline void set_fit_mode(
-        allocator_with_fit_mode::fit_mode mode) override;
+    [[nodiscard]] void *do_allocate_sm(size_t size) override;
+
+    void do_deallocate_sm(void *at) override;
+
+    bool
+    do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    inline void set_fit_mode(allocator_with_fit_mode::fit_mode mode) override;
 
-    std::vector<allocator_test_utils::block_info> get_blocks_info() const noexcept override;
+    std::vector<allocator_test_utils::block_info>
+    get_blocks_info() const override;
 
-private:
+  private:
+    std::vector<allocator_test_utils::block_info>
+    get_blocks_info_inner() const override;
 
-    std::vector<allocator_test_utils::block_info> get_blocks_info_inner() const override;
-    
     inline logger *get_logger() const override;
-    
+
     inline std::string get_typename() const override;
 
-    class sorted_free_iterator
-    {
-        void* _free_ptr;
+    inline allocator_metadata &get_allocator_metadata() const noexcept;
+
+    inline size_t get_available_memory() const noexcept;
+
+    /**
+     * Finds a free block of at least `size` bytes, `prev` receives the free
+     * block preceding it in the list or nullptr for the head
+     */
+    block_metadata *find_free_block(size_t size,
+                                    block_metadata *&prev) const noexcept;
+
+    /** Replaces `block` with `replacement` in the free list */
+    inline void replace_free_block(block_metadata *prev, block_metadata *block,
+                                   block_metadata *replacement) noexcept;
 
-    public:
+    class sorted_free_iterator {
+        void *_free_ptr;
 
+      public:
         using iterator_category = std::forward_iterator_tag;
-        using value_type = void*;
-        using reference = void*&;
-        using pointer = void**;
+        using value_type = void *;
+        using reference = void *&;
+        using pointer = void **;
         using difference_type = ptrdiff_t;
 
-        bool operator==(const sorted_free_iterator&) const noexcept;
+        bool operator==(const sorted_free_iterator &) const noexcept;
 
-        bool operator!=(const sorted_free_iterator&) const noexcept;
+        bool operator!=(const sorted_free_iterator &) const noexcept;
 
-        sorted_free_iterator& operator++() & noexcept;
+        sorted_free_iterator &operator++() & noexcept;
 
         sorted_free_iterator operator++(int n);
 
         size_t size() const noexcept;
 
-        void* operator*() const noexcept;
+        void *operator*() const noexcept;
 
         sorted_free_iterator();
 
-        sorted_free_iterator(void* trusted);
+        sorted_free_iterator(void *trusted);
     };
 
-    class sorted_iterator
-    {
-        void* _free_ptr;
-        void* _current_ptr;
-        void* _trusted_memory;
-
-    public:
+    class sorted_iterator {
+        void *_free_ptr;
+        void *_current_ptr;
+        void *_trusted_memory;
 
+      public:
         using iterator_category = std::forward_iterator_tag;
-        using value_type = void*;
-        using reference = void*&;
-        using pointer = void**;
+        using value_type = void *;
+        using reference = void *&;
+        using pointer = void **;
         using difference_type = ptrdiff_t;
 
-        bool operator==(const sorted_iterator&) const noexcept;
+        bool operator==(const sorted_iterator &) const noexcept;
 
-        bool operator!=(const sorted_iterator&) const noexcept;
+        bool operator!=(const sorted_iterator &) const noexcept;
 
-        sorted_iterator& operator++() & noexcept;
+        sorted_iterator &operator++() & noexcept;
 
         sorted_iterator operator++(int n);
 
         size_t size() const noexcept;
 
-        void* operator*() const noexcept;
+        void *operator*() const noexcept;
 
-        bool occupied()const noexcept;
+        bool occupied() const noexcept;
 
         sorted_iterator();
 
-        sorted_iterator(void* trusted);
+        sorted_iterator(void *trusted);
     };
 
     friend class sorted_iterator;
     friend class sorted_free_iterator;
 
     sorted_free_iterator free_begin() const noexcept;
+
     sorted_free_iterator free_end() const noexcept;
 
     sorted_iterator begin() const noexcept;
+
     sorted_iterator end() const noexcept;
 };
 
-#endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_SORTED_LIST_H
\ No newline at end of file
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_SORTED_LIST_H
@@ -1,190 +1,442 @@
-#include <not_implemented.h>
 #include "../include/allocator_sorted_list.h"
+#include <format>
 
-allocator_sorted_list::~allocator_sorted_list()
-{
-    throw not_implemented("allocator_sorted_list::~allocator_sorted_list()", "your code should be here...");
+allocator_sorted_list::~allocator_sorted_list() {
+    if (_trusted_memory == nullptr) {
+        return;
+    }
+
+    auto &metadata = get_allocator_metadata();
+    metadata.mutex_.~mutex();
+    metadata.allocator_->deallocate(
+        _trusted_memory, allocator_metadata_size + metadata.mem_size_,
+        alignof(allocator_metadata));
 }
 
 allocator_sorted_list::allocator_sorted_list(
-    allocator_sorted_list &&other) noexcept
-{
-    throw not_implemented("allocator_sorted_list::allocator_sorted_list(allocator_sorted_list &&) noexcept", "your code should be here...");
+    allocator_sorted_list &&other) noexcept {
+    _trusted_memory = std::exchange(other._trusted_memory, nullptr);
 }
 
-allocator_sorted_list &allocator_sorted_list::operator=(
-    allocator_sorted_list &&other) noexcept
-{
-    throw not_implemented("allocator_sorted_list &allocator_sorted_list::operator=(allocator_sorted_list &&) noexcept", "your code should be here...");
+allocator_sorted_list &
+allocator_sorted_list::operator=(allocator_sorted_list &&other) noexcept {
+    if (this != &other) {
+        std::swap(_trusted_memory, other._trusted_memory);
+    }
+    return *this;
 }
 
 allocator_sorted_list::allocator_sorted_list(
-        size_t space_size,
-        std::pmr::memory_resource *parent_allocator,
-        logger *logger,
-        allocator_with_fit_mode::fit_mode allocate_fit_mode)
-{
-    throw not_implemented("allocator_sorted_list::allocator_sorted_list(size_t, std::pmr::memory_resource *,logger *,allocator_with_fit_mode::fit_mode)", "your code should be here...");
-}
+    size_t space_size, std::pmr::memory_resource *parent_allocator,
+    logger *logger, allocator_with_fit_mode::fit_mode allocate_fit_mode) {
+    if (space_size < block_metadata_size) {
+        throw std::logic_error(
+            "`space_size` is not enough to fit a single block");
+    }
 
-[[nodiscard]] void *allocator_sorted_list::do_allocate_sm(
-    size_t size)
-{
-    throw not_implemented("[[nodiscard]] void *allocator_sorted_list::do_allocate_sm(size_t)", "your code should be here...");
-}
+    const auto allocator = parent_allocator != nullptr
+                               ? parent_allocator
+                               : std::pmr::get_default_resource();
+
+    _trusted_memory = allocator->allocate(allocator_metadata_size + space_size,
+                                          alignof(allocator_metadata));
+
+    const auto metadata = static_cast<allocator_metadata *>(_trusted_memory);
+
+    metadata->logger_ = logger;
+    metadata->allocator_ = allocator;
+    metadata->fit_mode_ = allocate_fit_mode;
+    metadata->mem_size_ = space_size;
+    metadata->cursor_ = nullptr;
+
+    std::construct_at(&metadata->mutex_);
+
+    auto block = reinterpret_cast<block_metadata *>(metadata->pool_start());
+    block->block_size_ = space_size - block_metadata_size;
+    block->ptr_ = nullptr;
+    metadata->first_free_ = block;
+}
+
+[[nodiscard]] void *allocator_sorted_list::do_allocate_sm(size_t size) {
+    const size_t total_size =
+        (size + block_metadata_size + block_granularity - 1) /
+        block_granularity * block_granularity;
+
+    debug_with_guard(
+        [&] { return std::format("[*] allocating {} bytes", total_size); });
+
+    auto &metadata = get_allocator_metadata();
+
+    std::lock_guard lock(metadata.mutex_);
+
+    block_metadata *prev;
+    auto block = find_free_block(total_size, prev);
+
+    if (block == nullptr) {
+        error_with_guard(
+            std::format("[!] out of memory: requested {} bytes", total_size));
+        throw std::bad_alloc();
+    }
+
+    const size_t free_block_size = block_metadata_size + block->block_size_;
+
+    if (free_block_size - total_size >= block_metadata_size) {
+        auto rest = reinterpret_cast<block_metadata *>(
+            reinterpret_cast<std::byte *>(block) + total_size);
+        rest->block_size_ = free_block_size - total_size - block_metadata_size;
+
+        replace_free_block(prev, block, rest);
+        block->block_size_ = total_size - block_metadata_size;
+    } else {
+        warning_with_guard([&] {
+            return std::format("[*] changing block size to {} bytes",
+                               free_block_size);
+        });
+        replace_free_block(prev, block, nullptr);
+    }
+
+    block->ptr_ = _trusted_memory;
+
+    // the next `next_fit` scan starts right where this block was cut from
+    metadata.cursor_ = prev;
+
+    debug_with_guard([&] {
+        return std::format("[+] allocated {} bytes at {:p}",
+                           block_metadata_size + block->block_size_,
+                           static_cast<void *>(block + 1));
+    });
+    information_with_guard([this] {
+        return std::format("[*] available memory: {}", get_available_memory());
+    });
+    debug_with_guard([this] { return print_blocks(); });
+
+    return block + 1;
+}
+
+void allocator_sorted_list::do_deallocate_sm(void *at) {
+    debug_with_guard(
+        [at] { return std::format("[*] deallocating block {:p}", at); });
+
+    auto &metadata = get_allocator_metadata();
+
+    std::lock_guard lock(metadata.mutex_);
+
+    auto block = static_cast<block_metadata *>(at) - 1;
+
+    if (reinterpret_cast<std::byte *>(block) < metadata.pool_start() ||
+        reinterpret_cast<std::byte *>(block) >= metadata.allocator_end() ||
+        block->ptr_ != _trusted_memory) {
+        error_with_guard([at] {
+            return std::format(
+                "[!] block doesn't belong to this allocator: {:p}", at);
+        });
+        throw std::logic_error("unknown block");
+    }
+
+    debug_with_guard([at, block] {
+        return get_dump(static_cast<char *>(at), block->block_size_);
+    });
+
+    // both free neighbours come out of the same walk that finds the insertion
+    // point
+    block_metadata *prev = nullptr;
+    auto next = metadata.first_free_;
+
+    while (next != nullptr && next < block) {
+        prev = next;
+        next = static_cast<block_metadata *>(next->ptr_);
+    }
+
+    block->ptr_ = next;
+    if (prev != nullptr) {
+        prev->ptr_ = block;
+    } else {
+        metadata.first_free_ = block;
+    }
+
+    if (next != nullptr && block->block_end() == reinterpret_cast<std::byte *>(next)) {
+        block->block_size_ += block_metadata_size + next->block_size_;
+        block->ptr_ = next->ptr_;
+
+        if (metadata.cursor_ == next) {
+            metadata.cursor_ = block;
+        }
+    }
+
+    if (prev != nullptr && prev->block_end() == reinterpret_cast<std::byte *>(block)) {
+        prev->block_size_ += block_metadata_size + block->block_size_;
+        prev->ptr_ = block->ptr_;
+
+        if (metadata.cursor_ == block) {
+            metadata.cursor_ = prev;
+        }
+    }
+
+    debug_with_guard("[+] block deallocated successfully");
+    information_with_guard([this] {
+        return std::format("[*] available memory: {}", get_available_memory());
+    });
+    debug_with_guard([this] { return print_blocks(); });
+}
+
+allocator_sorted_list::block_metadata *
+allocator_sorted_list::find_free_block(size_t size,
+                                       block_metadata *&prev) const noexcept {
+    auto &metadata = get_allocator_metadata();
+
+    const auto fits = [size](const block_metadata *block) {
+        return block_metadata_size + block->block_size_ >= size;
+    };
+    const auto next_of = [](const block_metadata *block) {
+        return static_cast<block_metadata *>(block->ptr_);
+    };
+
+    if (metadata.fit_mode_ == fit_mode::next_fit) {
+        // from the cursor to the tail, then wrapping from the head back to it
+        const auto start = metadata.cursor_ != nullptr
+                               ? next_of(metadata.cursor_)
+                               : metadata.first_free_;
+
+        prev = metadata.cursor_;
+        for (auto block = start; block != nullptr;
+             prev = block, block = next_of(block)) {
+            if (fits(block)) {
+                return block;
+            }
+        }
+
+        prev = nullptr;
+        for (auto block = metadata.first_free_; block != start;
+             prev = block, block = next_of(block)) {
+            if (fits(block)) {
+                return block;
+            }
+        }
+
+        return nullptr;
+    }
+
+    block_metadata *found = nullptr;
+    block_metadata *found_prev = nullptr;
+    block_metadata *current_prev = nullptr;
+
+    for (auto block = metadata.first_free_; block != nullptr;
+         current_prev = block, block = next_of(block)) {
+        if (!fits(block)) {
+            continue;
+        }
+
+        const bool better =
+            found == nullptr ||
+            (metadata.fit_mode_ == fit_mode::the_best_fit &&
+             block->block_size_ < found->block_size_) ||
+            (metadata.fit_mode_ == fit_mode::the_worst_fit &&
+             block->block_size_ > found->block_size_);
+
+        if (better) {
+            found = block;
+            found_prev = current_prev;
+
+            if (metadata.fit_mode_ == fit_mode::first_fit) {
+                break;
+            }
+        }
+    }
 
-allocator_sorted_list::allocator_sorted_list(const allocator_sorted_list &other)
-{
-    throw not_implemented("allocator_sorted_list::allocator_sorted_list(const allocator_sorted_list &other)", "your code should be here...");
+    prev = found_prev;
+    return found;
 }
 
-allocator_sorted_list &allocator_sorted_list::operator=(const allocator_sorted_list &other)
-{
-    throw not_implemented("allocator_sorted_list &allocator_sorted_list::operator=(const allocator_sorted_list &other)", "your code should be here...");
+void allocator_sorted_list::replace_free_block(
+    block_metadata *prev, block_metadata *block,
+    block_metadata *replacement) noexcept {
+    auto &metadata = get_allocator_metadata();
+    auto next = static_cast<block_metadata *>(block->ptr_);
+
+    if (replacement != nullptr) {
+        replacement->ptr_ = next;
+        next = replacement;
+    }
+
+    if (prev != nullptr) {
+        prev->ptr_ = next;
+    } else {
+        metadata.first_free_ = next;
+    }
+
+    if (metadata.cursor_ == block) {
+        metadata.cursor_ = replacement != nullptr ? replacement : prev;
+    }
 }
 
-bool allocator_sorted_list::do_is_equal(const std::pmr::memory_resource &other) const noexcept
-{
-    throw not_implemented("bool allocator_sorted_list::do_is_equal(const std::pmr::memory_resource &other) const noexcept", "your code should be here...");
+bool allocator_sorted_list::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
 }
 
-void allocator_sorted_list::do_deallocate_sm(
-    void *at)
-{
-    throw not_implemented("void allocator_sorted_list::do_deallocate_sm(void *)", "your code should be here...");
+inline void
+allocator_sorted_list::set_fit_mode(allocator_with_fit_mode::fit_mode mode) {
+    auto &metadata = get_allocator_metadata();
+    std::lock_guard lock(metadata.mutex_);
+    metadata.fit_mode_ = mode;
 }
 
-inline void allocator_sorted_list::set_fit_mode(
-    allocator_with_fit_mode::fit_mode mode)
-{
-    throw not_implemented("inline void allocator_sorted_list::set_fit_mode(allocator_with_fit_mode::fit_mode)", "your code should be here...");
+std::vector<allocator_test_utils::block_info>
+allocator_sorted_list::get_blocks_info() const {
+    auto &metadata = get_allocator_metadata();
+    std::lock_guard lock(metadata.mutex_);
+    return get_blocks_info_inner();
 }
 
-std::vector<allocator_test_utils::block_info> allocator_sorted_list::get_blocks_info() const noexcept
-{
-    throw not_implemented("std::vector<allocator_test_utils::block_info> allocator_sorted_list::get_blocks_info() const noexcept", "your code should be here...");
+inline logger *allocator_sorted_list::get_logger() const {
+    return get_allocator_metadata().logger_;
 }
 
-inline logger *allocator_sorted_list::get_logger() const
-{
-    throw not_implemented("inline logger *allocator_sorted_list::get_logger() const", "your code should be here...");
+inline std::string allocator_sorted_list::get_typename() const {
+    return "allocator_sorted_list";
 }
 
-inline std::string allocator_sorted_list::get_typename() const
-{
-    throw not_implemented("inline std::string allocator_sorted_list::get_typename() const", "your code should be here...");
+allocator_sorted_list::allocator_metadata &
+allocator_sorted_list::get_allocator_metadata() const noexcept {
+    return *static_cast<allocator_metadata *>(_trusted_memory);
 }
 
+size_t allocator_sorted_list::get_available_memory() const noexcept {
+    size_t available_memory = 0;
 
-std::vector<allocator_test_utils::block_info> allocator_sorted_list::get_blocks_info_inner() const
-{
-    throw not_implemented("std::vector<allocator_test_utils::block_info> allocator_sorted_list::get_blocks_info_inner() const", "your code should be here...");
+    for (auto it = free_begin(); it != free_end(); ++it) {
+        available_memory += it.size();
+    }
+
+    return available_memory;
 }
 
-allocator_sorted_list::sorted_free_iterator allocator_sorted_list::free_begin() const noexcept
-{
-    throw not_implemented("allocator_sorted_list::sorted_free_iterator allocator_sorted_list::free_begin() const noexcept", "your code should be here...");
+std::vector<allocator_test_utils::block_info>
+allocator_sorted_list::get_blocks_info_inner() const {
+    std::vector<allocator_test_utils::block_info> blocks;
+
+    for (auto it = begin(); it != end(); ++it) {
+        blocks.push_back({it.size(), it.occupied()});
+    }
+
+    return blocks;
 }
 
-allocator_sorted_list::sorted_free_iterator allocator_sorted_list::free_end() const noexcept
-{
-    throw not_implemented("allocator_sorted_list::sorted_free_iterator allocator_sorted_list::free_end() const noexcept", "your code should be here...");
+allocator_sorted_list::sorted_free_iterator
+allocator_sorted_list::free_begin() const noexcept {
+    return {_trusted_memory};
 }
 
-allocator_sorted_list::sorted_iterator allocator_sorted_list::begin() const noexcept
-{
-    throw not_implemented("allocator_sorted_list::sorted_iterator allocator_sorted_list::begin() const noexcept", "your code should be here...");
+allocator_sorted_list::sorted_free_iterator
+allocator_sorted_list::free_end() const noexcept {
+    return {};
 }
 
-allocator_sorted_list::sorted_iterator allocator_sorted_list::end() const noexcept
-{
-    throw not_implemented("allocator_sorted_list::sorted_iterator allocator_sorted_list::end() const noexcept", "your code should be here...");
+allocator_sorted_list::sorted_iterator
+allocator_sorted_list::begin() const noexcept {
+    return {_trusted_memory};
 }
 
+allocator_sorted_list::sorted_iterator
+allocator_sorted_list::end() const noexcept {
+    return {};
+}
 
 bool allocator_sorted_list::sorted_free_iterator::operator==(
-        const allocator_sorted_list::sorted_free_iterator & other) const noexcept
-{
-    throw not_implemented("bool allocator_sorted_list::sorted_free_iterator::operator==(const allocator_sorted_list::sorted_free_iterator &) const noexcept", "your code should be here...");
+    const allocator_sorted_list::sorted_free_iterator &other) const noexcept {
+    return _free_ptr == other._free_ptr;
 }
 
 bool allocator_sorted_list::sorted_free_iterator::operator!=(
-        const allocator_sorted_list::sorted_free_iterator &other) const noexcept
-{
-    throw not_implemented("bool allocator_sorted_list::sorted_free_iterator::operator!=(const allocator_sorted_list::sorted_free_iterator &) const noexcept", "your code should be here...");
+    const allocator_sorted_list::sorted_free_iterator &other) const noexcept {
+    return !(*this == other);
 }
 
-allocator_sorted_list::sorted_free_iterator &allocator_sorted_list::sorted_free_iterator::operator++() & noexcept
-{
-    throw not_implemented("allocator_sorted_list::sorted_free_iterator &allocator_sorted_list::sorted_free_iterator::operator++() & noexcept", "your code should be here...");
+allocator_sorted_list::sorted_free_iterator &
+allocator_sorted_list::sorted_free_iterator::operator++() & noexcept {
+    _free_ptr = static_cast<block_metadata *>(_free_ptr)->ptr_;
+    return *this;
 }
 
-allocator_sorted_list::sorted_free_iterator allocator_sorted_list::sorted_free_iterator::operator++(int n)
-{
-    throw not_implemented("allocator_sorted_list::sorted_free_iterator allocator_sorted_list::sorted_free_iterator::operator++(int)", "your code should be here...");
+allocator_sorted_list::sorted_free_iterator
+allocator_sorted_list::sorted_free_iterator::operator++(int) {
+    auto previous = *this;
+    ++*this;
+    return previous;
 }
 
-size_t allocator_sorted_list::sorted_free_iterator::size() const noexcept
-{
-    throw not_implemented("size_t allocator_sorted_list::sorted_free_iterator::size() const noexcept", "your code should be here...");
+size_t allocator_sorted_list::sorted_free_iterator::size() const noexcept {
+    return block_metadata_size +
+           static_cast<block_metadata *>(_free_ptr)->block_size_;
 }
 
-void *allocator_sorted_list::sorted_free_iterator::operator*() const noexcept
-{
-    throw not_implemented("void *allocator_sorted_list::sorted_free_iterator::operator*() const noexcept", "your code should be here...");
+void *allocator_sorted_list::sorted_free_iterator::operator*() const noexcept {
+    return _free_ptr;
 }
 
 allocator_sorted_list::sorted_free_iterator::sorted_free_iterator()
-{
-    throw not_implemented("allocator_sorted_list::sorted_free_iterator::sorted_free_iterator()", "your code should be here...");
+    : _free_ptr(nullptr) {
 }
 
-allocator_sorted_list::sorted_free_iterator::sorted_free_iterator(void *trusted)
-{
-    throw not_implemented("allocator_sorted_list::sorted_free_iterator::sorted_free_iterator(void *)", "your code should be here...");
+allocator_sorted_list::sorted_free_iterator::sorted_free_iterator(
+    void *trusted)
+    : _free_ptr(static_cast<allocator_metadata *>(trusted)->first_free_) {
 }
 
-bool allocator_sorted_list::sorted_iterator::operator==(const allocator_sorted_list::sorted_iterator & other) const noexcept
-{
-    throw not_implemented("bool allocator_sorted_list::sorted_iterator::operator==(const allocator_sorted_list::sorted_iterator &) const noexcept", "your code should be here...");
+bool allocator_sorted_list::sorted_iterator::operator==(
+    const allocator_sorted_list::sorted_iterator &other) const noexcept {
+    return _current_ptr == other._current_ptr;
 }
 
-bool allocator_sorted_list::sorted_iterator::operator!=(const allocator_sorted_list::sorted_iterator &other) const noexcept
-{
-    throw not_implemented("bool allocator_sorted_list::sorted_iterator::operator!=(const allocator_sorted_list::sorted_iterator &) const noexcept", "your code should be here...");
+bool allocator_sorted_list::sorted_iterator::operator!=(
+    const allocator_sorted_list::sorted_iterator &other) const noexcept {
+    return !(*this == other);
 }
 
-allocator_sorted_list::sorted_iterator &allocator_sorted_list::sorted_iterator::operator++() & noexcept
-{
-    throw not_implemented("allocator_sorted_list::sorted_iterator &allocator_sorted_list::sorted_iterator::operator++() & noexcept", "your code should be here...");
+allocator_sorted_list::sorted_iterator &
+allocator_sorted_list::sorted_iterator::operator++() & noexcept {
+    const auto current = static_cast<block_metadata *>(_current_ptr);
+
+    if (_current_ptr == _free_ptr) {
+        _free_ptr = current->ptr_;
+    }
+
+    _current_ptr = current->block_end();
+
+    if (_current_ptr >= static_cast<allocator_metadata *>(_trusted_memory)
+                            ->allocator_end()) {
+        _current_ptr = nullptr;
+    }
+
+    return *this;
 }
 
-allocator_sorted_list::sorted_iterator allocator_sorted_list::sorted_iterator::operator++(int n)
-{
-    throw not_implemented("allocator_sorted_list::sorted_iterator allocator_sorted_list::sorted_iterator::operator++(int)", "your code should be here...");
+allocator_sorted_list::sorted_iterator
+allocator_sorted_list::sorted_iterator::operator++(int) {
+    auto previous = *this;
+    ++*this;
+    return previous;
 }
 
-size_t allocator_sorted_list::sorted_iterator::size() const noexcept
-{
-    throw not_implemented("size_t allocator_sorted_list::sorted_iterator::size() const noexcept", "your code should be here...");
+size_t allocator_sorted_list::sorted_iterator::size() const noexcept {
+    return block_metadata_size +
+           static_cast<block_metadata *>(_current_ptr)->block_size_;
 }
 
-void *allocator_sorted_list::sorted_iterator::operator*() const noexcept
-{
-    throw not_implemented("void *allocator_sorted_list::sorted_iterator::operator*() const noexcept", "your code should be here...");
+void *allocator_sorted_list::sorted_iterator::operator*() const noexcept {
+    return _current_ptr;
 }
 
 allocator_sorted_list::sorted_iterator::sorted_iterator()
-{
-    throw not_implemented("allocator_sorted_list::sorted_iterator::sorted_iterator() ", "your code should be here...");
+    : _free_ptr(nullptr), _current_ptr(nullptr), _trusted_memory(nullptr) {
 }
 
 allocator_sorted_list::sorted_iterator::sorted_iterator(void *trusted)
-{
-    throw not_implemented("allocator_sorted_list::sorted_iterator::sorted_iterator(void *)", "your code should be here...");
+    : _free_ptr(static_cast<allocator_metadata *>(trusted)->first_free_),
+      _current_ptr(static_cast<allocator_metadata *>(trusted)->pool_start()),
+      _trusted_memory(trusted) {
 }
 
-bool allocator_sorted_list::sorted_iterator::occupied() const noexcept
-{
-    throw not_implemented("bool allocator_sorted_list::sorted_iterator::occupied() const noexcept", "your code should be here...");
+bool allocator_sorted_list::sorted_iterator::occupied() const noexcept {
+    return _current_ptr != _free_ptr;
 }
@@ -3,6 +3,7 @@
 #include <logger_builder.h>
 #include <client_logger_builder.h>
 #include <list>
+#include <cstring>
 
 #include "../include/allocator_sorted_list.h"
 
@@ -242,6 +243,158 @@ TEST(allocatorSortedListPositiveTests, test5)
     }
 }
 
+TEST(allocatorSortedListPositiveTests, test6)
+{
+    std::unique_ptr<smart_mem_resource> allocator(new allocator_sorted_list(1000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit));
+    auto *test_utils = dynamic_cast<allocator_test_utils *>(allocator.get());
+    
+    void *first = allocator->allocate(100);
+    void *second = allocator->allocate(200);
+    void *third = allocator->allocate(100);
+    
+    allocator->deallocate(first, 1);
+    allocator->deallocate(third, 1);
+    
+    std::vector<allocator_test_utils::block_info> expected_blocks_state
+        {
+            { .block_size = 128, .is_block_occupied = false },
+            { .block_size = 224, .is_block_occupied = true },
+            { .block_size = 648, .is_block_occupied = false }
+        };
+    ASSERT_EQ(test_utils->get_blocks_info(), expected_blocks_state);
+    
+    allocator->deallocate(second, 1);
+    
+    ASSERT_EQ(test_utils->get_blocks_info(), (std::vector<allocator_test_utils::block_info>{ { .block_size = 1000, .is_block_occupied = false } }));
+}
+
+TEST(allocatorSortedListPositiveTests, test7)
+{
+    std::unique_ptr<smart_mem_resource> allocator(new allocator_sorted_list(1000, nullptr, nullptr, allocator_with_fit_mode::fit_mode::first_fit));
+    auto *fit_mode_holder = dynamic_cast<allocator_with_fit_mode *>(allocator.get());
+    auto *test_utils = dynamic_cast<allocator_test_utils *>(allocator.get());
+    
+    void *blocks[4];
+    for (auto &block: blocks)
+    {
+        block = allocator->allocate(100);
+    }
+    allocator->deallocate(blocks[0], 1);
+    allocator->deallocate(blocks[2], 1);
+    
+    fit_mode_holder->set_fit_mode(allocator_with_fit_mode::fit_mode::next_fit);
+    
+    // skips both 128 byte holes, the scan then resumes from the tail
+    void *large = allocator->allocate(200);
+    void *first = allocator->allocate(100);
+    void *second = allocator->allocate(100);
+    
+    std::vector<allocator_test_utils::block_info> expected_blocks_state
+        {
+            { .block_size = 128, .is_block_occupied = false },
+            { .block_size = 128, .is_block_occupied = true },
+            { .block_size = 128, .is_block_occupied = false },
+            { .block_size = 128, .is_block_occupied = true },
+            { .block_size = 224, .is_block_occupied = true },
+            { .block_size = 128, .is_block_occupied = true },
+            { .block_size = 136, .is_block_occupied = true }
+        };
+    ASSERT_EQ(test_utils->get_blocks_info(), expected_blocks_state);
+    
+    // nothing fits past the cursor any more, so the scan wraps to the head
+    void *third = allocator->allocate(100);
+    ASSERT_EQ(test_utils->get_blocks_info()[0], (allocator_test_utils::block_info{ .block_size = 128, .is_block_occupied = true }));
+    ASSERT_EQ(test_utils->get_blocks_info()[2], (allocator_test_utils::block_info{ .block_size = 128, .is_block_occupied = false }));
+    
+    for (auto block: { blocks[1], blocks[3], large, first, second, third })
+    {
+        allocator->deallocate(block, 1);
+    }
+    
+    ASSERT_EQ(test_utils->get_blocks_info(), (std::vector<allocator_test_utils::block_info>{ { .block_size = 1000, .is_block_occupied = false } }));
+}
+
+TEST(allocatorSortedListPositiveTests, test8)
+{
+    std::unique_ptr<smart_mem_resource> allocator(new allocator_sorted_list(100'000));
+    auto *fit_mode_holder = dynamic_cast<allocator_with_fit_mode *>(allocator.get());
+    auto *test_utils = dynamic_cast<allocator_test_utils *>(allocator.get());
+    
+    std::list<std::pair<unsigned char *, size_t>> allocated_blocks;
+    srand(0);
+    
+    for (int i = 0; i < 20000; i++)
+    {
+        if (rand() % 3 != 0 || allocated_blocks.empty())
+        {
+            fit_mode_holder->set_fit_mode(static_cast<allocator_with_fit_mode::fit_mode>(rand() % 4));
+            size_t size = rand() % 500;
+            
+            try
+            {
+                auto block = reinterpret_cast<unsigned char *>(allocator->allocate(size));
+                ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % alignof(std::max_align_t), 0);
+                memset(block, static_cast<unsigned char>(size), size);
+                allocated_blocks.emplace_back(block, size);
+            }
+            catch (std::bad_alloc const &)
+            {
+            }
+        }
+        else
+        {
+            auto it = allocated_blocks.begin();
+            std::advance(it, rand() % allocated_blocks.size());
+            for (size_t j = 0; j < it->second; j++)
+            {
+                ASSERT_EQ(it->first[j], static_cast<unsigned char>(it->second));
+            }
+            allocator->deallocate(it->first, 1);
+            allocated_blocks.erase(it);
+        }
+        
+        auto blocks = test_utils->get_blocks_info();
+        for (size_t j = 1; j < blocks.size(); j++)
+        {
+            ASSERT_TRUE(blocks[j - 1].is_block_occupied || blocks[j].is_block_occupied);
+        }
+    }
+    
+    for (auto const &[block, size]: allocated_blocks)
+    {
+        allocator->deallocate(block, 1);
+    }
+    
+    ASSERT_EQ(test_utils->get_blocks_info(), (std::vector<allocator_test_utils::block_info>{ { .block_size = 100'000, .is_block_occupied = false } }));
+}
+
+TEST(allocatorSortedListPositiveTests, test9)
+{
+    allocator_sorted_list allocator(1 << 16);
+    std::vector<void *> blocks;
+    
+    // odd sizes in between must not shift the blocks after them
+    for (size_t size = 1; size < 40; ++size)
+    {
+        blocks.push_back(allocator.allocate(size, 1));
+        
+        void *aligned_8 = allocator.allocate(16, 8);
+        void *aligned_16 = allocator.allocate(32, 16);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned_8) % 8, 0);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned_16) % 16, 0);
+        
+        blocks.push_back(aligned_8);
+        blocks.push_back(aligned_16);
+    }
+    
+    for (auto block: blocks)
+    {
+        allocator.deallocate(block, 1);
+    }
+    
+    ASSERT_EQ(allocator.get_blocks_info().size(), 1);
+}
+
 TEST(allocatorSortedListNegativeTests, test1)
 {
     std::unique_ptr<logger> logger(create_logger(std::vector<std::pair<std::string, logger::severity>>
@@ -256,6 +409,18 @@ TEST(allocatorSortedListNegativeTests, test1)
     ASSERT_THROW(alloc->allocate(sizeof(char) * 3100), std::bad_alloc);
 }
 
+TEST(allocatorSortedListNegativeTests, test2)
+{
+    std::unique_ptr<smart_mem_resource> alloc(new allocator_sorted_list(3000));
+    std::unique_ptr<smart_mem_resource> other(new allocator_sorted_list(3000));
+    
+    void *block = other->allocate(100);
+    
+    ASSERT_THROW(alloc->deallocate(block, 1), std::logic_error);
+    
+    other->deallocate(block, 1);
+}
+
 int main(
     int argc,
     char **argv)
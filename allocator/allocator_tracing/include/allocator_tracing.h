@@ -0,0 +1,121 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_TRACING_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_TRACING_H
+
+#include <logger_guardant.h>
+#include <pp_allocator.h>
+#include <typename_holder.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** One traced operation, 24 bytes in the trace file */
+struct trace_record {
+    enum class operation : std::uint8_t { allocate, deallocate, failed_allocate };
+
+    /** Nanoseconds since the tracing resource was created */
+    std::uint64_t timestamp_ns_;
+
+    /**
+     * Block address relative to the first block the traced resource ever
+     * returned, so traces of pool allocators compare across runs
+     */
+    std::int64_t offset_;
+
+    /** Requested bytes, zero for deallocations */
+    std::uint32_t size_;
+
+    /** Small ordinal of the calling thread, in order of first use */
+    std::uint16_t thread_id_;
+
+    operation operation_;
+
+    std::uint8_t reserved_;
+};
+
+static_assert(sizeof(trace_record) == 24);
+
+/**
+ * Decorator recording every request made to another resource into a
+ * memory-mapped ring file. Writers claim slots with a single atomic
+ * increment, so tracing never takes a lock; once the ring wraps, the oldest
+ * records are overwritten.
+ */
+class allocator_tracing final : public smart_mem_resource,
+                                private logger_guardant,
+                                private typename_holder {
+
+  public:
+    struct trace_state;
+
+  private:
+    std::unique_ptr<trace_state> _state;
+
+  public:
+    explicit allocator_tracing(smart_mem_resource *traced,
+                               std::string const &trace_path,
+                               size_t capacity = 1 << 20,
+                               logger *logger = nullptr);
+
+    ~allocator_tracing() override;
+
+    allocator_tracing(allocator_tracing const &other) = delete;
+
+    allocator_tracing &operator=(allocator_tracing const &other) = delete;
+
+    allocator_tracing(allocator_tracing &&other) noexcept;
+
+    allocator_tracing &operator=(allocator_tracing &&other) noexcept;
+
+  public:
+    [[nodiscard]] void *do_allocate_sm(size_t size) override;
+
+    [[nodiscard]] void *do_allocate_sm(size_t size, size_t alignment) override;
+
+    void do_deallocate_sm(void *at) override;
+
+    bool
+    do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+  private:
+    void record(trace_record::operation operation, size_t size,
+                const void *at) noexcept;
+
+    inline logger *get_logger() const override;
+
+    inline std::string get_typename() const noexcept override;
+};
+
+/** Records of a trace file in the order they were claimed */
+class allocation_trace final {
+
+  public:
+    struct replay_result {
+        size_t operations_;
+
+        size_t failed_allocations_;
+
+        /** Allocations that landed on another offset than when recorded */
+        size_t moved_blocks_;
+
+        /** Deallocations of blocks the trace never saw allocated */
+        size_t skipped_deallocations_;
+    };
+
+  private:
+    std::vector<trace_record> _records;
+
+  public:
+    explicit allocation_trace(std::string const &trace_path);
+
+    std::vector<trace_record> const &records() const noexcept;
+
+    /**
+     * Drives `resource` through the trace on the calling thread, matching
+     * deallocations to allocations by their recorded offsets. Blocks still
+     * live at the end are given back.
+     */
+    replay_result replay(std::pmr::memory_resource &resource) const;
+};
+
+#endif // MATH_PRACTICE_AND_OPERATING_SYSTEMS_ALLOCATOR_ALLOCATOR_TRACING_H
@@ -0,0 +1,141 @@
+#include <allocator_boundary_tags.h>
+#include <allocator_buddies_system.h>
+#include <allocator_red_black_tree.h>
+#include <allocator_sorted_list.h>
+#include <allocator_tracing.h>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+    void export_text(
+        allocation_trace const &trace,
+        std::string const &path)
+    {
+        std::ofstream stream(path);
+
+        // offsets double as block ids, the text format wants them dense
+        std::unordered_map<int64_t, size_t> ids;
+        size_t next_id = 0;
+
+        for (auto const &record: trace.records())
+        {
+            if (record.operation_ == trace_record::operation::allocate)
+            {
+                ids[record.offset_] = next_id;
+                stream << "+ " << next_id++ << ' ' << record.size_ << '\n';
+            }
+            else if (record.operation_ == trace_record::operation::deallocate)
+            {
+                if (auto it = ids.find(record.offset_); it != ids.end())
+                {
+                    stream << "- " << it->second << '\n';
+                    ids.erase(it);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * usage: mp_os_allctr_allctr_trcng_rply <trace> [--pool <bytes>] [--export <text trace>]
+ *
+ * Replays a recorded trace against every pool allocator in every fit mode, the pool
+ * should be as large as the traced one for failures to reproduce. The exported text
+ * trace is what mp_os_allctr_bench takes.
+ */
+int main(
+    int argc,
+    char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <trace> [--pool <bytes>] [--export <text trace>]" << std::endl;
+        return 1;
+    }
+
+    size_t pool_size = 64 << 20;
+    std::string export_path;
+
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i];
+
+        if (option == "--pool")
+        {
+            pool_size = std::stoul(argv[i + 1]);
+        }
+        else if (option == "--export")
+        {
+            export_path = argv[i + 1];
+        }
+    }
+
+    allocation_trace trace(argv[1]);
+
+    std::set<uint16_t> threads;
+    for (auto const &record: trace.records())
+    {
+        threads.insert(record.thread_id_);
+    }
+
+    std::cout << trace.records().size() << " records from " << threads.size() << " threads";
+    if (!trace.records().empty())
+    {
+        std::cout << " over " << (trace.records().back().timestamp_ns_ - trace.records().front().timestamp_ns_) / 1'000'000 << " ms";
+    }
+    std::cout << std::endl << std::endl;
+
+    if (!export_path.empty())
+    {
+        export_text(trace, export_path);
+    }
+
+    std::pair<allocator_with_fit_mode::fit_mode, std::string> modes[]
+        {
+            { allocator_with_fit_mode::fit_mode::first_fit, "first" },
+            { allocator_with_fit_mode::fit_mode::the_best_fit, "best" },
+            { allocator_with_fit_mode::fit_mode::the_worst_fit, "worst" },
+            { allocator_with_fit_mode::fit_mode::next_fit, "next" }
+        };
+
+    std::pair<std::string, std::function<std::unique_ptr<smart_mem_resource>(allocator_with_fit_mode::fit_mode)>> allocators[]
+        {
+            { "boundary_tags", [pool_size](auto mode) { return std::make_unique<allocator_boundary_tags>(pool_size, nullptr, nullptr, mode); } },
+            { "buddies_system", [pool_size](auto mode) { return std::make_unique<allocator_buddies_system>(pool_size, nullptr, nullptr, mode); } },
+            { "red_black_tree", [pool_size](auto mode) { return std::make_unique<allocator_red_black_tree>(pool_size, nullptr, nullptr, mode); } },
+            { "sorted_list", [pool_size](auto mode) { return std::make_unique<allocator_sorted_list>(pool_size, nullptr, nullptr, mode); } }
+        };
+
+    std::cout << std::left << std::setw(22) << "resource" << std::right
+              << std::setw(12) << "failed"
+              << std::setw(12) << "moved"
+              << std::setw(12) << "skipped"
+              << std::setw(12) << "ms" << std::endl;
+
+    for (auto const &[name, make]: allocators)
+    {
+        for (auto const &[mode, mode_name]: modes)
+        {
+            auto allocator = make(mode);
+
+            auto start = std::chrono::steady_clock::now();
+            auto result = trace.replay(*allocator);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::cout << std::left << std::setw(22) << name + "/" + mode_name << std::right
+                      << std::setw(12) << result.failed_allocations_
+                      << std::setw(12) << result.moved_blocks_
+                      << std::setw(12) << result.skipped_deallocations_
+                      << std::setw(12) << std::fixed << std::setprecision(1) << elapsed.count() << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,306 @@
+#include <operation_not_supported.h>
+#include "../include/allocator_tracing.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::uint64_t trace_magic = 0x3143525453504f4d; // "MOPSTRC1"
+
+// the claim counter keeps growing past the capacity, records live at
+// `next_ % capacity_`
+struct trace_file_header {
+    std::uint64_t magic_;
+    std::uint64_t capacity_;
+    std::atomic<std::uint64_t> next_;
+};
+
+constexpr size_t trace_file_header_size = 64;
+
+static_assert(sizeof(trace_file_header) <= trace_file_header_size);
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+
+std::atomic<std::uint16_t> next_thread_id{0};
+
+std::uint16_t get_thread_id() noexcept {
+    thread_local const std::uint16_t thread_id = next_thread_id++;
+    return thread_id;
+}
+
+} // namespace
+
+struct allocator_tracing::trace_state {
+    smart_mem_resource *traced_;
+    logger *logger_;
+
+    std::byte *mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+
+    std::chrono::steady_clock::time_point start_;
+
+    /** Address offsets are taken from, set by the first allocation */
+    std::atomic<std::uintptr_t> base_{0};
+
+    trace_file_header &header() const noexcept {
+        return *reinterpret_cast<trace_file_header *>(mapping_);
+    }
+
+    trace_record *records() const noexcept {
+        return reinterpret_cast<trace_record *>(mapping_ +
+                                                trace_file_header_size);
+    }
+};
+
+allocator_tracing::allocator_tracing(smart_mem_resource *traced,
+                                     std::string const &trace_path,
+                                     size_t capacity, logger *logger)
+    : _state(std::make_unique<trace_state>()) {
+    if (traced == nullptr || capacity == 0) {
+        throw std::logic_error(
+            "tracing needs a resource to trace and a non-empty ring");
+    }
+
+    _state->traced_ = traced;
+    _state->logger_ = logger;
+    _state->mapping_size_ =
+        trace_file_header_size + capacity * sizeof(trace_record);
+
+#ifdef _WIN32
+    throw operation_not_supported();
+#else
+    const int fd = ::open(trace_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        throw std::runtime_error(std::format("can't open trace {}: {}",
+                                             trace_path, std::strerror(errno)));
+    }
+
+    void *mapping = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(_state->mapping_size_)) == 0) {
+        mapping = ::mmap(nullptr, _state->mapping_size_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+    }
+    const int error = errno;
+    ::close(fd);
+
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error(std::format("can't map trace {}: {}",
+                                             trace_path, std::strerror(error)));
+    }
+
+    _state->mapping_ = static_cast<std::byte *>(mapping);
+#endif
+
+    auto &header = _state->header();
+    header.magic_ = trace_magic;
+    header.capacity_ = capacity;
+    std::construct_at(&header.next_, 0);
+
+    _state->start_ = std::chrono::steady_clock::now();
+}
+
+allocator_tracing::~allocator_tracing() {
+#ifndef _WIN32
+    if (_state && _state->mapping_ != nullptr) {
+        ::munmap(_state->mapping_, _state->mapping_size_);
+    }
+#endif
+}
+
+allocator_tracing::allocator_tracing(allocator_tracing &&other) noexcept
+    : _state(std::move(other._state)) {
+}
+
+allocator_tracing &
+allocator_tracing::operator=(allocator_tracing &&other) noexcept {
+    if (this != &other) {
+        std::swap(_state, other._state);
+    }
+    return *this;
+}
+
+[[nodiscard]] void *allocator_tracing::do_allocate_sm(size_t size) {
+    return do_allocate_sm(size, alignof(std::max_align_t));
+}
+
+[[nodiscard]] void *allocator_tracing::do_allocate_sm(size_t size,
+                                                      size_t alignment) {
+    void *block;
+
+    try {
+        block = _state->traced_->allocate(size, alignment);
+    } catch (std::bad_alloc const &) {
+        record(trace_record::operation::failed_allocate, size, nullptr);
+        throw;
+    }
+
+    std::uintptr_t expected = 0;
+    _state->base_.compare_exchange_strong(
+        expected, reinterpret_cast<std::uintptr_t>(block),
+        std::memory_order_relaxed);
+
+    record(trace_record::operation::allocate, size, block);
+
+    return block;
+}
+
+void allocator_tracing::do_deallocate_sm(void *at) {
+    // recorded first, so that a block handed out again right after always
+    // comes later in the trace
+    record(trace_record::operation::deallocate, 0, at);
+
+    _state->traced_->deallocate(at, 1);
+}
+
+void allocator_tracing::record(trace_record::operation operation, size_t size,
+                               const void *at) noexcept {
+    auto &state = *_state;
+    auto &header = state.header();
+
+    const auto index = header.next_.fetch_add(1, std::memory_order_relaxed);
+
+    state.records()[index % header.capacity_] = {
+        .timestamp_ns_ = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - state.start_)
+                .count()),
+        .offset_ = at != nullptr
+                       ? static_cast<std::int64_t>(
+                             reinterpret_cast<std::uintptr_t>(at) -
+                             state.base_.load(std::memory_order_relaxed))
+                       : 0,
+        .size_ = static_cast<std::uint32_t>(size),
+        .thread_id_ = get_thread_id(),
+        .operation_ = operation,
+        .reserved_ = 0};
+}
+
+bool allocator_tracing::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+inline logger *allocator_tracing::get_logger() const {
+    return _state->logger_;
+}
+
+inline std::string allocator_tracing::get_typename() const noexcept {
+    return "allocator_tracing";
+}
+
+allocation_trace::allocation_trace(std::string const &trace_path) {
+    std::ifstream stream(trace_path, std::ios::binary);
+    if (!stream) {
+        throw std::runtime_error(std::format("can't open trace {}", trace_path));
+    }
+
+    std::uint64_t header[3];
+    stream.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (!stream || header[0] != trace_magic || header[1] == 0) {
+        throw std::runtime_error(
+            std::format("{} is not an allocation trace", trace_path));
+    }
+
+    const auto capacity = header[1];
+    const auto claimed = header[2];
+    const auto count = std::min(claimed, capacity);
+
+    std::vector<trace_record> ring(capacity);
+    stream.seekg(trace_file_header_size);
+    stream.read(reinterpret_cast<char *>(ring.data()),
+                static_cast<std::streamsize>(capacity * sizeof(trace_record)));
+    if (!stream) {
+        throw std::runtime_error(
+            std::format("trace {} is truncated", trace_path));
+    }
+
+    _records.reserve(count);
+    for (auto index = claimed - count; index != claimed; ++index) {
+        _records.push_back(ring[index % capacity]);
+    }
+}
+
+std::vector<trace_record> const &allocation_trace::records() const noexcept {
+    return _records;
+}
+
+allocation_trace::replay_result
+allocation_trace::replay(std::pmr::memory_resource &resource) const {
+    replay_result result{};
+
+    // recorded offset -> block the replayed resource returned for it
+    std::unordered_map<std::int64_t, std::pair<void *, size_t>> live_blocks;
+    std::uintptr_t base = 0;
+
+    for (auto const &record : _records) {
+        ++result.operations_;
+
+        switch (record.operation_) {
+        case trace_record::operation::allocate: {
+            void *block;
+
+            try {
+                block = resource.allocate(record.size_);
+            } catch (std::bad_alloc const &) {
+                ++result.failed_allocations_;
+                break;
+            }
+
+            if (base == 0) {
+                base = reinterpret_cast<std::uintptr_t>(block) - record.offset_;
+            }
+
+            if (reinterpret_cast<std::uintptr_t>(block) - base !=
+                static_cast<std::uintptr_t>(record.offset_)) {
+                ++result.moved_blocks_;
+            }
+
+            if (auto [it, inserted] = live_blocks.try_emplace(
+                    record.offset_, block, record.size_);
+                !inserted) {
+                // the recorded free of the previous holder was lost to the
+                // ring, keep the newest block under this offset
+                resource.deallocate(it->second.first, it->second.second);
+                it->second = {block, record.size_};
+            }
+            break;
+        }
+        case trace_record::operation::deallocate: {
+            const auto it = live_blocks.find(record.offset_);
+
+            if (it == live_blocks.end()) {
+                ++result.skipped_deallocations_;
+                break;
+            }
+
+            resource.deallocate(it->second.first, it->second.second);
+            live_blocks.erase(it);
+            break;
+        }
+        case trace_record::operation::failed_allocate:
+            // the original caller got nothing, so neither does the trace
+            try {
+                resource.deallocate(resource.allocate(record.size_),
+                                    record.size_);
+            } catch (std::bad_alloc const &) {
+                ++result.failed_allocations_;
+            }
+            break;
+        }
+    }
+
+    for (auto const &[offset, block] : live_blocks) {
+        resource.deallocate(block.first, block.second);
+    }
+
+    return result;
+}
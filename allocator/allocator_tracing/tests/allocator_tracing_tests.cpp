@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <allocator_boundary_tags.h>
+#include <allocator_tracing.h>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // keeps traces out of the build tree, removed when the test is done
+    class temporary_trace_path
+    {
+        std::string _path;
+
+    public:
+        explicit temporary_trace_path(std::string const &name)
+            : _path((std::filesystem::temp_directory_path() / name).string())
+        {
+        }
+
+        temporary_trace_path(temporary_trace_path const &other) = delete;
+
+        temporary_trace_path &operator=(temporary_trace_path const &other) = delete;
+
+        ~temporary_trace_path()
+        {
+            std::filesystem::remove(_path);
+        }
+
+        std::string const &str() const noexcept
+        {
+            return _path;
+        }
+    };
+}
+
+TEST(allocatorTracingTests, test1)
+{
+    temporary_trace_path trace_path("allocator_tracing_tests_trace_1.bin");
+    allocator_boundary_tags traced(10'000);
+
+    {
+        allocator_tracing allocator(&traced, trace_path.str(), 16);
+
+        auto first_block = allocator.allocate(100);
+        auto second_block = allocator.allocate(200);
+        allocator.deallocate(first_block, 100);
+        first_block = allocator.allocate(50);
+        ASSERT_THROW(static_cast<void>(allocator.allocate(20'000)), std::bad_alloc);
+
+        allocator.deallocate(first_block, 50);
+        allocator.deallocate(second_block, 200);
+    }
+
+    allocation_trace trace(trace_path.str());
+    auto const &records = trace.records();
+
+    ASSERT_EQ(records.size(), 7);
+
+    using operation = trace_record::operation;
+    std::vector<std::pair<operation, uint32_t>> expected_operations
+        {
+            { operation::allocate, 100 },
+            { operation::allocate, 200 },
+            { operation::deallocate, 0 },
+            { operation::allocate, 50 },
+            { operation::failed_allocate, 20'000 },
+            { operation::deallocate, 0 },
+            { operation::deallocate, 0 }
+        };
+
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        ASSERT_EQ(records[i].operation_, expected_operations[i].first);
+        ASSERT_EQ(records[i].size_, expected_operations[i].second);
+        ASSERT_EQ(records[i].thread_id_, records[0].thread_id_);
+        ASSERT_LE(i == 0 ? 0 : records[i - 1].timestamp_ns_, records[i].timestamp_ns_);
+    }
+
+    ASSERT_EQ(records[0].offset_, 0);
+    ASSERT_GT(records[1].offset_, 0);
+    ASSERT_EQ(records[2].offset_, 0);
+    ASSERT_EQ(records[3].offset_, 0);
+    ASSERT_EQ(records[6].offset_, records[1].offset_);
+
+    allocator_boundary_tags same_pool(10'000);
+    auto result = trace.replay(same_pool);
+
+    ASSERT_EQ(result.operations_, 7);
+    ASSERT_EQ(result.failed_allocations_, 1);
+    ASSERT_EQ(result.moved_blocks_, 0);
+    ASSERT_EQ(result.skipped_deallocations_, 0);
+
+    auto blocks = same_pool.get_blocks_info();
+    ASSERT_EQ(blocks.size(), 1);
+    ASSERT_FALSE(blocks[0].is_block_occupied);
+}
+
+TEST(allocatorTracingTests, test2)
+{
+    temporary_trace_path trace_path("allocator_tracing_tests_trace_2.bin");
+    allocator_boundary_tags traced(10'000);
+
+    {
+        allocator_tracing allocator(&traced, trace_path.str(), 4);
+
+        for (size_t size = 1; size <= 5; ++size)
+        {
+            allocator.deallocate(allocator.allocate(size), size);
+        }
+    }
+
+    allocation_trace trace(trace_path.str());
+    auto const &records = trace.records();
+
+    // only the last four of ten records survive the ring
+    ASSERT_EQ(records.size(), 4);
+    ASSERT_EQ(records[0].operation_, trace_record::operation::allocate);
+    ASSERT_EQ(records[0].size_, 4);
+    ASSERT_EQ(records[2].size_, 5);
+    ASSERT_EQ(records[3].operation_, trace_record::operation::deallocate);
+}
+
+TEST(allocatorTracingTests, test3)
+{
+    temporary_trace_path trace_path("allocator_tracing_tests_trace_3.bin");
+    constexpr size_t threads_count = 4;
+    constexpr size_t iterations_count = 2000;
+
+    allocator_boundary_tags traced(1'000'000);
+
+    {
+        allocator_tracing allocator(&traced, trace_path.str(), threads_count * iterations_count * 2);
+        std::vector<std::thread> threads;
+
+        for (size_t t = 0; t < threads_count; ++t)
+        {
+            threads.emplace_back([&allocator, t]()
+            {
+                std::vector<void *> blocks;
+
+                for (size_t i = 0; i < iterations_count; ++i)
+                {
+                    blocks.push_back(allocator.allocate(t * 8 + i % 64 + 1));
+                    if (i % 3 == 2)
+                    {
+                        allocator.deallocate(blocks[i / 3], 1);
+                    }
+                }
+
+                for (size_t i = iterations_count / 3; i < blocks.size(); ++i)
+                {
+                    allocator.deallocate(blocks[i], 1);
+                }
+            });
+        }
+
+        for (auto &thread: threads)
+        {
+            thread.join();
+        }
+    }
+
+    allocation_trace trace(trace_path.str());
+    ASSERT_EQ(trace.records().size(), threads_count * iterations_count * 2);
+
+    allocator_boundary_tags same_pool(1'000'000);
+    auto result = trace.replay(same_pool);
+
+    ASSERT_EQ(result.failed_allocations_, 0);
+    ASSERT_EQ(result.skipped_deallocations_, 0);
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,357 @@
+#include <allocator_boundary_tags.h>
+#include <allocator_buddies_system.h>
+#include <allocator_global_heap.h>
+#include <allocator_magazine.h>
+#include <allocator_red_black_tree.h>
+#include <allocator_sorted_list.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr size_t pool_size = 64 << 20;
+
+    struct trace_operation
+    {
+        bool allocate;
+        uint32_t id;
+        uint32_t size;
+    };
+
+    struct trace
+    {
+        std::string name;
+        std::vector<trace_operation> operations;
+        uint32_t ids_count = 0;
+    };
+
+    enum class lifetime
+    {
+        lifo,
+        fifo
+    };
+
+    // a random walk of the live set, capped at `max_live_blocks`, that leans towards
+    // allocation so it ramps up to the cap and then churns there
+    trace make_trace(
+        std::string name,
+        std::function<uint32_t(std::mt19937 &)> size_distribution,
+        lifetime order,
+        size_t operations_count,
+        size_t max_live_blocks)
+    {
+        std::mt19937 gen(0);
+        std::bernoulli_distribution allocate_distribution(0.55);
+        std::deque<uint32_t> live_ids;
+        trace result{ std::move(name), {} };
+
+        while (result.operations.size() < operations_count)
+        {
+            if (live_ids.empty() || (live_ids.size() < max_live_blocks && allocate_distribution(gen)))
+            {
+                live_ids.push_back(result.ids_count);
+                result.operations.push_back({ true, result.ids_count++, size_distribution(gen) });
+            }
+            else
+            {
+                uint32_t id = order == lifetime::lifo ? live_ids.back() : live_ids.front();
+                order == lifetime::lifo ? live_ids.pop_back() : live_ids.pop_front();
+                result.operations.push_back({ false, id, 0 });
+            }
+        }
+
+        return result;
+    }
+
+    uint32_t uniform_size(std::mt19937 &gen)
+    {
+        return std::uniform_int_distribution<uint32_t>(8, 512)(gen);
+    }
+
+    // Pareto sizes: mostly small nodes with a heavy tail of large buffers
+    uint32_t power_law_size(std::mt19937 &gen)
+    {
+        double u = std::uniform_real_distribution<double>(0, 1)(gen);
+        return static_cast<uint32_t>(std::min(4096.0, 16.0 / std::pow(1.0 - u, 1.0 / 1.2)));
+    }
+
+    /** One operation per line, `+ <id> <size>` allocates and `- <id>` frees */
+    trace load_trace(
+        std::string const &path)
+    {
+        std::ifstream stream(path);
+        if (!stream)
+        {
+            throw std::runtime_error("can't open trace " + path);
+        }
+
+        trace result{ path, {} };
+        std::string line;
+
+        while (std::getline(stream, line))
+        {
+            std::istringstream fields(line);
+            char op;
+            trace_operation operation{};
+
+            if (!(fields >> op >> operation.id) || (op != '+' && op != '-'))
+            {
+                continue;
+            }
+
+            operation.allocate = op == '+';
+            if (operation.allocate)
+            {
+                fields >> operation.size;
+            }
+
+            result.ids_count = std::max(result.ids_count, operation.id + 1);
+            result.operations.push_back(operation);
+        }
+
+        return result;
+    }
+
+    // Linux only: clearing the refs resets VmHWM, so every run reports its own peak
+    void reset_peak_rss()
+    {
+        std::ofstream("/proc/self/clear_refs") << "5";
+    }
+
+    long read_peak_rss_kib()
+    {
+        std::ifstream status("/proc/self/status");
+        std::string key;
+
+        while (status >> key)
+        {
+            if (key == "VmHWM:")
+            {
+                long value;
+                status >> value;
+                return value;
+            }
+            status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+
+        return -1;
+    }
+
+    struct result
+    {
+        double operations_per_second;
+        double p99_latency_ns;
+        long peak_rss_kib;
+
+        /** 1 - largest hole / free bytes, sampled before the live set is drained */
+        double fragmentation;
+
+        size_t failed_allocations;
+    };
+
+    result replay(
+        std::pmr::memory_resource &resource,
+        trace const &trace)
+    {
+        std::vector<void *> blocks(trace.ids_count, nullptr);
+        std::vector<uint32_t> sizes(trace.ids_count, 0);
+        std::vector<double> latencies;
+        latencies.reserve(trace.operations.size());
+
+        result measured{};
+
+        reset_peak_rss();
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto const &operation: trace.operations)
+        {
+            auto operation_start = std::chrono::steady_clock::now();
+
+            if (operation.allocate)
+            {
+                try
+                {
+                    blocks[operation.id] = resource.allocate(operation.size);
+                    sizes[operation.id] = operation.size;
+                }
+                catch (std::bad_alloc const &)
+                {
+                    ++measured.failed_allocations;
+                }
+            }
+            else if (blocks[operation.id] != nullptr)
+            {
+                resource.deallocate(blocks[operation.id], sizes[operation.id]);
+                blocks[operation.id] = nullptr;
+            }
+
+            latencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - operation_start).count());
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        measured.operations_per_second = trace.operations.size() / elapsed.count();
+
+        auto p99 = latencies.begin() + latencies.size() * 99 / 100;
+        std::nth_element(latencies.begin(), p99, latencies.end());
+        measured.p99_latency_ns = p99 != latencies.end() ? *p99 : 0;
+
+        measured.fragmentation = std::nan("");
+        if (auto *test_utils = dynamic_cast<allocator_test_utils *>(&resource))
+        {
+            size_t free_bytes = 0;
+            size_t largest_free_block = 0;
+
+            for (auto const &block: test_utils->get_blocks_info())
+            {
+                if (!block.is_block_occupied)
+                {
+                    free_bytes += block.block_size;
+                    largest_free_block = std::max(largest_free_block, block.block_size);
+                }
+            }
+
+            measured.fragmentation = free_bytes != 0 ? 1.0 - static_cast<double>(largest_free_block) / free_bytes : 0;
+        }
+
+        measured.peak_rss_kib = read_peak_rss_kib();
+
+        for (uint32_t id = 0; id < trace.ids_count; ++id)
+        {
+            if (blocks[id] != nullptr)
+            {
+                resource.deallocate(blocks[id], sizes[id]);
+            }
+        }
+
+        return measured;
+    }
+
+    struct subject
+    {
+        std::string name;
+        std::function<std::unique_ptr<std::pmr::memory_resource>()> make;
+    };
+
+    // the magazine needs its upstream to outlive it
+    struct magazine_over_global_heap final : std::pmr::memory_resource
+    {
+        allocator_global_heap upstream;
+        allocator_magazine magazine{ &upstream };
+
+        void *do_allocate(size_t bytes, size_t alignment) override
+        {
+            return magazine.allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override
+        {
+            magazine.deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    std::vector<subject> make_subjects()
+    {
+        std::vector<subject> subjects
+            {
+                { "global_heap", []() { return std::make_unique<allocator_global_heap>(); } },
+                { "magazine", []() { return std::make_unique<magazine_over_global_heap>(); } }
+            };
+
+        std::pair<allocator_with_fit_mode::fit_mode, std::string> modes[]
+            {
+                { allocator_with_fit_mode::fit_mode::first_fit, "first" },
+                { allocator_with_fit_mode::fit_mode::the_best_fit, "best" },
+                { allocator_with_fit_mode::fit_mode::the_worst_fit, "worst" },
+                { allocator_with_fit_mode::fit_mode::next_fit, "next" }
+            };
+
+        for (auto const &[mode, mode_name]: modes)
+        {
+            subjects.push_back({ "boundary_tags/" + mode_name, [mode]() { return std::make_unique<allocator_boundary_tags>(pool_size, nullptr, nullptr, mode); } });
+            subjects.push_back({ "boundary_tags+index/" + mode_name, [mode]() { return std::make_unique<allocator_boundary_tags>(pool_size, nullptr, nullptr, mode, true); } });
+            subjects.push_back({ "buddies_system/" + mode_name, [mode]() { return std::make_unique<allocator_buddies_system>(pool_size, nullptr, nullptr, mode); } });
+            subjects.push_back({ "red_black_tree/" + mode_name, [mode]() { return std::make_unique<allocator_red_black_tree>(pool_size, nullptr, nullptr, mode); } });
+            subjects.push_back({ "sorted_list/" + mode_name, [mode]() { return std::make_unique<allocator_sorted_list>(pool_size, nullptr, nullptr, mode); } });
+        }
+
+        // the fit mode as a template argument, next to the runtime ones above
+        subjects.push_back({ "boundary_tags_t/first", []() { return std::make_unique<allocator_boundary_tags_t<allocator_with_fit_mode::fit_mode::first_fit>>(pool_size); } });
+        subjects.push_back({ "boundary_tags_t/best", []() { return std::make_unique<allocator_boundary_tags_t<allocator_with_fit_mode::fit_mode::the_best_fit>>(pool_size); } });
+        subjects.push_back({ "boundary_tags_t/worst", []() { return std::make_unique<allocator_boundary_tags_t<allocator_with_fit_mode::fit_mode::the_worst_fit>>(pool_size); } });
+        subjects.push_back({ "boundary_tags_t/next", []() { return std::make_unique<allocator_boundary_tags_t<allocator_with_fit_mode::fit_mode::next_fit>>(pool_size); } });
+        subjects.push_back({ "boundary_tags_t+index/best", []() { return std::make_unique<allocator_boundary_tags_t<allocator_with_fit_mode::fit_mode::the_best_fit>>(pool_size, nullptr, nullptr, true); } });
+
+        return subjects;
+    }
+}
+
+/**
+ * usage: mp_os_allctr_bench [operations per synthetic trace] [recorded trace files...]
+ */
+int main(
+    int argc,
+    char *argv[])
+{
+    size_t operations_count = argc > 1
+        ? std::stoul(argv[1])
+        : 200'000;
+    size_t max_live_blocks = 1024;
+
+    std::vector<trace> traces
+        {
+            make_trace("uniform/lifo", uniform_size, lifetime::lifo, operations_count, max_live_blocks),
+            make_trace("uniform/fifo", uniform_size, lifetime::fifo, operations_count, max_live_blocks),
+            make_trace("power_law/lifo", power_law_size, lifetime::lifo, operations_count, max_live_blocks),
+            make_trace("power_law/fifo", power_law_size, lifetime::fifo, operations_count, max_live_blocks)
+        };
+
+    for (int i = 2; i < argc; ++i)
+    {
+        traces.push_back(load_trace(argv[i]));
+    }
+
+    std::cout << std::left << std::setw(28) << "resource"
+              << std::setw(16) << "trace" << std::right
+              << std::setw(14) << "ops/s"
+              << std::setw(12) << "p99 ns"
+              << std::setw(14) << "peak RSS KiB"
+              << std::setw(10) << "frag"
+              << std::setw(8) << "failed" << std::endl;
+
+    for (auto const &subject: make_subjects())
+    {
+        for (auto const &trace: traces)
+        {
+            auto resource = subject.make();
+            auto measured = replay(*resource, trace);
+
+            std::cout << std::left << std::setw(28) << subject.name
+                      << std::setw(16) << trace.name << std::right << std::fixed
+                      << std::setw(14) << std::setprecision(0) << measured.operations_per_second
+                      << std::setw(12) << measured.p99_latency_ns
+                      << std::setw(14) << measured.peak_rss_kib
+                      << std::setw(10) << std::setprecision(3) << measured.fragmentation
+                      << std::setw(8) << measured.failed_allocations << std::endl;
+        }
+    }
+
+    return 0;
+}
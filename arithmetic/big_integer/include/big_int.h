@@ -127,6 +127,19 @@ public:
 
     big_int& modulo_assign(const big_int& other, division_rule rule = division_rule::trivial) &;
 
+    /** Quotient into *this and remainder into remainder from a single division, with the signs of / and %.
+     *  remainder keeps its storage when it is large enough
+     */
+    big_int& divmod_assign(const big_int& other, big_int& remainder, division_rule rule) &;
+
+    /** Delegates to divmod_assign and calls decide_div
+     */
+    big_int& divmod_assign(const big_int& other, big_int& remainder) &;
+
+    /** {*this / other, *this % other}
+     */
+    std::pair<big_int, big_int> divmod(const big_int& other) const;
+
     big_int operator+(const big_int& other) const;
     big_int operator-(const big_int& other) const;
     big_int operator-() const;
@@ -5,6 +5,7 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <bit>
 #include "../include/big_int.h"
 
 namespace
@@ -23,26 +24,1096 @@ namespace
     {
         return digits.size() == 1 && digits[0] == 0;
     }
-}
 
-big_int::multiplication_rule big_int::decide_mult(size_t rhs) const noexcept
-{ 
+    /*
+     * Limb span arithmetic for the recursive multipliers. Spans are little-endian arrays of
+     * limbs; all of them work in place and none of them allocates.
+     */
+
+    /** r[0, a_size) = a + b with a_size >= b_size, returns the carry out. r may be a
+     */
+    unsigned int limb_add(unsigned int* r, const unsigned int* a, size_t a_size, const unsigned int* b, size_t b_size) noexcept
+    {
+        unsigned long long carry = 0;
+        size_t i = 0;
+
+        for (; i < b_size; ++i)
+        {
+            carry += static_cast<unsigned long long>(a[i]) + b[i];
+            r[i] = static_cast<unsigned int>(carry);
+            carry >>= 32;
+        }
+        for (; i < a_size; ++i)
+        {
+            carry += a[i];
+            r[i] = static_cast<unsigned int>(carry);
+            carry >>= 32;
+        }
+
+        return static_cast<unsigned int>(carry);
+    }
+
+    /** r[0, a_size) = a - b with a_size >= b_size, returns the borrow out. r may be a
+     */
+    unsigned int limb_sub(unsigned int* r, const unsigned int* a, size_t a_size, const unsigned int* b, size_t b_size) noexcept
+    {
+        unsigned long long borrow = 0;
+        size_t i = 0;
+
+        for (; i < b_size; ++i)
+        {
+            const unsigned long long diff = static_cast<unsigned long long>(a[i]) - b[i] - borrow;
+            r[i] = static_cast<unsigned int>(diff);
+            borrow = diff >> 63;
+        }
+        for (; i < a_size; ++i)
+        {
+            const unsigned long long diff = static_cast<unsigned long long>(a[i]) - borrow;
+            r[i] = static_cast<unsigned int>(diff);
+            borrow = diff >> 63;
+        }
+
+        return static_cast<unsigned int>(borrow);
+    }
+
+    /** r[0, r_size) += a * m, limbs of a past r_size must be zero, returns the carry out
+     */
+    unsigned int limb_addmul(unsigned int* r, size_t r_size, const unsigned int* a, size_t a_size, unsigned int m) noexcept
+    {
+        a_size = std::min(a_size, r_size);
+
+        unsigned long long carry = 0;
+        size_t i = 0;
+
+        for (; i < a_size; ++i)
+        {
+            carry += static_cast<unsigned long long>(a[i]) * m + r[i];
+            r[i] = static_cast<unsigned int>(carry);
+            carry >>= 32;
+        }
+        for (; i < r_size && carry != 0; ++i)
+        {
+            carry += r[i];
+            r[i] = static_cast<unsigned int>(carry);
+            carry >>= 32;
+        }
+
+        return static_cast<unsigned int>(carry);
+    }
+
+    /** r[0, r_size) -= a * m, limbs of a past r_size must be zero, returns the borrow out
+     */
+    unsigned int limb_submul(unsigned int* r, size_t r_size, const unsigned int* a, size_t a_size, unsigned int m) noexcept
+    {
+        a_size = std::min(a_size, r_size);
+
+        unsigned long long borrow = 0;
+        size_t i = 0;
+
+        for (; i < a_size; ++i)
+        {
+            const unsigned long long product = static_cast<unsigned long long>(a[i]) * m + borrow;
+            const unsigned int low = static_cast<unsigned int>(product);
+
+            borrow = (product >> 32) + (r[i] < low);
+            r[i] -= low;
+        }
+        for (; i < r_size && borrow != 0; ++i)
+        {
+            const unsigned int limb = r[i];
+
+            r[i] = limb - static_cast<unsigned int>(borrow);
+            borrow = limb < borrow;
+        }
+
+        return static_cast<unsigned int>(borrow);
+    }
+
+    /** r[0, size) /= d, returns the remainder
+     */
+    unsigned int limb_divide_small(unsigned int* r, size_t size, unsigned int d) noexcept
+    {
+        unsigned long long remainder = 0;
+
+        for (size_t i = size; i-- > 0;)
+        {
+            const unsigned long long current = (remainder << 32) | r[i];
+            r[i] = static_cast<unsigned int>(current / d);
+            remainder = current % d;
+        }
+
+        return static_cast<unsigned int>(remainder);
+    }
+
+    int limb_compare(const unsigned int* a, size_t a_size, const unsigned int* b, size_t b_size) noexcept
+    {
+        for (; a_size > b_size; --a_size)
+        {
+            if (a[a_size - 1] != 0)
+            {
+                return 1;
+            }
+        }
+        for (; b_size > a_size; --b_size)
+        {
+            if (b[b_size - 1] != 0)
+            {
+                return -1;
+            }
+        }
+        for (size_t i = a_size; i-- > 0;)
+        {
+            if (a[i] != b[i])
+            {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    /** out[0, a_size + b_size) = a * b, out may not overlap the operands
+     */
+    void schoolbook_multiply(const unsigned int* a, size_t a_size, const unsigned int* b, size_t b_size, unsigned int* out) noexcept
+    {
+        std::fill(out, out + a_size + b_size, 0);
+
+        for (size_t i = 0; i < a_size; ++i)
+        {
+            unsigned long long carry = 0;
+            const unsigned long long digit = a[i];
+
+            for (size_t j = 0; j < b_size; ++j)
+            {
+                carry += digit * b[j] + out[i + j];
+                out[i + j] = static_cast<unsigned int>(carry);
+                carry >>= 32;
+            }
+            out[i + b_size] = static_cast<unsigned int>(carry);
+        }
+    }
+
+    // below Karatsuba_base_threshold limbs recursion stops at the schoolbook product, from
+    // Toom3_threshold on operands are split in three instead of two
+    constexpr size_t Karatsuba_base_threshold = 32;
+    constexpr size_t Toom3_threshold = 192;
+
+    size_t balanced_scratch_size(size_t n) noexcept
+    {
+        if (n < Karatsuba_base_threshold)
+        {
+            return 0;
+        }
+        if (n < Toom3_threshold)
+        {
+            const size_t h = (n + 1) / 2;
+            return 4 * (h + 1) + balanced_scratch_size(h + 1);
+        }
+
+        const size_t k = (n + 2) / 3;
+        return 12 * (k + 1) + balanced_scratch_size(k + 1);
+    }
+
+    void balanced_multiply(const unsigned int* a, const unsigned int* b, size_t n, unsigned int* out, unsigned int* scratch) noexcept;
+
+    /** out[0, 2n) = a * b by splitting both at h = ceil(n / 2):
+     *  a * b = z0 + ((a0 + a1)(b0 + b1) - z0 - z2) x^h + z2 x^2h
+     */
+    void karatsuba_multiply(const unsigned int* a, const unsigned int* b, size_t n, unsigned int* out, unsigned int* scratch) noexcept
+    {
+        const size_t h = (n + 1) / 2;
+        const size_t l = n - h;
+
+        unsigned int* a_sum = scratch;
+        unsigned int* b_sum = a_sum + h + 1;
+        unsigned int* z1 = b_sum + h + 1;
+        unsigned int* next = z1 + 2 * h + 2;
+
+        balanced_multiply(a, b, h, out, next);
+        balanced_multiply(a + h, b + h, l, out + 2 * h, next);
+
+        a_sum[h] = limb_add(a_sum, a, h, a + h, l);
+        b_sum[h] = limb_add(b_sum, b, h, b + h, l);
+        balanced_multiply(a_sum, b_sum, h + 1, z1, next);
+
+        limb_sub(z1, z1, 2 * h + 2, out, 2 * h);
+        limb_sub(z1, z1, 2 * h + 2, out + 2 * h, 2 * l);
+        limb_addmul(out + h, 2 * n - h, z1, 2 * h + 2, 1);
+    }
+
+    /** out[0, 2n) = a * b by splitting both in three parts of k = ceil(n / 3) limbs and
+     *  interpolating the product polynomial from its values at 0, 1, -1, 2 and infinity.
+     *  Every intermediate stays non-negative except the value at -1, whose sign is kept apart
+     */
+    void toom3_multiply(const unsigned int* a, const unsigned int* b, size_t n, unsigned int* out, unsigned int* scratch) noexcept
+    {
+        const size_t k = (n + 2) / 3;
+        const size_t l = n - 2 * k;
+        const size_t w = 2 * k + 2;
+
+        unsigned int* evaluations = scratch;
+        unsigned int* r1 = evaluations + 3 * w;
+        unsigned int* r_minus_1 = r1 + w;
+        unsigned int* r2 = r_minus_1 + w;
+        unsigned int* next = r2 + w;
+
+        // p(1), |p(-1)| and p(2) of one operand into dest[0, 3(k + 1)), returns whether p(-1) < 0
+        auto evaluate = [k, l](const unsigned int* x, unsigned int* dest) noexcept
+        {
+            unsigned int* at_1 = dest;
+            unsigned int* at_minus_1 = at_1 + k + 1;
+            unsigned int* at_2 = at_minus_1 + k + 1;
+
+            // at_minus_1 holds x0 + x2 for a while
+            at_minus_1[k] = limb_add(at_minus_1, x, k, x + 2 * k, l);
+            at_1[k] = at_minus_1[k] + limb_add(at_1, at_minus_1, k, x + k, k);
+
+            std::copy(x, x + k, at_2);
+            at_2[k] = 0;
+            limb_addmul(at_2, k + 1, x + k, k, 2);
+            limb_addmul(at_2, k + 1, x + 2 * k, l, 4);
+
+            if (limb_compare(at_minus_1, k + 1, x + k, k) >= 0)
+            {
+                limb_sub(at_minus_1, at_minus_1, k + 1, x + k, k);
+                return false;
+            }
+            at_minus_1[k] = 0;
+            limb_sub(at_minus_1, x + k, k, at_minus_1, k);
+            return true;
+        };
+
+        const bool a_negative = evaluate(a, evaluations);
+        const bool b_negative = evaluate(b, evaluations + 3 * (k + 1));
+        const bool r_minus_1_negative = a_negative != b_negative;
+
+        const unsigned int* a_evaluations = evaluations;
+        const unsigned int* b_evaluations = evaluations + 3 * (k + 1);
+
+        balanced_multiply(a_evaluations, b_evaluations, k + 1, r1, next);
+        balanced_multiply(a_evaluations + k + 1, b_evaluations + k + 1, k + 1, r_minus_1, next);
+        balanced_multiply(a_evaluations + 2 * (k + 1), b_evaluations + 2 * (k + 1), k + 1, r2, next);
+
+        const unsigned int* r0 = out;
+        const unsigned int* r_infinity = out + 4 * k;
+
+        balanced_multiply(a, b, k, out, next);
+        balanced_multiply(a + 2 * k, b + 2 * k, l, out + 4 * k, next);
+        std::fill(out + 2 * k, out + 4 * k, 0);
+
+        // the evaluations are dead, reuse them for (r(1) - r(-1)) / 2 = c1 + c3
+        unsigned int* odd = evaluations;
+
+        if (r_minus_1_negative)
+        {
+            limb_add(odd, r1, w, r_minus_1, w);
+            limb_sub(r1, r1, w, r_minus_1, w);
+        }
+        else
+        {
+            limb_sub(odd, r1, w, r_minus_1, w);
+            limb_add(r1, r1, w, r_minus_1, w);
+        }
+        limb_divide_small(odd, w, 2);
+
+        // c2 = (r(1) + r(-1)) / 2 - c0 - c4
+        unsigned int* c2 = r1;
+        limb_divide_small(c2, w, 2);
+        limb_sub(c2, c2, w, r0, 2 * k);
+        limb_sub(c2, c2, w, r_infinity, 2 * l);
+
+        // c3 = ((r(2) - c0 - 4 c2 - 16 c4) / 2 - c1 - c3) / 3
+        unsigned int* c3 = r2;
+        limb_sub(c3, c3, w, r0, 2 * k);
+        limb_submul(c3, w, c2, w, 4);
+        limb_submul(c3, w, r_infinity, 2 * l, 16);
+        limb_divide_small(c3, w, 2);
+        limb_sub(c3, c3, w, odd, w);
+        limb_divide_small(c3, w, 3);
+
+        unsigned int* c1 = odd;
+        limb_sub(c1, c1, w, c3, w);
+
+        limb_addmul(out + k, 2 * n - k, c1, w, 1);
+        limb_addmul(out + 2 * k, 2 * n - 2 * k, c2, w, 1);
+        limb_addmul(out + 3 * k, 2 * n - 3 * k, c3, w, 1);
+    }
+
+    /** out[0, 2n) = a * b, scratch holds balanced_scratch_size(n) limbs
+     */
+    void balanced_multiply(const unsigned int* a, const unsigned int* b, size_t n, unsigned int* out, unsigned int* scratch) noexcept
+    {
+        if (n < Karatsuba_base_threshold)
+        {
+            schoolbook_multiply(a, n, b, n, out);
+        }
+        else if (n < Toom3_threshold)
+        {
+            karatsuba_multiply(a, b, n, out, scratch);
+        }
+        else
+        {
+            toom3_multiply(a, b, n, out, scratch);
+        }
+    }
+
+    size_t multiply_scratch_size(size_t a_size, size_t b_size) noexcept
+    {
+        if (a_size < b_size)
+        {
+            std::swap(a_size, b_size);
+        }
+        if (b_size < Karatsuba_base_threshold)
+        {
+            return 0;
+        }
+
+        const size_t balanced = balanced_scratch_size(b_size);
+        if (a_size == b_size)
+        {
+            return balanced;
+        }
+
+        const size_t last = a_size % b_size == 0 ? 0 : multiply_scratch_size(b_size, a_size % b_size);
+        return std::max(balanced, 2 * b_size + std::max(balanced, last));
+    }
+
+    /** out[0, a_size + b_size) = a * b, the longer operand is cut in pieces as long as the shorter one.
+     *  scratch holds multiply_scratch_size(a_size, b_size) limbs
+     */
+    void recursive_multiply(const unsigned int* a, size_t a_size, const unsigned int* b, size_t b_size,
+                            unsigned int* out, unsigned int* scratch) noexcept
+    {
+        if (a_size < b_size)
+        {
+            std::swap(a, b);
+            std::swap(a_size, b_size);
+        }
+        if (b_size < Karatsuba_base_threshold)
+        {
+            schoolbook_multiply(a, a_size, b, b_size, out);
+            return;
+        }
+
+        balanced_multiply(a, b, b_size, out, scratch);
+        std::fill(out + 2 * b_size, out + a_size + b_size, 0);
+
+        unsigned int* piece = scratch;
+        for (size_t offset = b_size; offset < a_size; offset += b_size)
+        {
+            const size_t piece_size = std::min(b_size, a_size - offset);
+
+            recursive_multiply(a + offset, piece_size, b, b_size, piece, scratch + 2 * b_size);
+            limb_addmul(out + offset, a_size + b_size - offset, piece, piece_size + b_size, 1);
+        }
+    }
+
+    /*
+     * Multiplication through number theoretic transforms. The limbs are convolved modulo three
+     * primes of the form c * 2^k + 1 and the exact convolution is put back together by the CRT:
+     * a coefficient is below min(a_size, b_size) * 2^64, and the product of the primes is above
+     * 2^86, so every coefficient is exact as long as the product has at most 2^23 limbs, which is
+     * also the longest transform the first prime allows. Longer products are split.
+     */
+
+    constexpr unsigned int ntt_prime_1 = 998244353; // 119 * 2^23 + 1
+    constexpr unsigned int ntt_prime_2 = 167772161; // 5 * 2^25 + 1
+    constexpr unsigned int ntt_prime_3 = 469762049; // 7 * 2^26 + 1
+    constexpr unsigned int ntt_root = 3; // primitive root of all three
+
+    constexpr size_t max_ntt_size = size_t(1) << 23;
+
+    constexpr unsigned int pow_mod(unsigned long long base, unsigned long long exponent, unsigned int mod) noexcept
+    {
+        unsigned long long result = 1;
+        base %= mod;
+
+        while (exponent != 0)
+        {
+            if (exponent & 1)
+            {
+                result = result * base % mod;
+            }
+            base = base * base % mod;
+            exponent >>= 1;
+        }
+
+        return static_cast<unsigned int>(result);
+    }
+
+    /** Forward transform, the output is in bit-reversed order. `roots[len + k]` is w_{2 len}^k
+     */
+    template<unsigned int Mod>
+    void ntt_forward(unsigned int* a, size_t n, const unsigned int* roots) noexcept
+    {
+        for (size_t len = n / 2; len >= 1; len /= 2)
+        {
+            for (size_t i = 0; i < n; i += 2 * len)
+            {
+                for (size_t k = 0; k < len; ++k)
+                {
+                    const unsigned int u = a[i + k];
+                    const unsigned int v = a[i + k + len];
+                    const unsigned int sum = u + v;
+
+                    a[i + k] = sum >= Mod ? sum - Mod : sum;
+                    a[i + k + len] = static_cast<unsigned int>(static_cast<unsigned long long>(u + Mod - v) * roots[len + k] % Mod);
+                }
+            }
+        }
+    }
+
+    /** Inverse of ntt_forward up to the factor n, takes bit-reversed input and gives natural order
+     */
+    template<unsigned int Mod>
+    void ntt_inverse(unsigned int* a, size_t n, const unsigned int* inverse_roots) noexcept
+    {
+        for (size_t len = 1; len < n; len *= 2)
+        {
+            for (size_t i = 0; i < n; i += 2 * len)
+            {
+                for (size_t k = 0; k < len; ++k)
+                {
+                    const unsigned int u = a[i + k];
+                    const unsigned int v = static_cast<unsigned int>(static_cast<unsigned long long>(a[i + k + len]) * inverse_roots[len + k] % Mod);
+                    const unsigned int sum = u + v;
+
+                    a[i + k] = sum >= Mod ? sum - Mod : sum;
+                    a[i + k + len] = u >= v ? u - v : u + Mod - v;
+                }
+            }
+        }
+    }
+
+    template<unsigned int Mod>
+    void fill_roots(unsigned int* roots, size_t n, bool inverse) noexcept
+    {
+        for (size_t len = 1; len < n; len *= 2)
+        {
+            unsigned int w = pow_mod(ntt_root, (Mod - 1) / (2 * len), Mod);
+            if (inverse)
+            {
+                w = pow_mod(w, Mod - 2, Mod);
+            }
+
+            roots[len] = 1;
+            for (size_t k = 1; k < len; ++k)
+            {
+                roots[len + k] = static_cast<unsigned int>(static_cast<unsigned long long>(roots[len + k - 1]) * w % Mod);
+            }
+        }
+    }
+
+    /** `fa` gets the cyclic convolution of a and b modulo Mod, `fb` and `roots` are scratch of n elements
+     */
+    template<unsigned int Mod>
+    void ntt_convolve(const unsigned int* a, size_t a_size, const unsigned int* b, size_t b_size,
+                      unsigned int* fa, unsigned int* fb, unsigned int* roots, size_t n) noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            fa[i] = i < a_size ? a[i] % Mod : 0;
+            fb[i] = i < b_size ? b[i] % Mod : 0;
+        }
+
+        fill_roots<Mod>(roots, n, false);
+        ntt_forward<Mod>(fa, n, roots);
+        ntt_forward<Mod>(fb, n, roots);
+
+        const unsigned int n_inverse = pow_mod(n, Mod - 2, Mod);
+        for (size_t i = 0; i < n; ++i)
+        {
+            fa[i] = static_cast<unsigned int>(static_cast<unsigned long long>(fa[i]) * fb[i] % Mod * n_inverse % Mod);
+        }
+
+        fill_roots<Mod>(roots, n, true);
+        ntt_inverse<Mod>(fa, n, roots);
+    }
+
+    /** out[0, a_size + b_size) = a * b, out may not overlap the operands
+     */
+    void ntt_multiply(const unsigned int* a, size_t a_size, const unsigned int* b, size_t b_size,
+                      unsigned int* out, const pp_allocator<unsigned int>& allocator)
+    {
+        if (a_size + b_size > max_ntt_size)
+        {
+            if (a_size < b_size)
+            {
+                std::swap(a, b);
+                std::swap(a_size, b_size);
+            }
+
+            const size_t half = a_size / 2;
+            std::vector<unsigned int, pp_allocator<unsigned int>> high(a_size - half + b_size, 0, allocator);
+
+            ntt_multiply(a, half, b, b_size, out, allocator);
+            ntt_multiply(a + half, a_size - half, b, b_size, high.data(), allocator);
+
+            std::fill(out + half + b_size, out + a_size + b_size, 0);
+
+            unsigned long long carry = 0;
+            for (size_t i = 0; i < high.size(); ++i)
+            {
+                carry += static_cast<unsigned long long>(out[half + i]) + high[i];
+                out[half + i] = static_cast<unsigned int>(carry);
+                carry >>= 32;
+            }
+            return;
+        }
+
+        size_t n = 1;
+        while (n < a_size + b_size - 1)
+        {
+            n *= 2;
+        }
+
+        std::vector<unsigned int, pp_allocator<unsigned int>> scratch(5 * n, 0, allocator);
+        unsigned int* fa = scratch.data();
+        unsigned int* fb = fa + n;
+        unsigned int* roots = fb + n;
+        unsigned int* r1 = roots + n;
+        unsigned int* r2 = r1 + n;
+
+        ntt_convolve<ntt_prime_1>(a, a_size, b, b_size, r1, fb, roots, n);
+        ntt_convolve<ntt_prime_2>(a, a_size, b, b_size, r2, fb, roots, n);
+        ntt_convolve<ntt_prime_3>(a, a_size, b, b_size, fa, fb, roots, n);
+
+        // Garner: x = x1 + x2 * p1 + x3 * p1 * p2, with x1 < p1, x2 < p2, x3 < p3
+        constexpr unsigned long long p1 = ntt_prime_1;
+        constexpr unsigned long long p1_p2 = p1 * ntt_prime_2;
+        constexpr unsigned long long p1_inverse = pow_mod(ntt_prime_1, ntt_prime_2 - 2, ntt_prime_2);
+        constexpr unsigned long long p1_p2_inverse = pow_mod(p1_p2 % ntt_prime_3, ntt_prime_3 - 2, ntt_prime_3);
+        constexpr unsigned long long mask = 0xFFFFFFFF;
+
+        // what is left of the sum after the limbs written so far, stays below 2^55
+        unsigned long long carry = 0;
+
+        for (size_t i = 0; i < a_size + b_size; ++i)
+        {
+            // the top limb only ever gets the carry
+            const bool in_convolution = i + 1 < a_size + b_size;
+
+            const unsigned long long x1 = in_convolution ? r1[i] : 0;
+            const unsigned long long x2 = in_convolution ? (r2[i] + ntt_prime_2 - x1 % ntt_prime_2) * p1_inverse % ntt_prime_2 : 0;
+            const unsigned long long low = x1 + x2 * p1;
+            const unsigned long long x3 = in_convolution ? (fa[i] + ntt_prime_3 - low % ntt_prime_3) * p1_p2_inverse % ntt_prime_3 : 0;
+
+            const unsigned long long high_low = x3 * (p1_p2 & mask);
+            const unsigned long long high_high = x3 * (p1_p2 >> 32);
+
+            const unsigned long long column_0 = (carry & mask) + (low & mask) + (high_low & mask);
+            const unsigned long long column_1 = (carry >> 32) + (low >> 32) + (high_low >> 32) + (high_high & mask) + (column_0 >> 32);
+            const unsigned long long column_2 = (high_high >> 32) + (column_1 >> 32);
+
+            out[i] = static_cast<unsigned int>(column_0);
+            carry = (column_1 & mask) | (column_2 << 32);
+        }
+    }
+
+    // from this many limbs in the shorter operand the transform beats Karatsuba and Toom-3
+    constexpr size_t SchonhageStrassen_threshold = 3072;
+
+    /** out[0, a_size + b_size) = a * b with whichever of the span multipliers is fastest for the sizes
+     */
+    void multiply_limbs(const unsigned int* a, size_t a_size, const unsigned int* b, size_t b_size,
+                        unsigned int* out, const pp_allocator<unsigned int>& allocator)
+    {
+        if (std::min(a_size, b_size) >= SchonhageStrassen_threshold)
+        {
+            ntt_multiply(a, a_size, b, b_size, out, allocator);
+            return;
+        }
+
+        std::vector<unsigned int, pp_allocator<unsigned int>> scratch(multiply_scratch_size(a_size, b_size), 0, allocator);
+        recursive_multiply(a, a_size, b, b_size, out, scratch.data());
+    }
+
+    /** r[0, size) = a << bits for bits < 32, returns the bits shifted out. r may be a
+     */
+    unsigned int limb_shift_left(unsigned int* r, const unsigned int* a, size_t size, unsigned int bits) noexcept
+    {
+        if (bits == 0)
+        {
+            if (r != a)
+            {
+                std::copy(a, a + size, r);
+            }
+            return 0;
+        }
+
+        unsigned int carry = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            const unsigned int limb = a[i];
+            r[i] = (limb << bits) | carry;
+            carry = limb >> (32 - bits);
+        }
+
+        return carry;
+    }
+
+    /** r[0, size) = a >> bits for bits < 32. r may be a
+     */
+    void limb_shift_right(unsigned int* r, const unsigned int* a, size_t size, unsigned int bits) noexcept
+    {
+        if (bits == 0)
+        {
+            if (r != a)
+            {
+                std::copy(a, a + size, r);
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            r[i] = (a[i] >> bits) | (i + 1 < size ? a[i + 1] << (32 - bits) : 0);
+        }
+    }
+
+    /*
+     * Division. Both algorithms want a normalised divisor, one whose top limb has its top bit set;
+     * the dividend is shifted along and the remainder shifted back at the end.
+     */
+
+    // divisors shorter than this are left to algorithm D, Burnikel-Ziegler recursion stops there too
+    constexpr size_t BurnikelZiegler_threshold = 64;
+
+    /** Knuth's algorithm D. The top v_size limbs of u must be below v, and v must be normalised.
+     *  q gets u_size - v_size limbs, the low v_size limbs of u are left holding the remainder
+     */
+    void knuth_divide(unsigned int* u, size_t u_size, const unsigned int* v, size_t v_size, unsigned int* q) noexcept
+    {
+        const size_t m = u_size - v_size;
+        const unsigned long long v_top = v[v_size - 1];
+
+        if (v_size == 1)
+        {
+            unsigned long long remainder = u[u_size - 1];
+
+            for (size_t j = m; j-- > 0;)
+            {
+                const unsigned long long current = (remainder << 32) | u[j];
+                q[j] = static_cast<unsigned int>(current / v_top);
+                remainder = current % v_top;
+            }
+            u[0] = static_cast<unsigned int>(remainder);
+            return;
+        }
+
+        const unsigned long long v_next = v[v_size - 2];
+
+        for (size_t j = m; j-- > 0;)
+        {
+            const unsigned long long numerator = (static_cast<unsigned long long>(u[j + v_size]) << 32) | u[j + v_size - 1];
+            unsigned long long q_hat = numerator / v_top;
+            unsigned long long r_hat = numerator % v_top;
+
+            // at most two steps bring the estimate to the true digit or one above it
+            while (q_hat >= BASE || q_hat * v_next > ((r_hat << 32) | u[j + v_size - 2]))
+            {
+                --q_hat;
+                r_hat += v_top;
+                if (r_hat >= BASE)
+                {
+                    break;
+                }
+            }
+
+            if (limb_submul(u + j, v_size + 1, v, v_size, static_cast<unsigned int>(q_hat)) != 0)
+            {
+                --q_hat;
+                limb_add(u + j, u + j, v_size + 1, v, v_size);
+            }
+            q[j] = static_cast<unsigned int>(q_hat);
+        }
+    }
+
+    void divide_3h_2h(const unsigned int* a, const unsigned int* b, size_t h, unsigned int* q, unsigned int* r,
+                      const pp_allocator<unsigned int>& allocator);
+
+    /** Burnikel-Ziegler: a[0, 2n) / b[0, n) into q[0, n) and r[0, n) for normalised b and a < b * BASE^n
+     */
+    void divide_2n_1n(const unsigned int* a, const unsigned int* b, size_t n, unsigned int* q, unsigned int* r,
+                      const pp_allocator<unsigned int>& allocator)
+    {
+        if (n % 2 == 1 || n <= BurnikelZiegler_threshold)
+        {
+            std::vector<unsigned int, pp_allocator<unsigned int>> u(a, a + 2 * n, allocator);
+            knuth_divide(u.data(), 2 * n, b, n, q);
+            std::copy(u.begin(), u.begin() + n, r);
+            return;
+        }
+
+        const size_t h = n / 2;
+
+        // the top three quarters give the high half of the quotient, their remainder and the
+        // last quarter the low one
+        std::vector<unsigned int, pp_allocator<unsigned int>> lower(3 * h, 0, allocator);
+        divide_3h_2h(a + h, b, h, q + h, lower.data() + h, allocator);
+        std::copy(a, a + h, lower.begin());
+        divide_3h_2h(lower.data(), b, h, q, r, allocator);
+    }
+
+    /** Burnikel-Ziegler: a[0, 3h) / b[0, 2h) into q[0, h) and r[0, 2h) for normalised b and a < b * BASE^h.
+     *  The top two thirds are divided by the top half of b and the estimate is corrected by at most two
+     */
+    void divide_3h_2h(const unsigned int* a, const unsigned int* b, size_t h, unsigned int* q, unsigned int* r,
+                      const pp_allocator<unsigned int>& allocator)
+    {
+        // x = (a1 a2 mod b1) * BASE^h + a3, with room for the carry of the a1 == b1 case
+        std::vector<unsigned int, pp_allocator<unsigned int>> x(2 * h + 1, 0, allocator);
+        std::copy(a, a + h, x.begin());
+
+        if (limb_compare(a + 2 * h, h, b + h, h) < 0)
+        {
+            divide_2n_1n(a + h, b + h, h, q, x.data() + h, allocator);
+        }
+        else
+        {
+            // a1 == b1, the digit is BASE^h - 1 and a1 a2 - q b1 = a2 + b1
+            std::fill(q, q + h, 0xFFFFFFFF);
+            x[2 * h] = limb_add(x.data() + h, a + h, h, b + h, h);
+        }
+
+        std::vector<unsigned int, pp_allocator<unsigned int>> d(2 * h, 0, allocator);
+        multiply_limbs(q, h, b, h, d.data(), allocator);
+
+        bool negative = limb_sub(x.data(), x.data(), 2 * h + 1, d.data(), 2 * h) != 0;
+        while (negative)
+        {
+            for (size_t i = 0; q[i]-- == 0; ++i)
+            {
+            }
+            negative = limb_add(x.data(), x.data(), 2 * h + 1, b, 2 * h) == 0;
+        }
+
+        std::copy(x.begin(), x.begin() + 2 * h, r);
+    }
+
+    // reciprocals of divisors shorter than this come straight out of algorithm D
+    constexpr size_t Newton_base_threshold = 64;
+
+    // from this many divisor limbs on the reciprocal beats Burnikel-Ziegler for any quotient length
+    constexpr size_t Newton_threshold = 24576;
+
+    /** out[0, a_size + n + 1) = a * x for a reciprocal x[0, n + 1). Its top limb is one, or off by a
+     *  few from it, so the product is done on the low n limbs
+     */
+    void multiply_by_reciprocal(const unsigned int* a, size_t a_size, const unsigned int* x, size_t n,
+                                unsigned int* out, const pp_allocator<unsigned int>& allocator)
+    {
+        multiply_limbs(a, a_size, x, n, out, allocator);
+        out[a_size + n] = 0;
+        limb_addmul(out + n, a_size + 1, a, a_size, x[n]);
+    }
+
+    /** inverse[0, n + 1) within a few units of floor((BASE^2n - 1) / v) for normalised v[0, n), and
+     *  exactly it if exact is set. The reciprocal of the top half of v is refined by one Newton step
+     *  x += x (BASE^2n - v x) / BASE^2n, the step taken from the top limbs of x and of the error only
+     */
+    void newton_reciprocal(const unsigned int* v, size_t n, unsigned int* inverse, bool exact,
+                           const pp_allocator<unsigned int>& allocator)
+    {
+        if (n <= Newton_base_threshold)
+        {
+            // a leading zero limb keeps the top of the dividend below v
+            std::vector<unsigned int, pp_allocator<unsigned int>> u(2 * n + 1, 0xFFFFFFFF, allocator);
+            u[2 * n] = 0;
+            knuth_divide(u.data(), 2 * n + 1, v, n, inverse);
+            return;
+        }
+
+        // one guard limb over half, so that the squared error of the estimate is a few units
+        const size_t h = n / 2 + 2;
+
+        std::fill(inverse, inverse + n + 1, 0);
+        newton_reciprocal(v + n - h, h, inverse + n - h, false, allocator);
+
+        std::vector<unsigned int, pp_allocator<unsigned int>> product(2 * n + 1, 0, allocator);
+        multiply_by_reciprocal(v, n, inverse, n, product.data(), allocator);
+
+        // the error BASE^2n - v x in magnitude, it is about BASE^(2n - h) long
+        std::vector<unsigned int, pp_allocator<unsigned int>> error(2 * n + 1, 0, allocator);
+        error[2 * n] = 1;
+        const bool overshoot = limb_compare(product.data(), 2 * n + 1, error.data(), 2 * n + 1) > 0;
+        if (overshoot)
+        {
+            limb_sub(error.data(), product.data(), 2 * n + 1, error.data(), 2 * n + 1);
+        }
+        else
+        {
+            limb_sub(error.data(), error.data(), 2 * n + 1, product.data(), 2 * n + 1);
+        }
+
+        size_t error_size = 2 * n + 1;
+        while (error_size > 1 && error[error_size - 1] == 0)
+        {
+            --error_size;
+        }
+
+        // the step is about BASE^(n - h) long, limbs of x and of the error below what it needs
+        // change it by less than a unit
+        const size_t keep = n - h + 3;
+        const size_t x_dropped = n + 1 - keep;
+        const size_t error_dropped = error_size > keep ? error_size - keep : 0;
+        const size_t shift = 2 * n - x_dropped - error_dropped;
+
+        std::vector<unsigned int, pp_allocator<unsigned int>> step(keep + error_size - error_dropped, 0, allocator);
+        multiply_limbs(inverse + x_dropped, keep, error.data() + error_dropped, error_size - error_dropped, step.data(), allocator);
+
+        if (step.size() > shift)
+        {
+            if (overshoot)
+            {
+                limb_sub(inverse, inverse, n + 1, step.data() + shift, std::min(step.size() - shift, n + 1));
+            }
+            else
+            {
+                limb_addmul(inverse, n + 1, step.data() + shift, step.size() - shift, 1);
+            }
+        }
+
+        if (!exact)
+        {
+            return;
+        }
+
+        // v x <= BASE^2n - 1 < v (x + 1)
+        multiply_by_reciprocal(v, n, inverse, n, product.data(), allocator);
+        while (product[2 * n] != 0)
+        {
+            for (size_t i = 0; inverse[i]-- == 0; ++i)
+            {
+            }
+            limb_sub(product.data(), product.data(), 2 * n + 1, v, n);
+        }
+
+        std::vector<unsigned int, pp_allocator<unsigned int>> slack(2 * n, 0xFFFFFFFF, allocator);
+        limb_sub(slack.data(), slack.data(), 2 * n, product.data(), 2 * n);
+        while (limb_compare(slack.data(), 2 * n, v, n) >= 0)
+        {
+            for (size_t i = 0; ++inverse[i] == 0; ++i)
+            {
+            }
+            limb_sub(slack.data(), slack.data(), 2 * n, v, n);
+        }
+    }
+
+    /** Barrett step: a[0, 2n) / b[0, n) into q[0, n) and r[0, n) for normalised b, a < b * BASE^n and
+     *  the exact reciprocal of newton_reciprocal. The estimate from the top n limbs is a few units short at most
+     */
+    void barrett_divide_2n_1n(const unsigned int* a, const unsigned int* b, const unsigned int* inverse, size_t n,
+                              unsigned int* q, unsigned int* r, const pp_allocator<unsigned int>& allocator)
+    {
+        std::vector<unsigned int, pp_allocator<unsigned int>> estimate(2 * n + 1, 0, allocator);
+        multiply_by_reciprocal(a + n, n, inverse, n, estimate.data(), allocator);
+
+        // q_hat is below BASE^n, so only its low n limbs are taken
+        const unsigned int* q_hat = estimate.data() + n;
+
+        std::vector<unsigned int, pp_allocator<unsigned int>> rest(2 * n, 0, allocator);
+        multiply_limbs(q_hat, n, b, n, rest.data(), allocator);
+        limb_sub(rest.data(), a, 2 * n, rest.data(), 2 * n);
+
+        std::copy(q_hat, q_hat + n, q);
+        while (limb_compare(rest.data(), n + 1, b, n) >= 0)
+        {
+            for (size_t i = 0; ++q[i] == 0; ++i)
+            {
+            }
+            limb_sub(rest.data(), rest.data(), n + 1, b, n);
+        }
+
+        std::copy(rest.begin(), rest.begin() + n, r);
+    }
 
-    // return multiplication_rule::Karatsuba;
-     
+    /** Brings q[0, q_size) within a few units of u / v to the exact quotient, q_size + v_size = u_size + 1.
+     *  The remainder goes to remainder[0, v_size) unless it is null
+     */
+    void correct_quotient(const unsigned int* u, size_t u_size, const unsigned int* v, size_t v_size,
+                          unsigned int* q, size_t q_size, unsigned int* remainder, const pp_allocator<unsigned int>& allocator)
+    {
+        std::vector<unsigned int, pp_allocator<unsigned int>> product(u_size + 1, 0, allocator);
+        multiply_limbs(q, q_size, v, v_size, product.data(), allocator);
+
+        while (limb_compare(product.data(), u_size + 1, u, u_size) > 0)
+        {
+            for (size_t i = 0; q[i]-- == 0; ++i)
+            {
+            }
+            limb_sub(product.data(), product.data(), u_size + 1, v, v_size);
+        }
+
+        limb_sub(product.data(), u, u_size, product.data(), u_size);
+        while (limb_compare(product.data(), u_size, v, v_size) >= 0)
+        {
+            for (size_t i = 0; ++q[i] == 0; ++i)
+            {
+            }
+            limb_sub(product.data(), product.data(), u_size, v, v_size);
+        }
+
+        if (remainder != nullptr)
+        {
+            std::copy(product.begin(), product.begin() + v_size, remainder);
+        }
+    }
+
+    /** Quotient and remainder of u / v into u_size - v_size + 1 and v_size limbs, u_size >= v_size and
+     *  v's top limb is not zero. Either output may be null
+     */
+    void divide_limbs(const unsigned int* u, size_t u_size, const unsigned int* v, size_t v_size,
+                      unsigned int* quotient, unsigned int* remainder, big_int::division_rule rule,
+                      const pp_allocator<unsigned int>& allocator)
+    {
+        const unsigned int bits = static_cast<unsigned int>(std::countl_zero(v[v_size - 1]));
+        const size_t quotient_size = u_size - v_size + 1;
+
+        if (rule == big_int::division_rule::Newton && quotient_size + 1 < v_size)
+        {
+            // a short quotient only depends on the top of the divisor: dividing the tops is off by a
+            // few units at most, the whole divisor then settles it
+            const size_t dropped = v_size - quotient_size - 1;
+
+            std::vector<unsigned int, pp_allocator<unsigned int>> q(quotient_size, 0, allocator);
+            divide_limbs(u + dropped, u_size - dropped, v + dropped, v_size - dropped, q.data(), nullptr, rule, allocator);
+            correct_quotient(u, u_size, v, v_size, q.data(), quotient_size, remainder, allocator);
+
+            if (quotient != nullptr)
+            {
+                std::copy(q.begin(), q.end(), quotient);
+            }
+            return;
+        }
+
+        if (rule == big_int::division_rule::trivial)
+        {
+            std::vector<unsigned int, pp_allocator<unsigned int>> un(u_size + 1, 0, allocator);
+            std::vector<unsigned int, pp_allocator<unsigned int>> vn(v_size, 0, allocator);
+            std::vector<unsigned int, pp_allocator<unsigned int>> q(u_size - v_size + 1, 0, allocator);
+
+            limb_shift_left(vn.data(), v, v_size, bits);
+            un[u_size] = limb_shift_left(un.data(), u, u_size, bits);
+            knuth_divide(un.data(), u_size + 1, vn.data(), v_size, q.data());
+
+            if (quotient != nullptr)
+            {
+                std::copy(q.begin(), q.end(), quotient);
+            }
+            if (remainder != nullptr)
+            {
+                limb_shift_right(remainder, un.data(), v_size, bits);
+            }
+            return;
+        }
+
+        // both divide blockwise, with the divisor padded at the bottom to the block size n
+        size_t n = v_size;
+        if (rule == big_int::division_rule::BurnikelZiegler)
+        {
+            // blocks of n = j * 2^k limbs with j <= BurnikelZiegler_threshold, so that every halving
+            // on the way down to algorithm D is exact
+            size_t halvings = 0;
+            while ((v_size >> halvings) > BurnikelZiegler_threshold)
+            {
+                ++halvings;
+            }
+            n = ((v_size + (size_t(1) << halvings) - 1) >> halvings) << halvings;
+        }
+        else
+        {
+            // a top block holding just the spare limb would cost a whole step, a little padding
+            // spreads the dividend over one block less
+            const size_t blocks = (u_size + v_size) / v_size;
+            if (blocks > 2)
+            {
+                const size_t extra = (u_size + 1 - (blocks - 1) * v_size + blocks - 3) / (blocks - 2);
+                if (extra <= v_size / 8)
+                {
+                    n += extra;
+                }
+            }
+        }
+        const size_t padding = n - v_size;
+
+        std::vector<unsigned int, pp_allocator<unsigned int>> b(n, 0, allocator);
+        limb_shift_left(b.data() + padding, v, v_size, bits);
+
+        std::vector<unsigned int, pp_allocator<unsigned int>> inverse(allocator);
+        if (rule == big_int::division_rule::Newton)
+        {
+            inverse.resize(n + 1, 0);
+            newton_reciprocal(b.data(), n, inverse.data(), true, allocator);
+        }
+
+        // one limb more than the shifted dividend needs keeps the top block below b
+        const size_t a_size = u_size + padding + 1;
+        const size_t blocks = (a_size + n - 1) / n;
+
+        std::vector<unsigned int, pp_allocator<unsigned int>> a(blocks * n, 0, allocator);
+        a[u_size + padding] = limb_shift_left(a.data() + padding, u, u_size, bits);
+
+        std::vector<unsigned int, pp_allocator<unsigned int>> q((blocks - 1) * n, 0, allocator);
+        std::vector<unsigned int, pp_allocator<unsigned int>> z(a.end() - 2 * n, a.end(), allocator);
+
+        for (size_t i = blocks - 1; i-- > 0;)
+        {
+            if (rule == big_int::division_rule::Newton)
+            {
+                barrett_divide_2n_1n(z.data(), b.data(), inverse.data(), n, q.data() + i * n, z.data() + n, allocator);
+            }
+            else
+            {
+                divide_2n_1n(z.data(), b.data(), n, q.data() + i * n, z.data() + n, allocator);
+            }
+            if (i > 0)
+            {
+                std::copy(a.begin() + (i - 1) * n, a.begin() + i * n, z.begin());
+            }
+        }
+
+        if (quotient != nullptr)
+        {
+            std::fill(quotient, quotient + quotient_size, 0);
+            std::copy(q.begin(), q.begin() + std::min(quotient_size, q.size()), quotient);
+        }
+        if (remainder != nullptr)
+        {
+            limb_shift_right(remainder, z.data() + n + padding, v_size, bits);
+        }
+    }
+}
 
-    const size_t threshold = 64;
+big_int::multiplication_rule big_int::decide_mult(size_t rhs) const noexcept
+{
+    // measured crossovers, by the shorter operand: the longer one is cut in pieces of its length.
+    // the Karatsuba rule switches to Toom-3 on its own from Toom3_threshold limbs
+    const size_t shorter = std::min(_digits.size(), rhs);
 
-    if (_digits.size() > threshold || rhs > threshold) {
+    if (shorter >= SchonhageStrassen_threshold)
+    {
+        return multiplication_rule::SchonhageStrassen;
+    }
+    if (shorter >= Karatsuba_base_threshold)
+    {
         return multiplication_rule::Karatsuba;
     }
     return multiplication_rule::trivial;
-
 }
 
-big_int::division_rule big_int::decide_div(size_t) const noexcept
+big_int::division_rule big_int::decide_div(size_t rhs) const noexcept
 {
+    if (rhs >= Newton_threshold)
+    {
+        return division_rule::Newton;
+    }
 
+    // measured: recursion pays off once the divisor spans a couple of base case blocks and the
+    // quotient is long too, a quotient much shorter than the divisor still costs whole blocks
+    if (rhs >= 2 * BurnikelZiegler_threshold && _digits.size() >= rhs + std::max(8 * BurnikelZiegler_threshold, rhs / 2))
+    {
+        return division_rule::BurnikelZiegler;
+    }
     return division_rule::trivial;
 }
 
@@ -292,100 +1363,22 @@ big_int& big_int::multiply_assign(const big_int& other, multiplication_rule rule
         return *this;
     }
 
-    if (rule == multiplication_rule::Karatsuba) {
-        size_t n = std::max(_digits.size(), other._digits.size());
-        size_t m = n / 2 + (n % 2);
-        
-        if (n <= 4) {
-            return multiply_assign(other, multiplication_rule::trivial);
-        }
-        
-        std::vector<unsigned int, pp_allocator<unsigned int>> a_high(_digits.get_allocator());
-        std::vector<unsigned int, pp_allocator<unsigned int>> a_low(_digits.get_allocator());
-        std::vector<unsigned int, pp_allocator<unsigned int>> b_high(other._digits.get_allocator());
-        std::vector<unsigned int, pp_allocator<unsigned int>> b_low(other._digits.get_allocator());
-        
-        if (_digits.size() <= m) {
-            a_low = _digits;
-            a_high.push_back(0);
-        } else {
-            a_low.assign(_digits.begin(), _digits.begin() + m);
-            a_high.assign(_digits.begin() + m, _digits.end());
-        }
-        
-        if (other._digits.size() <= m) {
-            b_low = other._digits;
-            b_high.push_back(0);
-        } else {
-            b_low.assign(other._digits.begin(), other._digits.begin() + m);
-            b_high.assign(other._digits.begin() + m, other._digits.end());
-        }
-        
-        optimise(a_low);
-        optimise(a_high);
-        optimise(b_low);
-        optimise(b_high);
-        
-        big_int z0(a_low, true);
-        z0.multiply_assign(big_int(b_low, true), multiplication_rule::trivial);
-        
-        big_int z2(a_high, true);
-        z2.multiply_assign(big_int(b_high, true), multiplication_rule::trivial);
-        
-        big_int a_sum(a_low, true);
-        a_sum += big_int(a_high, true);
-        
-        big_int b_sum(b_low, true);
-        b_sum += big_int(b_high, true);
-        
-        big_int z1(a_sum);
-        z1.multiply_assign(b_sum, multiplication_rule::trivial);
-        z1 -= z0;
-        z1 -= z2;
-        
-        std::vector<unsigned int, pp_allocator<unsigned int>> result(_digits.get_allocator());
-        result.resize(n * 2, 0);
-        
-        for (size_t i = 0; i < z0._digits.size(); ++i) {
-            result[i] = z0._digits[i];
-        }
-        
-        for (size_t i = 0; i < z1._digits.size(); ++i) {
-            unsigned long long temp = static_cast<unsigned long long>(result[i + m]) + z1._digits[i];
-            result[i + m] = static_cast<unsigned int>(temp % BASE);
-            if (temp >= BASE) {
-                unsigned long long carry = temp / BASE;
-                size_t j = i + m + 1;
-                while (carry > 0 && j < result.size()) {
-                    unsigned long long next = static_cast<unsigned long long>(result[j]) + carry;
-                    result[j] = static_cast<unsigned int>(next % BASE);
-                    carry = next / BASE;
-                    j++;
-                }
-                if (carry > 0) {
-                    result.push_back(static_cast<unsigned int>(carry));
-                }
-            }
-        }
-                
-        for (size_t i = 0; i < z2._digits.size(); ++i) {
-            unsigned long long temp = static_cast<unsigned long long>(result[i + 2*m]) + z2._digits[i];
-            result[i + 2*m] = static_cast<unsigned int>(temp % BASE);
-            if (temp >= BASE) {
-                unsigned long long carry = temp / BASE;
-                size_t j = i + 2*m + 1;
-                while (carry > 0 && j < result.size()) {
-                    unsigned long long next = static_cast<unsigned long long>(result[j]) + carry;
-                    result[j] = static_cast<unsigned int>(next % BASE);
-                    carry = next / BASE;
-                    j++;
-                }
-                if (carry > 0) {
-                    result.push_back(static_cast<unsigned int>(carry));
-                }
-            }
-        }
-        
+    if (rule == multiplication_rule::Karatsuba)
+    {
+        std::vector<unsigned int, pp_allocator<unsigned int>> result(_digits.size() + other._digits.size(), 0, _digits.get_allocator());
+        std::vector<unsigned int, pp_allocator<unsigned int>> scratch(multiply_scratch_size(_digits.size(), other._digits.size()), 0, _digits.get_allocator());
+        recursive_multiply(_digits.data(), _digits.size(), other._digits.data(), other._digits.size(), result.data(), scratch.data());
+
+        _sign = (_sign == other._sign);
+        _digits = std::move(result);
+        optimise(_digits);
+        return *this;
+    }
+    else if (rule == multiplication_rule::SchonhageStrassen)
+    {
+        std::vector<unsigned int, pp_allocator<unsigned int>> result(_digits.size() + other._digits.size(), 0, _digits.get_allocator());
+        ntt_multiply(_digits.data(), _digits.size(), other._digits.data(), other._digits.size(), result.data(), _digits.get_allocator());
+
         _sign = (_sign == other._sign);
         _digits = std::move(result);
         optimise(_digits);
@@ -439,12 +1432,7 @@ big_int& big_int::divide_assign(const big_int& other, division_rule rule) &
         return *this;
     }
 
-    big_int abs_this(*this);
-    abs_this._sign = true;
-    big_int abs_other(other);
-    abs_other._sign = true;
-
-    if (abs_this < abs_other)
+    if (limb_compare(_digits.data(), _digits.size(), other._digits.data(), other._digits.size()) < 0)
     {
         _digits.clear();
         _digits.push_back(0);
@@ -453,52 +1441,8 @@ big_int& big_int::divide_assign(const big_int& other, division_rule rule) &
     }
     
     std::vector<unsigned int, pp_allocator<unsigned int>> quotient(_digits.size() - other._digits.size() + 1, 0, _digits.get_allocator());
-    big_int remainder(_digits.get_allocator());
-    remainder._digits.clear();
-    remainder._digits.push_back(0);
-    
-    for (int i = static_cast<int>(_digits.size()) - 1; i >= 0; --i)
-    {
-        remainder._digits.insert(remainder._digits.begin(), _digits[i]);
-        optimise(remainder._digits);
-    
-        if (remainder < abs_other)
-        {
-            if (i < static_cast<int>(quotient.size()))
-                quotient[i] = 0;
-            continue;
-        }
-
-        unsigned long long left = 0, right = BASE - 1;
-        unsigned long long q = 0;
-        while (left <= right)
-        {
-            unsigned long long mid = left + (right - left) / 2;
-            big_int temp(abs_other);
-            temp *= big_int(static_cast<long long>(mid), _digits.get_allocator());
-            if (remainder >= temp)
-            {
-                q = mid;
-                left = mid + 1;
-            }
-            else
-            {
-                right = mid - 1;
-            }
-        }
-
-    
-        if (q > 0)
-        {
-            big_int temp(abs_other);
-            temp *= big_int(static_cast<long long>(q), _digits.get_allocator());
-            remainder -= temp;
-        }
-
-    
-        if (i < static_cast<int>(quotient.size()))
-            quotient[i] = static_cast<unsigned int>(q);
-    }
+    divide_limbs(_digits.data(), _digits.size(), other._digits.data(), other._digits.size(),
+                 quotient.data(), nullptr, rule, _digits.get_allocator());
 
     _digits = std::move(quotient);
     _sign = (_sign == other._sign);
@@ -523,6 +1467,62 @@ big_int& big_int::operator%=(const big_int& other) &
     return modulo_assign(other, decide_div(other._digits.size()));
 }
 
+big_int& big_int::divmod_assign(const big_int& other, big_int& remainder, division_rule rule) &
+{
+    if (&remainder == this || &remainder == &other)
+    {
+        // the operands are still needed while the remainder is written
+        big_int separate(remainder._digits.get_allocator());
+        divmod_assign(other, separate, rule);
+        remainder = std::move(separate);
+        return *this;
+    }
+
+    if (is_zero(other._digits))
+    {
+        throw std::logic_error("Division by zero");
+    }
+
+    if (is_zero(_digits) || limb_compare(_digits.data(), _digits.size(), other._digits.data(), other._digits.size()) < 0)
+    {
+        remainder._digits.assign(_digits.begin(), _digits.end());
+        remainder._sign = _sign;
+        _digits.assign(1, 0);
+        _sign = true;
+        return *this;
+    }
+
+    std::vector<unsigned int, pp_allocator<unsigned int>> quotient(_digits.size() - other._digits.size() + 1, 0, _digits.get_allocator());
+    remainder._digits.assign(other._digits.size(), 0);
+    divide_limbs(_digits.data(), _digits.size(), other._digits.data(), other._digits.size(),
+                 quotient.data(), remainder._digits.data(), rule, _digits.get_allocator());
+
+    optimise(remainder._digits);
+    remainder._sign = _sign || is_zero(remainder._digits);
+
+    _digits = std::move(quotient);
+    _sign = (_sign == other._sign);
+    optimise(_digits);
+    if (is_zero(_digits))
+    {
+        _sign = true;
+    }
+
+    return *this;
+}
+
+big_int& big_int::divmod_assign(const big_int& other, big_int& remainder) &
+{
+    return divmod_assign(other, remainder, decide_div(other._digits.size()));
+}
+
+std::pair<big_int, big_int> big_int::divmod(const big_int& other) const
+{
+    std::pair<big_int, big_int> result(*this, big_int(_digits.get_allocator()));
+    result.first.divmod_assign(other, result.second);
+    return result;
+}
+
 big_int big_int::operator+(const big_int& other) const
 {
     big_int result(*this);
@@ -827,11 +1827,19 @@ std::string big_int::to_string() const
     big_int temp(*this);
     temp._sign = true;
 
+    // nine decimal digits per division, the remainder limb is then split with plain arithmetic
+    const big_int chunk(1000000000u, _digits.get_allocator());
+    big_int remainder(_digits.get_allocator());
+
     while (temp)
     {
-        big_int remainder = temp % 10;
-        result += static_cast<char>('0' + remainder._digits[0]);
-        temp /= 10;
+        temp.divmod_assign(chunk, remainder);
+        unsigned int digits = remainder._digits[0];
+        for (size_t i = 0; i < 9 && (digits != 0 || temp); ++i)
+        {
+            result += static_cast<char>('0' + digits % 10);
+            digits /= 10;
+        }
     }
 
     if (!_sign)
@@ -861,58 +1869,17 @@ big_int& big_int::modulo_assign(const big_int& other, division_rule rule) &
         return *this;
     }
 
-    big_int abs_this(*this);
-    abs_this._sign = true;
-    big_int abs_other(other);
-    abs_other._sign = true;
-
-    if (abs_this < abs_other)
+    if (limb_compare(_digits.data(), _digits.size(), other._digits.data(), other._digits.size()) < 0)
     {
-
-        _sign = true;
         return *this;
     }
 
-    big_int remainder(_digits.get_allocator());
-    remainder._digits.clear();
-    remainder._digits.push_back(0);
-
-    for (int i = static_cast<int>(_digits.size()) - 1; i >= 0; --i)
-    {
-        remainder._digits.insert(remainder._digits.begin(), _digits[i]);
-        optimise(remainder._digits);
-
-        if (remainder < abs_other)
-        {
-            continue;
-        }
-
-        unsigned long long left = 0, right = BASE - 1;
-        unsigned long long q = 0;
-        while (left <= right)
-        {
-            unsigned long long mid = left + (right - left) / 2;
-            big_int temp(abs_other);
-            temp *= big_int(static_cast<long long>(mid), _digits.get_allocator());
-            if (remainder >= temp)
-            {
-                q = mid;
-                left = mid + 1;
-            }
-            else
-            {
-                right = mid - 1;
-            }
-        }
+    std::vector<unsigned int, pp_allocator<unsigned int>> remainder(other._digits.size(), 0, _digits.get_allocator());
+    divide_limbs(_digits.data(), _digits.size(), other._digits.data(), other._digits.size(),
+                 nullptr, remainder.data(), rule, _digits.get_allocator());
 
-        if (q > 0)
-        {
-            big_int temp(abs_other);
-            temp *= big_int(static_cast<long long>(q), _digits.get_allocator());
-            remainder -= temp;
-        }
-    }
-    _digits = std::move(remainder._digits);
+    _digits = std::move(remainder);
+    optimise(_digits);
     if (is_zero(_digits))
     {
         _sign = true;
@@ -163,6 +163,43 @@ TEST(positive_tests, test7)
     delete logger;
 }
 
+TEST(positive_tests, test8)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+    
+    // long enough for several levels of recursion, with a divisor that needs padding to a block
+    std::vector<unsigned int> digits_1(1200), digits_2(333);
+    for (size_t i = 0; i < digits_1.size(); ++i)
+    {
+        digits_1[i] = i % 7 == 0 ? 0xFFFFFFFF : static_cast<unsigned int>(i * 2654435761u);
+    }
+    for (size_t i = 0; i < digits_2.size(); ++i)
+    {
+        digits_2[i] = i % 4 == 0 ? 0 : static_cast<unsigned int>(i * 40503u + 11);
+    }
+    
+    big_int bigint_1(digits_1, false);
+    big_int bigint_2(digits_2);
+    big_int quotient(bigint_1);
+    big_int remainder(bigint_1);
+    big_int expected(bigint_1);
+    quotient.divide_assign(bigint_2, big_int::division_rule::BurnikelZiegler);
+    remainder.modulo_assign(bigint_2, big_int::division_rule::BurnikelZiegler);
+    expected.divide_assign(bigint_2, big_int::division_rule::trivial);
+    
+    EXPECT_TRUE(quotient == expected);
+    EXPECT_TRUE(quotient * bigint_2 + remainder == bigint_1);
+    EXPECT_TRUE(remainder <= big_int(0) && remainder > -bigint_2);
+    
+    delete logger;
+}
+
 int main(
     int argc,
     char **argv)
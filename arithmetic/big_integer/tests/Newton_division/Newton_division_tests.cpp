@@ -163,6 +163,49 @@ TEST(positive_tests, test7)
     delete logger;
 }
 
+TEST(positive_tests, test8)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+    
+    // a divisor long enough for Newton steps above algorithm D, divided blockwise and with a short quotient
+    std::vector<unsigned int> digits_1(1500), digits_2(400);
+    for (size_t i = 0; i < digits_1.size(); ++i)
+    {
+        digits_1[i] = i % 7 == 0 ? 0xFFFFFFFF : static_cast<unsigned int>(i * 2654435761u);
+    }
+    for (size_t i = 0; i < digits_2.size(); ++i)
+    {
+        digits_2[i] = i % 4 == 0 ? 0xFFFFFFFF : static_cast<unsigned int>(i * 40503u + 11);
+    }
+    
+    big_int bigint_1(digits_1);
+    big_int bigint_2(digits_2, false);
+    big_int divisor_magnitude(digits_2);
+    big_int short_dividend(std::vector<unsigned int>(digits_1.begin(), digits_1.begin() + 450));
+    
+    for (big_int const &dividend : {bigint_1, short_dividend})
+    {
+        big_int quotient(dividend);
+        big_int remainder(dividend);
+        big_int expected(dividend);
+        quotient.divide_assign(bigint_2, big_int::division_rule::Newton);
+        remainder.modulo_assign(bigint_2, big_int::division_rule::Newton);
+        expected.divide_assign(bigint_2, big_int::division_rule::trivial);
+        
+        EXPECT_TRUE(quotient == expected);
+        EXPECT_TRUE(quotient * bigint_2 + remainder == dividend);
+        EXPECT_TRUE(remainder >= big_int(0) && remainder < divisor_magnitude);
+    }
+    
+    delete logger;
+}
+
 int main(
     int argc,
     char **argv)
@@ -164,6 +164,42 @@ TEST(positive_tests, test7)
     delete logger;
 }
 
+TEST(positive_tests, test8)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+    
+    // long enough for the transform to matter, all-ones limbs give the largest coefficients
+    std::string digits_1(3000, '9');
+    std::string digits_2 = "-";
+    for (int i = 0; i < 2000; ++i)
+    {
+        digits_2 += static_cast<char>('1' + i * 7 % 9);
+    }
+    
+    big_int bigint_1(digits_1);
+    big_int bigint_2(digits_2);
+    big_int expected(bigint_1);
+    expected.multiply_assign(bigint_2, big_int::multiplication_rule::trivial);
+    bigint_1.multiply_assign(bigint_2, big_int::multiplication_rule::SchonhageStrassen);
+    
+    EXPECT_TRUE(bigint_1 == expected);
+    
+    big_int all_ones(std::vector<unsigned int>(700, 0xFFFFFFFF));
+    big_int squared(all_ones);
+    squared.multiply_assign(all_ones, big_int::multiplication_rule::SchonhageStrassen);
+    all_ones.multiply_assign(all_ones, big_int::multiplication_rule::trivial);
+    
+    EXPECT_TRUE(squared == all_ones);
+    
+    delete logger;
+}
+
 int main(
     int argc,
     char **argv)
@@ -227,7 +227,41 @@ TEST(positive_tests, test9)
     big_int bigint_2("-00000044234235347865897389456748953795739648996453238954354321");
     
     EXPECT_TRUE(bigint_1 == bigint_2);
-    
+
+    delete logger;
+}
+
+TEST(positive_tests, test10)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+
+    big_int bigint_1("-32850346459076457453464575686784654");
+    big_int bigint_2("12342357553253");
+
+    auto [quotient, remainder] = bigint_1.divmod(bigint_2);
+
+    EXPECT_TRUE(quotient == bigint_1 / bigint_2);
+    EXPECT_TRUE(remainder == bigint_1 % bigint_2);
+    EXPECT_EQ(remainder.to_string(), "-3232571319826");
+
+    big_int small("-7");
+    big_int small_remainder(0);
+    small.divmod_assign(bigint_2, small_remainder);
+
+    EXPECT_EQ(small.to_string(), "0");
+    EXPECT_EQ(small_remainder.to_string(), "-7");
+
+    big_int dividend(bigint_1);
+    dividend.divmod_assign(bigint_2, dividend, big_int::division_rule::BurnikelZiegler);
+
+    EXPECT_TRUE(dividend == remainder);
+
     delete logger;
 }
 
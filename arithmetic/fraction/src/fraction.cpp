@@ -4,9 +4,11 @@
 #include <regex>
 
 big_int gcd(big_int a, big_int b) {
-    if (a == 0)
-        return b;
-    return gcd(b % a, a);
+    while (a != 0) {
+        b %= a;
+        std::swap(a, b);
+    }
+    return b;
 }
 
 void fraction::optimise() {
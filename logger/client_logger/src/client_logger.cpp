@@ -13,6 +13,10 @@ std::unordered_map<std::string, std::pair<size_t, std::ofstream>>
 
 logger &client_logger::log(const std::string &text,
                            logger::severity severity) & {
+    if (!is_enabled(severity)) {
+        return *this;
+    }
+
     std::string formatted = make_format(text, severity);
     for (const auto &[sev, pair] : _output_streams) {
         if (sev != severity)
@@ -33,6 +37,12 @@ logger &client_logger::log(const std::string &text,
     return *this;
 }
 
+bool client_logger::is_enabled(logger::severity severity) const noexcept {
+    auto it = _output_streams.find(severity);
+    return it != _output_streams.end() &&
+           (it->second.second || !it->second.first.empty());
+}
+
 std::string client_logger::make_format(const std::string &message,
                                        severity sev) const {
         std::string result;
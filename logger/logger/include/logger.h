@@ -28,6 +28,12 @@ public:
         std::string const &message,
         logger::severity severity) & = 0;
 
+    /** Whether a message of given severity reaches at least one stream,
+     *  lets callers skip building messages nobody will see
+     */
+    virtual bool is_enabled(
+        logger::severity severity) const noexcept;
+
 public:
 
     logger& trace(
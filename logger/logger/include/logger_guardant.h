@@ -1,8 +1,16 @@
 #ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOGGER_GUARDANT_H
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOGGER_GUARDANT_H
 
+#include <concepts>
+#include <type_traits>
 #include "logger.h"
 
+/** Callable producing a log message, invoked only when the message is going to be written
+ */
+template<typename F>
+concept lazy_log_message =
+    std::invocable<F &> && std::convertible_to<std::invoke_result_t<F &>, std::string>;
+
 class logger_guardant
 {
 
@@ -12,6 +20,9 @@ public:
 
 public:
 
+    bool is_enabled_with_guard(
+        logger::severity severity) const;
+
     logger_guardant & log_with_guard(
         std::string const &message,
         logger::severity severity) &;
@@ -34,10 +45,99 @@ public:
     logger_guardant &critical_with_guard(
         std::string const &message) &;
 
+public:
+
+    /** Deferred overloads: message is built only if there is a logger and the severity is enabled
+     */
+    template<lazy_log_message F>
+    logger_guardant &log_with_guard(
+        F &&message,
+        logger::severity severity) &;
+
+    template<lazy_log_message F>
+    logger_guardant &trace_with_guard(
+        F &&message) &;
+
+    template<lazy_log_message F>
+    logger_guardant &debug_with_guard(
+        F &&message) &;
+
+    template<lazy_log_message F>
+    logger_guardant &information_with_guard(
+        F &&message) &;
+
+    template<lazy_log_message F>
+    logger_guardant &warning_with_guard(
+        F &&message) &;
+
+    template<lazy_log_message F>
+    logger_guardant &error_with_guard(
+        F &&message) &;
+
+    template<lazy_log_message F>
+    logger_guardant &critical_with_guard(
+        F &&message) &;
+
 protected:
 
     inline virtual logger *get_logger() const = 0;
 
 };
 
+template<lazy_log_message F>
+logger_guardant &logger_guardant::log_with_guard(
+    F &&message,
+    logger::severity severity) &
+{
+    logger *got_logger = get_logger();
+    if (got_logger != nullptr && got_logger->is_enabled(severity))
+    {
+        got_logger->log(message(), severity);
+    }
+
+    return *this;
+}
+
+template<lazy_log_message F>
+logger_guardant &logger_guardant::trace_with_guard(
+    F &&message) &
+{
+    return log_with_guard(std::forward<F>(message), logger::severity::trace);
+}
+
+template<lazy_log_message F>
+logger_guardant &logger_guardant::debug_with_guard(
+    F &&message) &
+{
+    return log_with_guard(std::forward<F>(message), logger::severity::debug);
+}
+
+template<lazy_log_message F>
+logger_guardant &logger_guardant::information_with_guard(
+    F &&message) &
+{
+    return log_with_guard(std::forward<F>(message), logger::severity::information);
+}
+
+template<lazy_log_message F>
+logger_guardant &logger_guardant::warning_with_guard(
+    F &&message) &
+{
+    return log_with_guard(std::forward<F>(message), logger::severity::warning);
+}
+
+template<lazy_log_message F>
+logger_guardant &logger_guardant::error_with_guard(
+    F &&message) &
+{
+    return log_with_guard(std::forward<F>(message), logger::severity::error);
+}
+
+template<lazy_log_message F>
+logger_guardant &logger_guardant::critical_with_guard(
+    F &&message) &
+{
+    return log_with_guard(std::forward<F>(message), logger::severity::critical);
+}
+
 #endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOGGER_GUARDANT_H
\ No newline at end of file
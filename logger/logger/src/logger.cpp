@@ -38,6 +38,12 @@ logger &logger::critical(
     return log(message, logger::severity::critical);
 }
 
+bool logger::is_enabled(
+    logger::severity) const noexcept
+{
+    return true;
+}
+
 std::string logger::severity_to_string(
     logger::severity severity)
 {
@@ -1,5 +1,13 @@
 #include "../include/logger_guardant.h"
 
+bool logger_guardant::is_enabled_with_guard(
+    logger::severity severity) const
+{
+    logger *got_logger = get_logger();
+
+    return got_logger != nullptr && got_logger->is_enabled(severity);
+}
+
 logger_guardant &logger_guardant::log_with_guard(
     std::string const &message,
     logger::severity severity) &